@@ -0,0 +1,64 @@
+#pragma once
+
+#ifndef DAK_TILING_BATCH_TRANSFORM_H
+#define DAK_TILING_BATCH_TRANSFORM_H
+
+#include <dak/geometry/edge.h>
+#include <dak/geometry/point.h>
+#include <dak/geometry/transform.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::edge_t;
+      using geometry::point_t;
+      using geometry::transform_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Affine transform of many points at once.
+      //
+      // The points are transformed using the widest vector instructions
+      // supported by the processor: AVX transforms two points per instruction,
+      // SSE2 one point, and the scalar fallback one coordinate. All variants
+      // do the same multiplications and additions as transforming each point
+      // by itself, but the compiler may fuse them differently, so the results
+      // can differ in the last bits.
+      //
+      // The source and destination can be the same array.
+
+      // Instructions used by the batch transforms.
+      enum class simd_level_t
+      {
+         scalar,
+         sse2,
+         avx,
+      };
+
+      // Retrieve the instructions currently used, the best supported by default.
+      simd_level_t get_simd_level();
+
+      // Select the instructions to use, limited to those supported. Used to compare them.
+      void set_simd_level(simd_level_t level);
+
+      // Retrieve the best instructions supported by the processor.
+      simd_level_t get_supported_simd_level();
+
+      // Transform an array of points.
+      void apply_transform(const transform_t& trf, const point_t* from, point_t* to, size_t count);
+
+      // Transform the points of an array of edges.
+      void apply_transform(const transform_t& trf, const edge_t* from, edge_t* to, size_t count);
+
+      // Transform a list of points.
+      std::vector<point_t> apply_transform(const transform_t& trf, const std::vector<point_t>& points);
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
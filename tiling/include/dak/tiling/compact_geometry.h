@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef DAK_TILING_COMPACT_GEOMETRY_H
+#define DAK_TILING_COMPACT_GEOMETRY_H
+
+#include <dak/geometry/edge.h>
+#include <dak/geometry/edges_map.h>
+#include <dak/geometry/point.h>
+
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::edge_t;
+      using geometry::edges_map_t;
+      using geometry::point_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Compact single-precision geometry used to keep data that is only drawn.
+      //
+      // Screen rendering does not need double precision, so caches kept only
+      // to be drawn on the canvas can use half the memory. The computations,
+      // the file I/O and the exports keep using double precision.
+
+      enum class geometry_precision_t
+      {
+         full,
+         compact,
+      };
+
+      struct point32_t
+      {
+         float x = 0.f;
+         float y = 0.f;
+
+         point32_t() { }
+         point32_t(float x, float y) : x(x), y(y) { }
+         explicit point32_t(const point_t& pt) : x(float(pt.x)), y(float(pt.y)) { }
+
+         point_t to_point() const { return point_t(x, y); }
+      };
+
+      struct edge32_t
+      {
+         point32_t p1;
+         point32_t p2;
+
+         edge32_t() { }
+         edge32_t(const point32_t& p1, const point32_t& p2) : p1(p1), p2(p2) { }
+         explicit edge32_t(const edge_t& edge) : p1(edge.p1), p2(edge.p2) { }
+      };
+
+      // The canonical edges of a map, to draw each line only once.
+      typedef std::vector<edge32_t> compact_edges_t;
+
+      compact_edges_t make_compact_edges(const edges_map_t& map);
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifndef DAK_TILING_CONTENT_HASH_H
+#define DAK_TILING_CONTENT_HASH_H
+
+#include <dak/geometry/point.h>
+#include <dak/geometry/polygon.h>
+#include <dak/geometry/transform.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace dak
+{
+   namespace tiling
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Incremental 64-bit FNV-1a hash of content.
+      //
+      // The hash is stable between runs, so it can be used to name files in
+      // on-disk caches. Doubles are hashed by their bit pattern, with negative
+      // zero folded into zero.
+
+      class content_hash_t
+      {
+      public:
+         content_hash_t& add(const void* data, size_t size)
+         {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+               my_value ^= bytes[i];
+               my_value *= prime;
+            }
+            return *this;
+         }
+
+         content_hash_t& add(double value)
+         {
+            if (value == 0.)
+               value = 0.;
+            return add(&value, sizeof(value));
+         }
+
+         content_hash_t& add(int64_t value)    { return add(&value, sizeof(value)); }
+         content_hash_t& add(uint64_t value)   { return add(&value, sizeof(value)); }
+         content_hash_t& add(int value)        { return add(int64_t(value)); }
+         content_hash_t& add(bool value)       { return add(int64_t(value ? 1 : 0)); }
+
+         content_hash_t& add(std::wstring_view text)
+         {
+            add(uint64_t(text.size()));
+            for (const wchar_t c : text)
+               add(uint64_t(c));
+            return *this;
+         }
+
+         content_hash_t& add(const geometry::point_t& pt) { return add(pt.x).add(pt.y); }
+
+         content_hash_t& add(const geometry::polygon_t& poly)
+         {
+            add(uint64_t(poly.points.size()));
+            for (const auto& pt : poly.points)
+               add(pt);
+            return *this;
+         }
+
+         content_hash_t& add(const geometry::transform_t& trf)
+         {
+            return add(trf.scale_x).add(trf.rot_1).add(trf.trans_x)
+                  .add(trf.rot_2).add(trf.scale_y).add(trf.trans_y);
+         }
+
+         uint64_t value() const { return my_value; }
+
+      private:
+         static constexpr uint64_t offset_basis = 14695981039346656037ull;
+         static constexpr uint64_t prime = 1099511628211ull;
+
+         uint64_t my_value = offset_basis;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
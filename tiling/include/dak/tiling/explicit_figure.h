@@ -18,13 +18,13 @@ namespace dak
       {
       public:
          explicit_figure_t() { }
-         explicit_figure_t(const edges_map_t& m) { my_cached_map = m; }
+         explicit_figure_t(const edges_map_t& m) { set_map(m); }
 
          // Copy a figure.
          std::shared_ptr<figure_t> clone() const override;
          void make_similar(const figure_t&) override { }
 
-         void set_map(const edges_map_t& m) { my_cached_map = m; }
+         void set_map(const edges_map_t& m) { my_cached_map = m; parameters_changed(); set_map_cached(); }
 
          // Retrieve a description of this style.
          std::wstring describe() const override;
@@ -36,6 +36,9 @@ namespace dak
          bool operator==(const figure_t& other) const override;
 
       protected:
+         // Figure implementation.
+         void add_to_hash(content_hash_t& hash) const override;
+
          // Figure cache implementation.
          bool is_cache_valid() const override { return true; }
          void update_cached_values() const override { }
@@ -48,6 +48,9 @@ namespace dak
          edges_map_t build_unit() const override;
 
       protected:
+         // Figure implementation.
+         void add_to_hash(content_hash_t& hash) const override;
+
          // Figure cache implementation.
          bool is_cache_valid() const override;
          void update_cached_values() const override;
@@ -60,7 +63,10 @@ namespace dak
          static double compute_scale(std::shared_ptr<radial_figure_t> child);
          static void scale_to_unit(edges_map_t& cunit);
 
-         mutable double my_cached_s_last_build_unit = NAN;
+         void copy_cached_child(const extended_figure_t& other);
+
+         mutable const radial_figure_t* my_cached_child = nullptr;
+         mutable uint64_t my_cached_child_version = 0;
       };
    }
 }
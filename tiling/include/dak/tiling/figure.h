@@ -3,6 +3,9 @@
 #ifndef DAK_TILING_FIGURE_H
 #define DAK_TILING_FIGURE_H
 
+#include <dak/tiling/content_hash.h>
+#include <dak/tiling/memory_usage.h>
+
 #include <dak/geometry/edges_map.h>
 
 #include <memory>
@@ -22,6 +25,10 @@ namespace dak
       // an object that knows how to build maps.  Subclasses of figure
       // understand different ways of bulding maps, but have the advantage
       // of being parameterizable at a high level.
+      //
+      // Note: the const functions get_version() and get_map() update the
+      //       mutable cached values, so a figure must not be accessed from
+      //       multiple threads at once without external synchronization.
 
       class figure_t
       {
@@ -41,11 +48,31 @@ namespace dak
          virtual bool operator==(const figure_t& other) const = 0;
          bool operator!=(const figure_t& other) const { return !(*this == other); }
 
+         // Hash of the figure parameters. Equal figures have the same hash.
+         // The hash is kept until the version changes.
+         uint64_t content_hash() const;
+
+         // Version of the figure parameters. It increases each time the
+         // parameters are found to have changed, so the map and anything
+         // derived from the figure can be validated with an integer comparison.
+         uint64_t get_version() const;
+
+         // Tell the figure its parameters changed in a way that comparing
+         // the cached parameters cannot detect.
+         void parameters_changed() { ++my_version; }
+
+         // Estimated heap memory held by the figure, including its cached map.
+         virtual size_t memory_usage() const;
+
          // Retrieve a description of this style.
          virtual std::wstring describe() const = 0;
 
       protected:
-         // Verify if the cached map still corresponds to the current parameters.
+         // Add the figure type and parameters to the hash.
+         virtual void add_to_hash(content_hash_t& hash) const = 0;
+
+         // Verify if the cached parameters still correspond to the current parameters.
+         // Only called when the version is queried, so it should stay cheap.
          virtual bool is_cache_valid() const = 0;
 
          // Update the cached parameters.
@@ -54,7 +81,16 @@ namespace dak
          // Build the cached map.
          virtual void build_map() const = 0;
 
+         // Mark the cached map as corresponding to the current parameters.
+         void set_map_cached() const { my_cached_map_version = get_version(); }
+
          mutable edges_map_t my_cached_map;
+
+      private:
+         mutable uint64_t my_version = 1;
+         mutable uint64_t my_cached_map_version = 0;
+         mutable uint64_t my_cached_hash = 0;
+         mutable uint64_t my_cached_hash_version = 0;
       };
    }
 }
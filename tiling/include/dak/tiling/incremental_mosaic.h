@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef DAK_TILING_INCREMENTAL_MOSAIC_H
+#define DAK_TILING_INCREMENTAL_MOSAIC_H
+
+#include <dak/tiling/mosaic.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace dak
+{
+   namespace tiling
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Generates the example mosaic of a tiling that is being edited.
+      //
+      // Each update creates the same mosaic as generate_mosaic(), but reuses
+      // the figures, and their cached map, of the previous update for the
+      // tiles that did not change. Irregular figures are inferred from the
+      // tiles around them, so they are only reused when the tiles touching
+      // them are the same.
+      //
+      // The generator is not thread-safe, but it can be used from any thread,
+      // since the mosaics it returns share nothing with the kept figures.
+
+      class incremental_mosaic_t
+      {
+      public:
+         // Count of figures reused and rebuilt during the last update.
+         struct stats_t
+         {
+            size_t reused_count = 0;
+            size_t rebuilt_count = 0;
+         };
+
+         // Create the mosaic of the tiling, with all its figure maps built.
+         std::shared_ptr<mosaic_t> update(const std::shared_ptr<const tiling_t>& tiling);
+
+         // Forget the figures kept from the previous update.
+         void clear();
+
+         const stats_t& get_stats() const { return my_stats; }
+
+      private:
+         struct kept_figure_t
+         {
+            uint64_t neighbourhood = 0;
+            std::shared_ptr<figure_t> figure;
+         };
+
+         static uint64_t neighbourhood_hash(const tiling_t& tiling, const polygon_t& tile);
+
+         std::shared_ptr<mosaic_t> my_mosaic;
+         std::map<polygon_t, kept_figure_t> my_figures;
+         stats_t my_stats;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
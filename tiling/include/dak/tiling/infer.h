@@ -59,6 +59,9 @@ namespace dak
 
          infer_t(const std::shared_ptr<mosaic_t>& mo, const polygon_t& tile);
 
+         // Estimated heap memory held by the copied maps and placed tiles.
+         size_t memory_usage() const;
+
          ////////////////////////////////////////////////////////////////////////////
          //
          // Building a 3x3 tiling of the prototype.
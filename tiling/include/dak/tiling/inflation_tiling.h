@@ -61,6 +61,10 @@ namespace dak
          // Fill the given region with copies of the tiling,
          // calling the callback for each transform that place a copy of the tiling.
          void fill_rings(int rings_count, std::function<void(const tiling_t& tiling, const transform_t& placement)> fill_callback) const;
+
+      protected:
+         // Tiling implementation.
+         void add_to_hash(content_hash_t& hash) const override;
       };
    }
 }
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef DAK_TILING_INFLATION_WIDTHS_H
+#define DAK_TILING_INFLATION_WIDTHS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Table of the inflation of an inflation tiling by distance to its center.
+      //
+      // The inflation is known at the center of some tiles and linearly
+      // interpolated in-between. The distances are kept in a flat sorted
+      // array and a direct index of uniform buckets over the distances gives
+      // the few entries to search, so a lookup does not depend on the number
+      // of entries.
+      //
+      // The distances are squared distances, to avoid square roots.
+
+      class inflation_widths_t
+      {
+      public:
+         // Remove all entries.
+         void clear();
+
+         // Add the inflation at a distance. Replaces the inflation previously
+         // added at the same distance. The table must be built before being used.
+         void add(double distance_2, double inflation);
+
+         // Sort the entries and index them.
+         void build();
+
+         // Number of entries.
+         size_t size() const { return my_distances.size(); }
+
+         // Inflate a width at the given distance.
+         //
+         // The width is not inflated with less than two entries or up to the
+         // first distance. Past the last distance, the last inflation is used.
+         double get_width(double distance_2, double width) const;
+
+         // Estimated heap memory held by the table.
+         size_t memory_usage() const;
+
+      private:
+         size_t get_bucket(double distance_2) const;
+
+         std::vector<double> my_distances;
+         std::vector<double> my_inflations;
+
+         // Index of the first entry in each bucket or after it, plus the entry count.
+         std::vector<uint32_t> my_buckets;
+         size_t my_bucket_count = 0;
+         double my_bucket_scale = 0.;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -26,6 +26,8 @@ namespace dak
       {
       public:
          std::shared_ptr<dak::tiling::mosaic_t> mosaic;
+
+         // Note: call parameters_changed() after modifying the polygon.
          polygon_t poly;
 
          infer_mode_t infer = infer_mode_t::girih;
@@ -51,14 +53,19 @@ namespace dak
          // Retrieve a description of this style.
          std::wstring describe() const override;
 
+         // Estimated heap memory held by the figure.
+         size_t memory_usage() const override;
+
       protected:
+         // Figure implementation.
+         void add_to_hash(content_hash_t& hash) const override;
+
          // Figure cache implementation.
          bool is_cache_valid() const override;
          void update_cached_values() const override;
          void build_map() const;
 
       private:
-         mutable polygon_t my_cached_poly;
          mutable infer_mode_t my_cached_infer = infer_mode_t::girih;
 
          mutable double my_cached_q = NAN;
@@ -3,6 +3,8 @@
 #ifndef DAK_TILING_KNOWN_TILINGS_H
 #define DAK_TILING_KNOWN_TILINGS_H
 
+#include <dak/geometry/polygon.h>
+
 #include <map>
 #include <memory>
 #include <vector>
@@ -13,6 +15,7 @@ namespace dak
 {
    namespace tiling
    {
+      class figure_t;
       class mosaic_t;
       class tiling_t;
 
@@ -28,6 +31,10 @@ namespace dak
       std::shared_ptr<tiling_t> find_tiling(const known_tilings_t& known_tilings, const std::wstring& name);
 
       std::shared_ptr<mosaic_t> generate_mosaic(const std::shared_ptr<const tiling_t>& tiling);
+
+      // Create the figure used for a tile in generated mosaics:
+      // a star for regular tiles, an inferred girih for irregular ones.
+      std::shared_ptr<figure_t> make_default_figure(const std::shared_ptr<mosaic_t>& mosaic, const geometry::polygon_t& tile);
    }
 }
 
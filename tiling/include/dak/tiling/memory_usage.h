@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef DAK_TILING_MEMORY_USAGE_H
+#define DAK_TILING_MEMORY_USAGE_H
+
+#include <dak/geometry/edges_map.h>
+#include <dak/geometry/polygon.h>
+#include <dak/geometry/transform.h>
+
+#include <cstddef>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::edge_t;
+      using geometry::edges_map_t;
+      using geometry::point_t;
+      using geometry::polygon_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Estimates of the heap memory held by the data of mosaics and styles.
+      //
+      // The estimates count the capacity of containers, not the size of the
+      // objects that hold them, and ignore the allocator overhead.
+
+      // Objects already accounted for, so that shared objects are counted once.
+      typedef std::unordered_set<const void*> counted_objects_t;
+
+      // Estimated size of a tree node containing the given value.
+      template <class T>
+      inline size_t map_node_memory_usage()
+      {
+         return sizeof(T) + 4 * sizeof(void*);
+      }
+
+      template <class T>
+      inline size_t memory_usage(const std::vector<T>& items)
+      {
+         return items.capacity() * sizeof(T);
+      }
+
+      inline size_t memory_usage(const std::vector<bool>& bits)
+      {
+         return bits.capacity() / 8;
+      }
+
+      inline size_t memory_usage(const polygon_t& poly)
+      {
+         return memory_usage(poly.points);
+      }
+
+      inline size_t memory_usage(const std::vector<polygon_t>& polys)
+      {
+         size_t usage = polys.capacity() * sizeof(polygon_t);
+         for (const auto& poly : polys)
+            usage += memory_usage(poly);
+         return usage;
+      }
+
+      inline size_t memory_usage(const edges_map_t& map)
+      {
+         return map.all().capacity() * sizeof(edge_t);
+      }
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -0,0 +1,110 @@
+#pragma once
+
+#ifndef DAK_TILING_MITER_JOINS_H
+#define DAK_TILING_MITER_JOINS_H
+
+#include <dak/geometry/point.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::point_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Mitered joins of the widened edges of a map.
+      //
+      // The two points around the end of a widened edge depend on how the
+      // edge meets the other edges at that end. Finding the other edges needs
+      // map lookups, but the joins themselves are the same normalize, cross
+      // product and division for all edge ends. So the data of all edge ends
+      // is gathered first, then all joins are computed in bulk, using vector
+      // instructions when selected in batch_transform.h.
+
+      // How the edge meets the other edges at the joint.
+      enum class junction_kind_t : uint8_t
+      {
+         dead_end,
+         continuation,
+         intersection,
+      };
+
+      // What is needed to compute the two points at the p2 end of a widened
+      // edge, below and above the edge. The widths include the inflation.
+      struct junction_t
+      {
+         junction_kind_t kind = junction_kind_t::dead_end;
+
+         // The edge.
+         point_t p1;
+         point_t joint;
+
+         // The far end of the edge joined below, the continuation or the edge after.
+         point_t below;
+
+         // The far end of the edge joined above, the edge before.
+         point_t above;
+
+         // Width of the edge when no join can be done.
+         double width = 0.;
+
+         // Widths of the edge and of the joined edges for the joins.
+         double join_width = 0.;
+         double other_join_width = 0.;
+      };
+
+      // Compute the two points below and above the joint of one junction.
+      std::pair<point_t, point_t> compute_junction(const junction_t& junction);
+
+      // Junctions of many edge ends, kept as separate arrays of coordinates
+      // so they can be computed with vector instructions.
+      //
+      // Distinct junctions can be set and computed concurrently.
+      class junctions_t
+      {
+      public:
+         // Number of junctions.
+         size_t size() const { return my_kinds.size(); }
+
+         // Change the number of junctions.
+         void resize(size_t count);
+
+         // Set the data of a junction.
+         void set(size_t index, const junction_t& junction);
+
+         // Compute the points of the junctions in the range.
+         void compute(size_t begin, size_t end);
+
+         // Retrieve the points computed for a junction.
+         point_t get_below(size_t index) const { return point_t(my_below_x[index], my_below_y[index]); }
+         point_t get_above(size_t index) const { return point_t(my_above_x[index], my_above_y[index]); }
+
+      private:
+         junction_t get(size_t index) const;
+         void compute_scalar(size_t begin, size_t end);
+         void compute_sse2(size_t begin, size_t end);
+
+         std::vector<junction_kind_t> my_kinds;
+         std::vector<double> my_p1_x, my_p1_y;
+         std::vector<double> my_joint_x, my_joint_y;
+         std::vector<double> my_join_below_x, my_join_below_y;
+         std::vector<double> my_join_above_x, my_join_above_y;
+         std::vector<double> my_widths;
+         std::vector<double> my_join_widths;
+         std::vector<double> my_other_join_widths;
+
+         std::vector<double> my_below_x, my_below_y;
+         std::vector<double> my_above_x, my_above_y;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
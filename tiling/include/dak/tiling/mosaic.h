@@ -16,6 +16,26 @@ namespace dak
       using geometry::edges_map_t;
       using geometry::rectangle_t;
 
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // How the vertices of the placed figures are matched when constructing
+      // a mosaic.
+      //
+      // The tolerance merge compares the points with a tolerance in sorted
+      // structures. The quantized merge gives each vertex an exact id by hashing
+      // its position in a grid as large as the tolerance. The lattice merge is
+      // for translation tilings: each vertex is keyed by a vertex of the base
+      // unit and the integer combination of the translations placing it, so
+      // only the vertices of one unit are ever compared. Both hashed merges
+      // remove duplicated edges in time linear in the number of edges.
+
+      enum class vertex_merge_t
+      {
+         tolerance,
+         quantized,
+         lattice,
+      };
+
       ////////////////////////////////////////////////////////////////////////////
       //
       // The complete information needed to build a mosaic: the tiling and
@@ -29,6 +49,9 @@ namespace dak
          std::shared_ptr<const tiling_t> tiling;
 
          // Figures giving how to draw each tile.
+         //
+         // Copies of a mosaic share their figures. Use get_modifiable_figure()
+         // to get a figure that can be modified without affecting the copies.
          std::map<polygon_t, std::shared_ptr<figure_t>> tile_figures;
 
          // Empty mosaic.
@@ -37,7 +60,7 @@ namespace dak
          // Mosaic of the given tiling, with empty figures.
          mosaic_t(std::shared_ptr<const tiling_t> t) : tiling(t) { }
 
-         // Copy.
+         // Copy. The figures are shared until modified.
          mosaic_t(const mosaic_t& other);
          mosaic_t& operator=(const mosaic_t& other);
          void swap(mosaic_t& other) noexcept;
@@ -46,11 +69,38 @@ namespace dak
          bool operator==(const mosaic_t& other) const;
          bool operator!=(const mosaic_t& other) const { return !(*this == other); }
 
+         // Retrieve the figure of a tile that can be modified, cloning it if it is shared.
+         //
+         // Note: any other reference to the figure counts as sharing it: copies
+         //       of the mosaic, undo snapshots, cached mosaics and the pointers
+         //       returned by earlier calls. Holding on to a returned figure thus
+         //       makes the next call clone it again, so callers should release
+         //       it once modified and call this function again for each edit.
+         //       A figure modified through a pointer kept from an earlier call
+         //       may no longer be the one used by the mosaic.
+         std::shared_ptr<figure_t> get_modifiable_figure(const polygon_t& tile);
+
+         // Hash of the tiling and figures. Equal mosaics have the same hash.
+         // Each figure keeps its hash until it changes, so hashing an unchanged
+         // mosaic only takes time proportional to its number of tiles.
+         uint64_t content_hash() const;
+
+         // Estimated heap memory held by the tiling and figures, including
+         // their cached maps. Figures shared by copies of the mosaic are only
+         // counted if they were not counted yet.
+         size_t memory_usage() const;
+         size_t memory_usage(counted_objects_t& counted) const;
+
          // Verify if both mosaics have the same figures.
          bool same_figures(const mosaic_t& other) const;
 
+         // Verify if both mosaics use the very same tiling and figure objects,
+         // not only equal ones.
+         bool shares_figures(const mosaic_t& other) const;
+
          // Construct a map in the given polygonal region using the tiling and figures.
          edges_map_t construct(const rectangle_t& region) const;
+         edges_map_t construct(const rectangle_t& region, vertex_merge_t merge) const;
 
          // Count how many edge an instance of the tiling requires.
          size_t count_tiling_edges() const;
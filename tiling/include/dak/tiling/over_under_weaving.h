@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef DAK_TILING_OVER_UNDER_WEAVING_H
+#define DAK_TILING_OVER_UNDER_WEAVING_H
+
+#include <dak/geometry/edges_map.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::edges_map_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Over/under weaving of the edges of a map.
+      //
+      // Each edge of the map, in the order of the map, is given a flag telling
+      // if it passes over the other edges at its p1 end. The flag of one edge
+      // is chosen and propagated to its twin and to the edges around its p1
+      // with a depth-first search, flipping at each crossing.
+      //
+      // The neighbours of each edge are found once and kept by index, then
+      // the edges are labelled by connected group. The groups do not share
+      // any edge, so each group is propagated independently, on multiple
+      // threads, with the same search order as a single sequential search.
+
+      class over_under_weaving_t
+      {
+      public:
+         // Prepare the weaving of the edges of the map.
+         explicit over_under_weaving_t(const edges_map_t& map);
+
+         // Number of edges and of connected groups of edges.
+         size_t edge_count() const { return my_is_crossing.size(); }
+         size_t component_count() const { return my_component_starts.size(); }
+
+         // Propagate the over/under flags to all edges. The flags must already
+         // have one entry per edge: the first edge of each connected group keeps
+         // its flag, all other flags are overwritten.
+         void weave(std::vector<bool>& is_p1_over) const;
+
+      private:
+         void label_components();
+         void weave_component(size_t start, std::vector<uint8_t>& is_over, std::vector<uint8_t>& done, std::vector<size_t>& todos) const;
+
+         // The neighbours of each edge: its twin followed by the other edges
+         // around its p1, in the order the propagation visits them.
+         std::vector<size_t> my_neighbour_offsets;
+         std::vector<size_t> my_neighbours;
+
+         // Whether the p1 of each edge is a crossing, with more than two edges.
+         std::vector<uint8_t> my_is_crossing;
+
+         // The smallest edge index of each connected group, in increasing order.
+         std::vector<size_t> my_component_starts;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef DAK_TILING_PARALLEL_H
+#define DAK_TILING_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace dak
+{
+   namespace tiling
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Split independent work over multiple threads.
+      //
+      // The items are divided in consecutive ranges, one per thread, so each
+      // thread can write its results directly in pre-sized output slots and
+      // the results stay in the same order as with a sequential loop.
+      //
+      // The threads are kept in a pool and reused by later calls.
+
+      // Retrieve the maximum number of threads used, all hardware threads by default.
+      size_t get_thread_count();
+
+      // Select the maximum number of threads to use. Zero selects all hardware threads.
+      void set_thread_count(size_t count);
+
+      // Call the function on consecutive ranges covering [0, count).
+      //
+      // Each range has at least the minimum number of items, so small counts
+      // are processed in the calling thread. The function must be safe to call
+      // concurrently on disjoint ranges. An exception thrown by the function is
+      // rethrown in the calling thread once all threads are done. The function
+      // can itself call parallel_for.
+      void parallel_for(size_t count, size_t min_range_size, const std::function<void(size_t begin, size_t end)>& func);
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
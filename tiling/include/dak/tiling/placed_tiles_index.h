@@ -0,0 +1,97 @@
+#pragma once
+
+#ifndef DAK_TILING_PLACED_TILES_INDEX_H
+#define DAK_TILING_PLACED_TILES_INDEX_H
+
+#include <dak/tiling/tiling_selection.h>
+
+#include <dak/geometry/rectangle.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::rectangle_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Spatial index of placed tiles, used to quickly find the tiles near a point.
+      //
+      // The tiles are kept with their transform already applied, in a uniform
+      // grid sized after the typical tile. The index must be told when tiles are
+      // added, moved or removed.
+      //
+      // Found tiles are returned most recently added first, which is the order
+      // in which the tiling editor gives them priority.
+
+      class placed_tiles_index_t
+      {
+      public:
+         // A tile in the index.
+         struct entry_t
+         {
+            std::shared_ptr<placed_tile_t> placed;
+            polygon_t polygon;
+            rectangle_t bounds;
+            uint64_t order = 0;
+         };
+
+         // Index all the tiles, in the order they are given.
+         void rebuild(const std::vector<std::shared_ptr<placed_tile_t>>& tiles);
+
+         // Add a tile after all the others.
+         void add(const std::shared_ptr<placed_tile_t>& placed);
+
+         // Update a tile after its tile or transform changed.
+         void update(const std::shared_ptr<placed_tile_t>& placed);
+
+         // Remove a tile.
+         void remove(const std::shared_ptr<placed_tile_t>& placed);
+
+         // Remove all tiles.
+         void clear();
+
+         // Find the tiles whose bounds intersect the region, most recently added first.
+         std::vector<const entry_t*> find(const rectangle_t& region) const;
+
+         // Verify if the center of the checked tile is inside another accepted tile
+         // or inside its copies translated by at most one of each translation.
+         bool is_overlapped(const placed_tile_t& checked, const point_t& t1, const point_t& t2,
+                            const std::function<bool(const std::shared_ptr<placed_tile_t>&)>& accepted) const;
+
+         // Number of indexed tiles.
+         size_t size() const { return my_entries.size(); }
+
+      private:
+         struct cell_range_t
+         {
+            int64_t min_x, min_y, max_x, max_y;
+            uint64_t count() const { return uint64_t(max_x - min_x + 1) * uint64_t(max_y - min_y + 1); }
+         };
+
+         static uint64_t cell_key(int64_t x, int64_t y);
+         cell_range_t cell_range(const rectangle_t& rect) const;
+         bool is_large(const cell_range_t& range) const;
+
+         void insert_in_cells(const entry_t& entry);
+         void remove_from_cells(const entry_t& entry);
+
+         double my_cell_size = 1.;
+         uint64_t my_next_order = 0;
+         std::unordered_map<const placed_tile_t*, entry_t> my_entries;
+         std::unordered_map<uint64_t, std::vector<const entry_t*>> my_cells;
+         std::unordered_set<const entry_t*> my_large_entries;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -46,6 +46,9 @@ namespace dak
          edges_map_t build_unit() const override;
 
       protected:
+         // Figure implementation.
+         void add_to_hash(content_hash_t& hash) const override;
+
          // Figure cache implementation.
          bool is_cache_valid() const override;
          void update_cached_values() const override;
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef DAK_TILING_SNAP_POINTS_INDEX_H
+#define DAK_TILING_SNAP_POINTS_INDEX_H
+
+#include <dak/tiling/tiling_selection.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Index of the points of placed tiles where the mouse can snap: the
+      // vertices, the middle of the edges and the center of each tile.
+      //
+      // The points are hashed in a uniform grid sized after the typical edge,
+      // so finding the points near the mouse only looks at a few cells. The
+      // index must be told when tiles are added, moved or removed.
+
+      class snap_points_index_t
+      {
+      public:
+         // Index all the points of the tiles, in the order they are given.
+         void rebuild(const std::vector<std::shared_ptr<placed_tile_t>>& tiles);
+
+         // Add the points of a tile after all the others.
+         void add(const std::shared_ptr<placed_tile_t>& placed);
+
+         // Update the points of a tile after its tile or transform changed.
+         void update(const std::shared_ptr<placed_tile_t>& placed);
+
+         // Remove the points of a tile.
+         void remove(const std::shared_ptr<placed_tile_t>& placed);
+
+         // Remove all points.
+         void clear();
+
+         // Find the snap points near the given point. Gives the same result as
+         // finding a point selection among the tiles: the points of the most
+         // recently added tile having points near.
+         selection_t find(const point_t& wpt, double selection_distance, const selection_t& excluded_selection) const;
+
+      private:
+         struct tile_points_t;
+
+         // A point where to snap.
+         //
+         // The order in which the points of a tile are kept, the center, then
+         // each vertex followed by the middle of the edge ending at the vertex,
+         // is the order in which a selection lists them.
+         struct snap_point_t
+         {
+            point_t pt;
+            size_t p1 = size_t(-1);
+            size_t p2 = size_t(-1);
+            const tile_points_t* tile = nullptr;
+         };
+
+         struct tile_points_t
+         {
+            std::shared_ptr<placed_tile_t> placed;
+            uint64_t order = 0;
+            std::vector<snap_point_t> points;
+         };
+
+         static uint64_t cell_key(int64_t x, int64_t y);
+         bool cell_of(const point_t& pt, int64_t& x, int64_t& y) const;
+
+         void fill_points(tile_points_t& tile);
+         void insert_in_cells(const tile_points_t& tile);
+         void remove_from_cells(const tile_points_t& tile);
+
+         double my_cell_size = 1.;
+         uint64_t my_next_order = 0;
+         std::unordered_map<const placed_tile_t*, tile_points_t> my_tiles;
+         std::unordered_map<uint64_t, std::vector<const snap_point_t*>> my_cells;
+         std::vector<const snap_point_t*> my_far_points;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
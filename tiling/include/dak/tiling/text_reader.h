@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef DAK_TILING_TEXT_READER_H
+#define DAK_TILING_TEXT_READER_H
+
+#include <dak/geometry/point.h>
+#include <dak/geometry/transform.h>
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::point_t;
+      using geometry::transform_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Fast reader for the text formats of tilings and mosaics.
+      //
+      // The whole text is read in a buffer and tokenized in place. Numbers are
+      // parsed with std::from_chars instead of going through the locale-aware
+      // stream extraction operators.
+      //
+      // The reader mimics the behavior of the wide input stream it replaces:
+      // words are delimited by white-space, quoted strings follow the rules of
+      // std::quoted, booleans are read as with std::boolalpha and, once a read
+      // fails, all further reads fail and return default values, like a stream
+      // that has its fail-bit set.
+
+      class text_reader_t
+      {
+      public:
+         // Create a reader over the entire remaining content of the stream.
+         explicit text_reader_t(std::wistream& file);
+
+         // Create a reader over the given text.
+         explicit text_reader_t(std::wstring text);
+
+         // Read a white-space delimited word.
+         std::wstring_view read_word();
+
+         // Peek at the next white-space delimited word without consuming it.
+         std::wstring_view peek_word();
+
+         // Read a possibly quoted string, like std::quoted does.
+         std::wstring read_quoted();
+
+         // Read numbers and booleans.
+         double read_double();
+         int read_int();
+         size_t read_size();
+         bool read_bool();
+
+         // Read geometry, with the same field order as the geometry streamers.
+         point_t read_point();
+         transform_t read_transform();
+
+         // Verify if a read failed or the end of the text was reached.
+         bool failed() const { return my_failed; }
+         bool at_end();
+
+      private:
+         bool skip_spaces();
+         size_t copy_number(char* buffer, size_t buffer_size, bool allow_fraction) const;
+
+         std::wstring my_text;
+         size_t my_pos = 0;
+         bool my_failed = false;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
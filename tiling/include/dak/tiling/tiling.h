@@ -3,6 +3,8 @@
 #ifndef DAK_TILING_TILING_H
 #define DAK_TILING_TILING_H
 
+#include <dak/tiling/content_hash.h>
+
 #include <dak/geometry/point.h>
 #include <dak/geometry/polygon.h>
 #include <dak/geometry/transform.h>
@@ -58,6 +60,12 @@ namespace dak
          virtual bool operator==(const tiling_t& other) const;
          virtual bool operator!=(const tiling_t& other) const { return !(*this == other); }
 
+         // Hash of the tiles and placements. Equal tilings have the same hash.
+         uint64_t content_hash() const;
+
+         // Estimated heap memory held by the tiles and placements.
+         size_t memory_usage() const;
+
          // Calculate the bounds of the polygonal tiles of the tiling.
          rectangle_t bounds() const;
 
@@ -74,6 +82,10 @@ namespace dak
          // Fill a region around one copy of the tiling,
          // calling the callback for each transform that place a copy of the tiling.
          virtual void surround(std::function<void(const tiling_t& tiling, const transform_t& placement)> fill_callback) const = 0;
+
+      protected:
+         // Add the tiles and the replication parameters to the hash.
+         virtual void add_to_hash(content_hash_t& hash) const;
       };
    }
 }
@@ -4,6 +4,7 @@
 #define DAK_TILING_TILING_IO_H
 
 #include <dak/tiling/tiling.h>
+#include <dak/tiling/text_reader.h>
 
 #include <iostream>
 
@@ -16,6 +17,7 @@ namespace dak
       // Functions for reading and writing tilings from and to I/O streams.
 
       std::shared_ptr<tiling_t> read_tiling(std::wistream& file);
+      std::shared_ptr<tiling_t> read_tiling(text_reader_t& reader);
 
       void write_tiling(const std::shared_ptr<const tiling_t>& tiling, std::wostream& file);
    }
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef DAK_TILING_TRACE_H
+#define DAK_TILING_TRACE_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+namespace dak
+{
+   namespace tiling
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Lightweight tracing of the time spent in the hot paths.
+      //
+      // Scoped timers record when they were entered and exited, along with the
+      // thread that ran them. The recorded events can be written in the Chrome
+      // trace-event format, which can be opened in chrome://tracing or Perfetto.
+      //
+      // Probes are placed with the DAK_TILING_TRACE macro, which compiles to
+      // nothing unless DAK_TILING_TRACING is defined.
+      //
+      // Only the most recent events are kept, so tracing can stay on for the
+      // whole run of the application.
+
+      typedef std::chrono::steady_clock trace_clock_t;
+
+      // Record a traced event. The name must be a string literal.
+      void record_trace_event(const char* name, trace_clock_t::time_point start, trace_clock_t::time_point end);
+
+      // Write the recorded events as Chrome trace-event JSON.
+      void write_trace(std::ostream& stream);
+
+      // Forget all recorded events.
+      void clear_trace();
+
+      // Number of events currently recorded.
+      size_t trace_event_count();
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Timer recording the time spent in its scope.
+
+      class trace_scope_t
+      {
+      public:
+         explicit trace_scope_t(const char* name)
+         : my_name(name), my_start(trace_clock_t::now())
+         {
+         }
+
+         ~trace_scope_t()
+         {
+            record_trace_event(my_name, my_start, trace_clock_t::now());
+         }
+
+         trace_scope_t(const trace_scope_t&) = delete;
+         trace_scope_t& operator=(const trace_scope_t&) = delete;
+
+      private:
+         const char* my_name;
+         trace_clock_t::time_point my_start;
+      };
+   }
+}
+
+#define DAK_TILING_TRACE_CONCAT_INNER(a, b) a##b
+#define DAK_TILING_TRACE_CONCAT(a, b) DAK_TILING_TRACE_CONCAT_INNER(a, b)
+
+#ifdef DAK_TILING_TRACING
+   #define DAK_TILING_TRACE(name) ::dak::tiling::trace_scope_t DAK_TILING_TRACE_CONCAT(dak_trace_scope_, __LINE__)(name)
+#else
+   #define DAK_TILING_TRACE(name) ((void)0)
+#endif
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
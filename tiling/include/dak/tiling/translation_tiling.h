@@ -48,6 +48,10 @@ namespace dak
          // Fill a region around one copy of the tiling,
          // calling the callback for each transform that place a copy of the tiling.
          void surround(std::function<void(const tiling_t& tiling, const transform_t& placement)> fill_callback) const override;
+
+      protected:
+         // Tiling implementation.
+         void add_to_hash(content_hash_t& hash) const override;
       };
    }
 }
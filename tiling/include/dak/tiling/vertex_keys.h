@@ -0,0 +1,94 @@
+#pragma once
+
+#ifndef DAK_TILING_VERTEX_KEYS_H
+#define DAK_TILING_VERTEX_KEYS_H
+
+#include <dak/geometry/edge.h>
+#include <dak/geometry/edges_map.h>
+#include <dak/geometry/point.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      using geometry::edge_t;
+      using geometry::edges_map_t;
+      using geometry::point_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Exact keys for vertices that come out of floating-point transforms.
+      //
+      // Points are hashed in a grid whose cells are as large as the tolerance,
+      // so a point only needs to be compared with the points in the cells
+      // around it. Points within the tolerance of a known point get the same
+      // id, and all later uses of the vertex get the exact same position, so
+      // merging edges no longer needs tolerance-based sorted structures.
+
+      class quantized_vertices_t
+      {
+      public:
+         // Create with the tolerance under which points are the same vertex.
+         quantized_vertices_t(double tolerance);
+         quantized_vertices_t();
+
+         // Prepare to receive the given number of vertices.
+         void reserve(size_t count);
+
+         // Retrieve the id of the vertex at the point, adding it if new.
+         uint32_t add(const point_t& pt);
+
+         // Find the id of the vertex at the point. Returns false if not found.
+         bool find(const point_t& pt, uint32_t& id) const;
+
+         // Retrieve the position of a vertex.
+         const point_t& get_point(uint32_t id) const { return my_points[id]; }
+
+         // Number of vertices.
+         size_t size() const { return my_points.size(); }
+
+      private:
+         bool cell_of(const point_t& pt, int64_t& x, int64_t& y) const;
+         static uint64_t cell_key(int64_t x, int64_t y);
+
+         double my_tolerance;
+         double my_tolerance_2;
+         std::vector<point_t> my_points;
+         std::unordered_multimap<uint64_t, uint32_t> my_cells;
+
+         // Note: points too far to be hashed are compared linearly.
+         std::vector<uint32_t> my_far_points;
+      };
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Set of undirected edges between vertex ids.
+
+      class unique_edges_t
+      {
+      public:
+         // Prepare to receive the given number of edges.
+         void reserve(size_t count) { my_edges.reserve(count); }
+
+         // Add an edge. Returns false if the edge was already there or is degenerate.
+         bool add(uint32_t v1, uint32_t v2);
+
+      private:
+         std::unordered_set<uint64_t> my_edges;
+      };
+
+      // Create a map from edges that are all distinct and only meet at their end-points.
+      // Each edge is given once, in a single direction.
+      edges_map_t make_map_from_unique_edges(const std::vector<edge_t>& edges);
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
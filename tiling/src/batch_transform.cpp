@@ -0,0 +1,219 @@
+#include <dak/tiling/batch_transform.h>
+
+#include <atomic>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+   #define DAK_TILING_HAS_SSE2
+   #include <emmintrin.h>
+
+   #if defined(_MSC_VER)
+      // Note: MSVC allows AVX intrinsics in any function.
+      #define DAK_TILING_HAS_AVX
+      #define DAK_TILING_AVX_TARGET
+      #include <immintrin.h>
+      #include <intrin.h>
+   #elif defined(__GNUC__) || defined(__clang__)
+      // Note: only the AVX functions are compiled for AVX, the rest of the
+      //       program can still run on processors without it.
+      #define DAK_TILING_HAS_AVX
+      #define DAK_TILING_AVX_TARGET __attribute__((target("avx")))
+      #include <immintrin.h>
+   #endif
+#endif
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Note: the kernels work on the coordinates of the points, which
+         //       are laid out as consecutive pairs of doubles.
+
+         void apply_scalar(const transform_t& trf, const double* from, double* to, size_t count)
+         {
+            for (size_t i = 0; i < count; ++i)
+            {
+               const double x = from[2 * i];
+               const double y = from[2 * i + 1];
+               to[2 * i]     = trf.scale_x * x + trf.rot_1 * y + trf.trans_x;
+               to[2 * i + 1] = trf.rot_2 * x + trf.scale_y * y + trf.trans_y;
+            }
+         }
+
+#ifdef DAK_TILING_HAS_SSE2
+
+         void apply_sse2(const transform_t& trf, const double* from, double* to, size_t count)
+         {
+            const __m128d col_x = _mm_setr_pd(trf.scale_x, trf.rot_2);
+            const __m128d col_y = _mm_setr_pd(trf.rot_1, trf.scale_y);
+            const __m128d trans = _mm_setr_pd(trf.trans_x, trf.trans_y);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+               const __m128d pt = _mm_loadu_pd(from + 2 * i);
+               const __m128d xx = _mm_unpacklo_pd(pt, pt);
+               const __m128d yy = _mm_unpackhi_pd(pt, pt);
+               _mm_storeu_pd(to + 2 * i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(col_x, xx), _mm_mul_pd(col_y, yy)), trans));
+            }
+         }
+
+#endif
+
+#ifdef DAK_TILING_HAS_AVX
+
+         DAK_TILING_AVX_TARGET void apply_avx(const transform_t& trf, const double* from, double* to, size_t count)
+         {
+            const __m256d col_x = _mm256_setr_pd(trf.scale_x, trf.rot_2, trf.scale_x, trf.rot_2);
+            const __m256d col_y = _mm256_setr_pd(trf.rot_1, trf.scale_y, trf.rot_1, trf.scale_y);
+            const __m256d trans = _mm256_setr_pd(trf.trans_x, trf.trans_y, trf.trans_x, trf.trans_y);
+
+            // Four points per iteration, to hide the latency of the additions.
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+               const __m256d pts_1 = _mm256_loadu_pd(from + 2 * i);
+               const __m256d pts_2 = _mm256_loadu_pd(from + 2 * i + 4);
+               const __m256d xx_1 = _mm256_unpacklo_pd(pts_1, pts_1);
+               const __m256d yy_1 = _mm256_unpackhi_pd(pts_1, pts_1);
+               const __m256d xx_2 = _mm256_unpacklo_pd(pts_2, pts_2);
+               const __m256d yy_2 = _mm256_unpackhi_pd(pts_2, pts_2);
+               _mm256_storeu_pd(to + 2 * i,     _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(col_x, xx_1), _mm256_mul_pd(col_y, yy_1)), trans));
+               _mm256_storeu_pd(to + 2 * i + 4, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(col_x, xx_2), _mm256_mul_pd(col_y, yy_2)), trans));
+            }
+
+            for (; i + 2 <= count; i += 2)
+            {
+               const __m256d pts = _mm256_loadu_pd(from + 2 * i);
+               const __m256d xx = _mm256_unpacklo_pd(pts, pts);
+               const __m256d yy = _mm256_unpackhi_pd(pts, pts);
+               _mm256_storeu_pd(to + 2 * i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(col_x, xx), _mm256_mul_pd(col_y, yy)), trans));
+            }
+
+            _mm256_zeroupper();
+
+            if (i < count)
+               apply_scalar(trf, from + 2 * i, to + 2 * i, count - i);
+         }
+
+         bool is_avx_supported()
+         {
+#if defined(_MSC_VER)
+            int info[4] = { 0 };
+            __cpuid(info, 1);
+            const bool has_avx = (info[2] & (1 << 28)) != 0;
+            const bool has_os_save = (info[2] & (1 << 27)) != 0;
+            if (!has_avx || !has_os_save)
+               return false;
+
+            // The OS must save the AVX registers when switching threads.
+            return (_xgetbv(0) & 0x6) == 0x6;
+#else
+            return __builtin_cpu_supports("avx");
+#endif
+         }
+
+#endif
+
+         simd_level_t detect_simd_level()
+         {
+#ifdef DAK_TILING_HAS_AVX
+            if (is_avx_supported())
+               return simd_level_t::avx;
+#endif
+#ifdef DAK_TILING_HAS_SSE2
+            return simd_level_t::sse2;
+#else
+            return simd_level_t::scalar;
+#endif
+         }
+
+         std::atomic<simd_level_t>& current_simd_level()
+         {
+            static std::atomic<simd_level_t> level(get_supported_simd_level());
+            return level;
+         }
+
+         void apply_coordinates(const transform_t& trf, const double* from, double* to, size_t count)
+         {
+            switch (current_simd_level().load(std::memory_order_relaxed))
+            {
+#ifdef DAK_TILING_HAS_AVX
+               case simd_level_t::avx:
+                  apply_avx(trf, from, to, count);
+                  return;
+#endif
+#ifdef DAK_TILING_HAS_SSE2
+               case simd_level_t::sse2:
+                  apply_sse2(trf, from, to, count);
+                  return;
+#endif
+               default:
+                  apply_scalar(trf, from, to, count);
+                  return;
+            }
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Instructions selection.
+
+      simd_level_t get_supported_simd_level()
+      {
+         static const simd_level_t supported = detect_simd_level();
+         return supported;
+      }
+
+      simd_level_t get_simd_level()
+      {
+         return current_simd_level().load();
+      }
+
+      void set_simd_level(simd_level_t level)
+      {
+         if (int(level) > int(get_supported_simd_level()))
+            level = get_supported_simd_level();
+         current_simd_level().store(level);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Transforms.
+
+      void apply_transform(const transform_t& trf, const point_t* from, point_t* to, size_t count)
+      {
+         if constexpr (sizeof(point_t) == 2 * sizeof(double))
+         {
+            apply_coordinates(trf, &from->x, &to->x, count);
+         }
+         else
+         {
+            for (size_t i = 0; i < count; ++i)
+               to[i] = from[i].apply(trf);
+         }
+      }
+
+      void apply_transform(const transform_t& trf, const edge_t* from, edge_t* to, size_t count)
+      {
+         if constexpr (sizeof(point_t) == 2 * sizeof(double) && sizeof(edge_t) == 2 * sizeof(point_t))
+         {
+            apply_coordinates(trf, &from->p1.x, &to->p1.x, count * 2);
+         }
+         else
+         {
+            for (size_t i = 0; i < count; ++i)
+               to[i] = edge_t(from[i].p1.apply(trf), from[i].p2.apply(trf));
+         }
+      }
+
+      std::vector<point_t> apply_transform(const transform_t& trf, const std::vector<point_t>& points)
+      {
+         std::vector<point_t> result(points.size());
+         apply_transform(trf, points.data(), result.data(), points.size());
+         return result;
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
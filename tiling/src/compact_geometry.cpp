@@ -0,0 +1,19 @@
+#include <dak/tiling/compact_geometry.h>
+
+namespace dak
+{
+   namespace tiling
+   {
+      compact_edges_t make_compact_edges(const edges_map_t& map)
+      {
+         compact_edges_t edges;
+         edges.reserve(map.all().size() / 2);
+         for (const auto& edge : map.all())
+            if (edge.is_canonical())
+               edges.emplace_back(edge);
+         return edges;
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
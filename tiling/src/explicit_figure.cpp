@@ -17,6 +17,15 @@ namespace dak
          return ss.str();
       }
 
+      void explicit_figure_t::add_to_hash(content_hash_t& hash) const
+      {
+         // Note: the whole map is hashed, but only once per map since setting it changes the version.
+         hash.add(std::wstring_view(L"explicit"));
+         hash.add(uint64_t(my_cached_map.all().size()));
+         for (const auto& edge : my_cached_map.all())
+            hash.add(edge.p1).add(edge.p2);
+      }
+
       std::shared_ptr<figure_t> explicit_figure_t::clone() const
       {
          return std::make_shared<explicit_figure_t>(*this);
@@ -34,6 +34,7 @@ namespace dak
       {
          if (other.child)
             child = std::dynamic_pointer_cast<radial_figure_t>(other.child->clone());
+         copy_cached_child(other);
       }
 
       extended_figure_t& extended_figure_t::operator=(const extended_figure_t& other)
@@ -43,9 +44,19 @@ namespace dak
             child = std::dynamic_pointer_cast<radial_figure_t>(other.child->clone());
          else
             child = nullptr;
+         copy_cached_child(other);
          return *this;
       }
 
+      void extended_figure_t::copy_cached_child(const extended_figure_t& other)
+      {
+         // The cloned child has the same version as the original child,
+         // so the copied map is still valid if it was valid for the original.
+         const bool was_cached = (other.my_cached_child == other.child.get());
+         my_cached_child = was_cached ? child.get() : nullptr;
+         my_cached_child_version = other.my_cached_child_version;
+      }
+
       std::shared_ptr<figure_t> extended_figure_t::clone() const
       {
          return std::make_shared<extended_figure_t>(*this);
@@ -53,7 +64,7 @@ namespace dak
 
       void extended_figure_t::child_changed()
       {
-         my_cached_s_last_build_unit = NAN;
+         parameters_changed();
       }
 
       bool extended_figure_t::operator==(const figure_t& other) const
@@ -68,6 +79,13 @@ namespace dak
          return *child == *other_extended->child;
       }
 
+      void extended_figure_t::add_to_hash(content_hash_t& hash) const
+      {
+         hash.add(std::wstring_view(L"extended"));
+         if (child)
+            hash.add(child->content_hash());
+      }
+
       bool extended_figure_t::is_similar(const figure_t& other) const
       {
          const auto other_extended = dynamic_cast<const extended_figure_t *>(&other);
@@ -106,15 +124,18 @@ namespace dak
 
       bool extended_figure_t::is_cache_valid() const
       {
+         // Note: the scale only depends on the child, so there is no need
+         //       to build the child unit to compute it again.
          return scale_figure_t::is_cache_valid()
-             && (!child || child->is_cache_valid())
-             && my_cached_s_last_build_unit == compute_scale();
+             && my_cached_child == child.get()
+             && (!child || my_cached_child_version == child->get_version());
       }
 
       void extended_figure_t::update_cached_values() const
       {
          scale_figure_t::update_cached_values();
-         my_cached_s_last_build_unit = compute_scale();
+         my_cached_child = child.get();
+         my_cached_child_version = child ? child->get_version() : 0;
       }
 
       const radial_figure_t* extended_figure_t::get_child() const 
@@ -1,4 +1,5 @@
 #include <dak/tiling/figure.h>
+#include <dak/tiling/trace.h>
 
 namespace dak
 {
@@ -6,21 +7,50 @@ namespace dak
    {
       const edges_map_t& figure_t::get_map() const
       {
-         if (is_cache_valid())
+         // Note: an empty map is rebuilt since it may depend on data
+         //       that is not part of the parameters, like a mosaic.
+         const uint64_t version = get_version();
+         if (my_cached_map_version == version && my_cached_map.all().size() > 0)
             return my_cached_map;
 
+         DAK_TILING_TRACE("figure_t::get_map");
+
          my_cached_map = edges_map_t();
 
          build_map();
 
-         update_cached_values();
+         my_cached_map_version = version;
 
          return my_cached_map;
       }
 
-      bool figure_t::is_cache_valid() const
+      uint64_t figure_t::get_version() const
+      {
+         if (!is_cache_valid())
+         {
+            update_cached_values();
+            ++my_version;
+         }
+         return my_version;
+      }
+
+      uint64_t figure_t::content_hash() const
+      {
+         const uint64_t version = get_version();
+         if (my_cached_hash_version == version)
+            return my_cached_hash;
+
+         content_hash_t hash;
+         add_to_hash(hash);
+         my_cached_hash = hash.value();
+         my_cached_hash_version = version;
+
+         return my_cached_hash;
+      }
+
+      size_t figure_t::memory_usage() const
       {
-         return my_cached_map.all().size() > 0;
+         return tiling::memory_usage(my_cached_map);
       }
    }
 }
@@ -0,0 +1,155 @@
+#include <dak/tiling/incremental_mosaic.h>
+#include <dak/tiling/irregular_figure.h>
+#include <dak/tiling/known_tilings.h>
+#include <dak/tiling/trace.h>
+
+#include <algorithm>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Copy a mosaic so that it shares no figure, and their cached map, with the original.
+         std::shared_ptr<mosaic_t> make_private_copy(const mosaic_t& mosaic)
+         {
+            auto copy = std::make_shared<mosaic_t>(mosaic.tiling);
+            for (const auto& tile_fig : mosaic.tile_figures)
+            {
+               auto fig = tile_fig.second->clone();
+               if (auto irregular = std::dynamic_pointer_cast<irregular_figure_t>(fig))
+                  irregular->mosaic = copy;
+               copy->tile_figures[tile_fig.first] = fig;
+            }
+            return copy;
+         }
+
+         bool is_touching(const rectangle_t& a, const rectangle_t& b)
+         {
+            return a.x <= b.x + b.width
+                && b.x <= a.x + a.width
+                && a.y <= b.y + b.height
+                && b.y <= a.y + a.height;
+         }
+      }
+
+      std::shared_ptr<mosaic_t> incremental_mosaic_t::update(const std::shared_ptr<const tiling_t>& tiling)
+      {
+         DAK_TILING_TRACE("incremental_mosaic_t::update");
+
+         my_stats = stats_t();
+
+         if (!tiling)
+         {
+            clear();
+            return {};
+         }
+
+         auto mo = std::make_shared<mosaic_t>(tiling);
+         std::map<polygon_t, kept_figure_t> figures;
+
+         for (const auto& placed : tiling->tiles)
+         {
+            const polygon_t& tile = placed.first;
+
+            // Note: regular tiles get a star, which does not depend on the other tiles.
+            const uint64_t neighbourhood = tile.is_regular() ? 0 : neighbourhood_hash(*tiling, tile);
+
+            std::shared_ptr<figure_t> fig;
+            const auto pos = my_figures.find(tile);
+            if (pos != my_figures.end() && pos->second.neighbourhood == neighbourhood)
+            {
+               // Note: the clone keeps the cached map of the previous figure.
+               fig = pos->second.figure->clone();
+               if (auto irregular = std::dynamic_pointer_cast<irregular_figure_t>(fig))
+                  irregular->mosaic = mo;
+               my_stats.reused_count += 1;
+            }
+            else
+            {
+               fig = make_default_figure(mo, tile);
+               my_stats.rebuilt_count += 1;
+            }
+
+            mo->tile_figures[tile] = fig;
+            figures[tile] = kept_figure_t{ neighbourhood, fig };
+         }
+
+         // Build the maps now, so that the caller can draw the mosaic without
+         // doing any work. Irregular figures use the maps of the others, so
+         // they are done last.
+         for (const auto& tile_fig : mo->tile_figures)
+            if (!std::dynamic_pointer_cast<irregular_figure_t>(tile_fig.second))
+               tile_fig.second->get_map();
+         for (const auto& tile_fig : mo->tile_figures)
+            if (std::dynamic_pointer_cast<irregular_figure_t>(tile_fig.second))
+               tile_fig.second->get_map();
+
+         // Note: irregular figures refer back to their mosaic, so clear the
+         //       figures of the previous mosaic to break the reference cycle.
+         if (my_mosaic)
+            my_mosaic->tile_figures.clear();
+
+         my_mosaic = mo;
+         my_figures = std::move(figures);
+
+         return make_private_copy(*mo);
+      }
+
+      void incremental_mosaic_t::clear()
+      {
+         if (my_mosaic)
+            my_mosaic->tile_figures.clear();
+
+         my_mosaic = nullptr;
+         my_figures.clear();
+      }
+
+      uint64_t incremental_mosaic_t::neighbourhood_hash(const tiling_t& tiling, const polygon_t& tile)
+      {
+         content_hash_t hash;
+         hash.add(tile);
+
+         const auto pos = tiling.tiles.find(tile);
+         if (pos == tiling.tiles.end())
+            return hash.value();
+
+         // The area around each placement of the tile where the inference looks for neighbours.
+         // Note: the inference tolerates some gap between tiles, so the area is enlarged by
+         //       the size of the tile.
+         std::vector<rectangle_t> areas;
+         for (const auto& trf : pos->second)
+         {
+            rectangle_t bounds = tile.apply(trf).bounds();
+            const double margin = std::max(bounds.width, bounds.height);
+            areas.emplace_back(bounds.x - margin, bounds.y - margin, bounds.width + 2 * margin, bounds.height + 2 * margin);
+         }
+
+         // Hash all tiles around the tile, in the same copies of the tiling as the inference.
+         tiling.surround([&hash, &areas](const tiling_t& tiling, const transform_t& placement)
+         {
+            for (const auto& poly_trfs : tiling.tiles)
+            {
+               for (const auto& trf : poly_trfs.second)
+               {
+                  const polygon_t placed = poly_trfs.first.apply(placement.compose(trf));
+                  const rectangle_t bounds = placed.bounds();
+                  for (const auto& area : areas)
+                  {
+                     if (is_touching(area, bounds))
+                     {
+                        hash.add(placed);
+                        break;
+                     }
+                  }
+               }
+            }
+         });
+
+         return hash.value();
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -1,6 +1,8 @@
 #include <dak/tiling/infer.h>
+#include <dak/tiling/batch_transform.h>
 #include <dak/tiling/infer_mode.h>
 #include <dak/tiling/irregular_figure.h>
+#include <dak/tiling/trace.h>
 
 #include <dak/geometry/edge.h>
 #include <dak/geometry/intersect.h>
@@ -160,6 +162,23 @@ namespace dak
          });
       }
 
+      size_t infer_t::memory_usage() const
+      {
+         size_t usage = 0;
+         for (const auto& tile_map : maps)
+         {
+            usage += map_node_memory_usage<std::pair<const polygon_t, edges_map_t>>();
+            usage += dak::tiling::memory_usage(tile_map.first);
+            usage += dak::tiling::memory_usage(tile_map.second);
+         }
+
+         usage += dak::tiling::memory_usage(placed);
+         for (const auto& pp : placed)
+            usage += dak::tiling::memory_usage(pp.mids);
+
+         return usage;
+      }
+
       ////////////////////////////////////////////////////////////////////////////
       //
       // Building a 3x3 tiling of the prototype.
@@ -170,7 +189,7 @@ namespace dak
       void infer_t::add(const transform_t& trf, const polygon_t* tile)
       {
          int sz = length(tile->points);
-         std::vector<point_t> fpts = geometry::apply(trf, tile->points);
+         std::vector<point_t> fpts = apply_transform(trf, tile->points);
          std::vector<point_t> mids;
          for (int idx = 0; idx < sz; ++idx)
             mids.emplace_back(fpts[idx].convex_sum(fpts[(idx + 1) % sz], 0.5));
@@ -270,7 +289,7 @@ namespace dak
       // boundary with the inference region.
       void infer_t::buildContacts(const placed_points_t& pp, const std::vector<adjacency_info>& adjs, std::vector<contact_t>& contacts) const
       {
-         std::vector<point_t> fpts = geometry::apply(pp.trf, pp.tile->points);
+         std::vector<point_t> fpts = apply_transform(pp.trf, pp.tile->points);
 
          // Get the transformed edges map for each adjacent tile.  I'm surprised
          // at how fast this ends up being!
@@ -428,6 +447,8 @@ namespace dak
 
       edges_map_t infer_t::inferStar(const polygon_t& tile, double d, int s)
       {
+         DAK_TILING_TRACE("infer_t::inferStar");
+
          edges_map_t infer_map;
 
          // Get the index of a good transform for this tile.
@@ -555,6 +576,8 @@ namespace dak
 
       edges_map_t infer_t::inferGirih(const polygon_t& tile, int starSides, double starSkip)
       {
+         DAK_TILING_TRACE("infer_t::inferGirih");
+
          edges_map_t infer_map;
 
          // We use the number of side of the star and how many side it
@@ -572,7 +595,7 @@ namespace dak
 
          const std::vector<point_t>& mid_points = pmain->mids;
 
-         std::vector<point_t> points = geometry::apply(pmain->trf, pmain->tile->points);
+         std::vector<point_t> points = apply_transform(pmain->trf, pmain->tile->points);
 
          const int side_count = length(mid_points);
          for (int side = 0; side < side_count; ++side)
@@ -652,6 +675,8 @@ namespace dak
 
       edges_map_t infer_t::inferIntersect(const polygon_t& tile, int starSides, double starSkip, int s)
       {
+         DAK_TILING_TRACE("infer_t::inferIntersect");
+
          edges_map_t infer_map;
 
          // We use the number of side of the star and how many side it
@@ -671,7 +696,7 @@ namespace dak
          const std::vector<point_t>& mid_points = pmain->mids;
 
          // Get the corners of the tiles.
-         std::vector<point_t> points = geometry::apply(pmain->trf, pmain->tile->points);
+         std::vector<point_t> points = apply_transform(pmain->trf, pmain->tile->points);
 
          // Accumulate all edge intersections and their length.
          std::vector<edges_length_info_t> infos;
@@ -795,6 +820,8 @@ namespace dak
 
       edges_map_t infer_t::inferIntersectProgressive(const polygon_t& tile, int starSides, double starSkip, int s)
       {
+         DAK_TILING_TRACE("infer_t::inferIntersectProgressive");
+
          edges_map_t infer_map;
 
          // We use the number of side of the star and how many side it
@@ -814,7 +841,7 @@ namespace dak
          const std::vector<point_t>& mid_points = pmain->mids;
 
          // Get the corners of the tiles.
-         std::vector<point_t> points = geometry::apply(pmain->trf, pmain->tile->points);
+         std::vector<point_t> points = apply_transform(pmain->trf, pmain->tile->points);
 
          const int side_count = length(mid_points);
          for (int side = 0; side < side_count; ++side)
@@ -859,6 +886,8 @@ namespace dak
 
       edges_map_t infer_t::inferHourglass(const polygon_t& tile, double d, int s)
       {
+         DAK_TILING_TRACE("infer_t::inferHourglass");
+
          edges_map_t infer_map;
 
          // Get the index of a good transform for this tile.
@@ -1024,6 +1053,8 @@ namespace dak
 
       edges_map_t infer_t::inferRosette(const polygon_t& tile, double q, int s, double r)
       {
+         DAK_TILING_TRACE("infer_t::inferRosette");
+
          edges_map_t infer_map;
 
          // Get the index of a good transform for this tile.
@@ -1032,7 +1063,7 @@ namespace dak
             return infer_map;
 
          const std::vector<point_t>& mid_points = pmain->mids;
-         const std::vector<point_t> corner_points = geometry::apply(pmain->trf, tile.points);
+         const std::vector<point_t> corner_points = apply_transform(pmain->trf, tile.points);
 
          int side_count = length(mid_points);
          for (int side = 0; side < side_count; ++side)
@@ -1053,6 +1084,8 @@ namespace dak
 
       edges_map_t infer_t::simple_infer(const polygon_t& tile)
       {
+         DAK_TILING_TRACE("infer_t::simple_infer");
+
          edges_map_t infer_map;
 
          // Get the index of a good transform for this tile.
@@ -1060,7 +1093,7 @@ namespace dak
          if (!pmain)
             return infer_map;
 
-         const std::vector<point_t> fpts = geometry::apply(pmain->trf, pmain->tile->points);
+         const std::vector<point_t> fpts = apply_transform(pmain->trf, pmain->tile->points);
          const polygon_t fpts_poly(fpts);
 
          std::vector<adjacency_info> adjs = getAdjacencies(*pmain);
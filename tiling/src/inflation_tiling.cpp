@@ -28,6 +28,13 @@ namespace dak
          return tiling_t::is_invalid() || s1.is_invalid() || s1.is_trivial() || s2.is_invalid() || s2.is_trivial() || inflation.is_invalid();
       }
 
+      void inflation_tiling_t::add_to_hash(content_hash_t& hash) const
+      {
+         hash.add(std::wstring_view(L"inflation"));
+         tiling_t::add_to_hash(hash);
+         hash.add(s1.p1).add(s1.p2).add(s2.p1).add(s2.p2).add(inflation);
+      }
+
       bool inflation_tiling_t::operator==(const tiling_t& other) const
       {
          if (!tiling_t::operator==(other))
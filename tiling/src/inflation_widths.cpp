@@ -0,0 +1,122 @@
+#include <dak/tiling/inflation_widths.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Number of buckets per entry, to keep about one entry per bucket.
+         const size_t buckets_per_entry = 4;
+      }
+
+      void inflation_widths_t::clear()
+      {
+         my_distances.clear();
+         my_inflations.clear();
+         my_buckets.clear();
+         my_bucket_count = 0;
+         my_bucket_scale = 0.;
+      }
+
+      void inflation_widths_t::add(double distance_2, double inflation)
+      {
+         my_distances.emplace_back(distance_2);
+         my_inflations.emplace_back(inflation);
+         my_buckets.clear();
+      }
+
+      void inflation_widths_t::build()
+      {
+         // Sort by distance, keeping the last inflation added at a given distance.
+         std::vector<size_t> order(my_distances.size());
+         std::iota(order.begin(), order.end(), size_t(0));
+         std::stable_sort(order.begin(), order.end(), [&distances=my_distances](size_t a, size_t b)
+         {
+            return distances[a] < distances[b];
+         });
+
+         std::vector<double> distances;
+         std::vector<double> inflations;
+         distances.reserve(order.size());
+         inflations.reserve(order.size());
+         for (const size_t index : order)
+         {
+            if (distances.size() > 0 && distances.back() == my_distances[index])
+            {
+               inflations.back() = my_inflations[index];
+            }
+            else
+            {
+               distances.emplace_back(my_distances[index]);
+               inflations.emplace_back(my_inflations[index]);
+            }
+         }
+         my_distances.swap(distances);
+         my_inflations.swap(inflations);
+
+         my_buckets.clear();
+         my_bucket_count = 0;
+         my_bucket_scale = 0.;
+         if (my_distances.size() < 2)
+            return;
+
+         my_bucket_count = my_distances.size() * buckets_per_entry;
+         my_bucket_scale = my_bucket_count / (my_distances.back() - my_distances.front());
+
+         // Since the bucket of a distance grows with the distance, all entries
+         // before the first entry of a bucket are in the buckets before it.
+         my_buckets.reserve(my_bucket_count + 1);
+         size_t entry = 0;
+         for (size_t bucket = 0; bucket < my_bucket_count; ++bucket)
+         {
+            while (entry < my_distances.size() && get_bucket(my_distances[entry]) < bucket)
+               ++entry;
+            my_buckets.emplace_back(uint32_t(entry));
+         }
+         my_buckets.emplace_back(uint32_t(my_distances.size()));
+      }
+
+      size_t inflation_widths_t::get_bucket(double distance_2) const
+      {
+         const size_t bucket = size_t((distance_2 - my_distances.front()) * my_bucket_scale);
+         return std::min(bucket, my_bucket_count - 1);
+      }
+
+      double inflation_widths_t::get_width(double distance_2, double width) const
+      {
+         if (my_buckets.size() < 2)
+            return width;
+
+         if (!(distance_2 > my_distances.front()))
+            return width;
+
+         if (distance_2 > my_distances.back())
+            return width * my_inflations.back();
+
+         // The first entry not below the distance is within the bucket of the
+         // distance or is the first entry of the next bucket.
+         const size_t bucket = get_bucket(distance_2);
+         const auto begin = my_distances.begin() + my_buckets[bucket];
+         const auto end = my_distances.begin() + my_buckets[bucket + 1];
+         const size_t pos = std::lower_bound(begin, end, distance_2) - my_distances.begin();
+         const size_t pred = pos - 1;
+
+         const double ratio = (distance_2 - my_distances[pred]) / (my_distances[pos] - my_distances[pred]);
+         const double inflation = my_inflations[pred] + (my_inflations[pos] - my_inflations[pred]) * ratio;
+         return width * inflation;
+      }
+
+      size_t inflation_widths_t::memory_usage() const
+      {
+         return my_distances.capacity() * sizeof(double)
+              + my_inflations.capacity() * sizeof(double)
+              + my_buckets.capacity() * sizeof(uint32_t);
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -33,6 +33,11 @@ namespace dak
              && s     == other_irregular->s;
       }
 
+      void irregular_figure_t::add_to_hash(content_hash_t& hash) const
+      {
+         hash.add(std::wstring_view(L"irregular")).add(poly).add(int(infer)).add(q).add(d).add(s);
+      }
+
       bool irregular_figure_t::is_similar(const figure_t& other) const
       {
          const auto other_irregular = dynamic_cast<const irregular_figure_t *>(&other);
@@ -77,19 +82,25 @@ namespace dak
          return ss.str();
       }
 
+      size_t irregular_figure_t::memory_usage() const
+      {
+         return figure_t::memory_usage()
+              + tiling::memory_usage(poly);
+      }
+
       bool irregular_figure_t::is_cache_valid() const
       {
+         // Note: the polygon is not compared since it is called on every get_map()
+         //       and the polygon can be large. Changing it requires a call to
+         //       parameters_changed().
          return my_cached_infer == infer
              && my_cached_q == q
              && my_cached_d == d
-             && my_cached_s == s
-             && my_cached_poly == poly
-             && figure_t::is_cache_valid();
+             && my_cached_s == s;
       }
 
       void irregular_figure_t::update_cached_values() const
       {
-         my_cached_poly = poly;
          my_cached_infer = infer;
          my_cached_q = q;
          my_cached_d = d;
@@ -18,7 +18,7 @@ namespace dak
    {
       std::wstring add_tiling(known_tilings_t& tilings, const std::shared_ptr<tiling_t>& tiling, const std::filesystem::path& path)
       {
-         const std::wstring name = tiling->name.length() > 0 ? tiling->name : path.stem().c_str();
+         const std::wstring name = tiling->name.length() > 0 ? tiling->name : path.stem().wstring();
          tilings[name] = tiling;
          return name;
       }
@@ -69,28 +69,21 @@ namespace dak
 
          auto mo = std::make_shared<mosaic_t>(tiling);
 
-         // Fill all regular tiles with stars.
          for (const auto& placed : mo->tiling->tiles)
-         {
-            const auto& tile = placed.first;
-            if (tile.is_regular())
-            {
-               mo->tile_figures[tile] = std::make_shared<star_t>(int(tile.points.size()), tile.points.size() / 3., 3);
-            }
-         }
-
-         // Fill all irregular tiles with inferred girih.
-         for (const auto& placed : mo->tiling->tiles)
-         {
-            const auto& tile = placed.first;
-            if (!tile.is_regular())
-            {
-               mo->tile_figures[tile] = std::make_shared<irregular_figure_t>(mo, tile, infer_mode_t::girih, std::max(1.3, tile.points.size() / 3.));
-            }
-         }
+            mo->tile_figures[placed.first] = make_default_figure(mo, placed.first);
 
          return mo;
       }
+
+      std::shared_ptr<figure_t> make_default_figure(const std::shared_ptr<mosaic_t>& mo, const geometry::polygon_t& tile)
+      {
+         // Fill all regular tiles with stars.
+         if (tile.is_regular())
+            return std::make_shared<star_t>(int(tile.points.size()), tile.points.size() / 3., 3);
+
+         // Fill all irregular tiles with inferred girih.
+         return std::make_shared<irregular_figure_t>(mo, tile, infer_mode_t::girih, std::max(1.3, tile.points.size() / 3.));
+      }
    }
 }
 
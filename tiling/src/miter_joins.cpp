@@ -0,0 +1,270 @@
+#include <dak/tiling/miter_joins.h>
+#include <dak/tiling/batch_transform.h>
+
+#include <dak/geometry/utility.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+   #define DAK_TILING_HAS_SSE2
+   #include <emmintrin.h>
+#endif
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Joins whose sine is below this are nearly straight and not mitered.
+         const double min_join_sine = 0.01;
+
+         // Do a mitered join of the two fat lines (a la postscript, for example).
+         // The join point on the other side of the joint can be computed by
+         // reflecting the point returned by this function through the joint.
+         point_t get_join(const point_t& joint, const point_t& a, const point_t& b, double width_a, double width_b)
+         {
+            // Using the sine dot porudct to compute the equivalent of:
+            //
+            //double th = joint.sweep(a, b);
+            //const double sth = std::sin(th);
+            //
+            // But without calling atan and sin, which saves time.
+            const point_t da = (joint - a).normalize();
+            const point_t db = (joint - b).normalize();
+            const double sth = db.sin_dot(da);
+
+            if (utility::near(sth, 0, min_join_sine))
+               return point_t();
+
+            const double la = width_b / sth;
+            const double lb = width_a / sth;
+            const double isx = joint.x - (da.x * la + db.x * lb);
+            const double isy = joint.y - (da.y * la + db.y * lb);
+            return point_t(isx, isy);
+         }
+
+#ifdef DAK_TILING_HAS_SSE2
+
+         // Note: the vector kernel computes two junctions at a time, with the
+         //       same operations as the scalar code written out on coordinates:
+         //       the perpendicular of (x, y) is (-y, x) and the sine dot of
+         //       a with b is a.x * b.y - a.y * b.x.
+
+         __m128d select(__m128d mask, __m128d if_true, __m128d if_false)
+         {
+            return _mm_or_pd(_mm_and_pd(mask, if_true), _mm_andnot_pd(mask, if_false));
+         }
+
+         void normalize(__m128d& x, __m128d& y)
+         {
+            const __m128d one = _mm_set1_pd(1.);
+            const __m128d mag = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)));
+            const __m128d is_zero = _mm_cmpeq_pd(mag, _mm_setzero_pd());
+            const __m128d inv = select(is_zero, one, _mm_div_pd(one, mag));
+            x = _mm_mul_pd(x, inv);
+            y = _mm_mul_pd(y, inv);
+         }
+
+         // Join with normalized directions from a and from b to the joint.
+         // Returns the mask of the lanes where the join is valid.
+         __m128d join(__m128d jx, __m128d jy, __m128d dax, __m128d day, __m128d dbx, __m128d dby, __m128d width_a, __m128d width_b, __m128d& x, __m128d& y)
+         {
+            const __m128d sth = _mm_sub_pd(_mm_mul_pd(dbx, day), _mm_mul_pd(dby, dax));
+            const __m128d abs_sth = _mm_andnot_pd(_mm_set1_pd(-0.), sth);
+            const __m128d valid = _mm_cmpgt_pd(abs_sth, _mm_set1_pd(min_join_sine));
+
+            const __m128d la = _mm_div_pd(width_b, sth);
+            const __m128d lb = _mm_div_pd(width_a, sth);
+            x = _mm_sub_pd(jx, _mm_add_pd(_mm_mul_pd(dax, la), _mm_mul_pd(dbx, lb)));
+            y = _mm_sub_pd(jy, _mm_add_pd(_mm_mul_pd(day, la), _mm_mul_pd(dby, lb)));
+            return valid;
+         }
+
+         __m128d kind_mask(const junction_kind_t* kinds, junction_kind_t kind)
+         {
+            return _mm_castsi128_pd(_mm_set_epi64x(kinds[1] == kind ? -1 : 0, kinds[0] == kind ? -1 : 0));
+         }
+
+#endif
+      }
+
+      std::pair<point_t, point_t> compute_junction(const junction_t& junction)
+      {
+         const point_t perp = (junction.joint - junction.p1).normalize().perp();
+         const point_t dead_below = junction.joint - perp.scale(junction.width);
+         const point_t dead_above = junction.joint + perp.scale(junction.width);
+
+         switch (junction.kind)
+         {
+            case junction_kind_t::continuation:
+            {
+               const point_t jp = get_join(junction.joint, junction.p1, junction.below, junction.join_width, junction.other_join_width);
+               if (jp.is_invalid())
+                  break;
+
+               return std::pair<point_t, point_t>(jp, jp.convex_sum(junction.joint, 2.0));
+            }
+
+            case junction_kind_t::intersection:
+            {
+               point_t below = get_join(junction.joint, junction.p1, junction.below, junction.join_width, junction.other_join_width);
+               if (below.is_invalid())
+                  below = dead_below;
+
+               point_t above = get_join(junction.joint, junction.above, junction.p1, junction.other_join_width, junction.join_width);
+               if (above.is_invalid())
+                  above = dead_above;
+
+               return std::pair<point_t, point_t>(below, above);
+            }
+
+            default:
+               break;
+         }
+
+         return std::pair<point_t, point_t>(dead_below, dead_above);
+      }
+
+      void junctions_t::resize(size_t count)
+      {
+         my_kinds.resize(count);
+         for (auto values : { &my_p1_x, &my_p1_y, &my_joint_x, &my_joint_y,
+                              &my_join_below_x, &my_join_below_y, &my_join_above_x, &my_join_above_y,
+                              &my_widths, &my_join_widths, &my_other_join_widths,
+                              &my_below_x, &my_below_y, &my_above_x, &my_above_y })
+            values->resize(count);
+      }
+
+      void junctions_t::set(size_t index, const junction_t& junction)
+      {
+         my_kinds[index] = junction.kind;
+         my_p1_x[index] = junction.p1.x;
+         my_p1_y[index] = junction.p1.y;
+         my_joint_x[index] = junction.joint.x;
+         my_joint_y[index] = junction.joint.y;
+         my_join_below_x[index] = junction.below.x;
+         my_join_below_y[index] = junction.below.y;
+         my_join_above_x[index] = junction.above.x;
+         my_join_above_y[index] = junction.above.y;
+         my_widths[index] = junction.width;
+         my_join_widths[index] = junction.join_width;
+         my_other_join_widths[index] = junction.other_join_width;
+      }
+
+      junction_t junctions_t::get(size_t index) const
+      {
+         junction_t junction;
+         junction.kind = my_kinds[index];
+         junction.p1 = point_t(my_p1_x[index], my_p1_y[index]);
+         junction.joint = point_t(my_joint_x[index], my_joint_y[index]);
+         junction.below = point_t(my_join_below_x[index], my_join_below_y[index]);
+         junction.above = point_t(my_join_above_x[index], my_join_above_y[index]);
+         junction.width = my_widths[index];
+         junction.join_width = my_join_widths[index];
+         junction.other_join_width = my_other_join_widths[index];
+         return junction;
+      }
+
+      void junctions_t::compute(size_t begin, size_t end)
+      {
+#ifdef DAK_TILING_HAS_SSE2
+         if (get_simd_level() != simd_level_t::scalar)
+         {
+            compute_sse2(begin, end);
+            return;
+         }
+#endif
+         compute_scalar(begin, end);
+      }
+
+      void junctions_t::compute_scalar(size_t begin, size_t end)
+      {
+         for (size_t i = begin; i < end; ++i)
+         {
+            const auto points = compute_junction(get(i));
+            my_below_x[i] = points.first.x;
+            my_below_y[i] = points.first.y;
+            my_above_x[i] = points.second.x;
+            my_above_y[i] = points.second.y;
+         }
+      }
+
+#ifdef DAK_TILING_HAS_SSE2
+
+      void junctions_t::compute_sse2(size_t begin, size_t end)
+      {
+         const __m128d two = _mm_set1_pd(2.);
+
+         size_t i = begin;
+         for (; i + 2 <= end; i += 2)
+         {
+            const __m128d p1x = _mm_loadu_pd(&my_p1_x[i]);
+            const __m128d p1y = _mm_loadu_pd(&my_p1_y[i]);
+            const __m128d jx  = _mm_loadu_pd(&my_joint_x[i]);
+            const __m128d jy  = _mm_loadu_pd(&my_joint_y[i]);
+            const __m128d bx  = _mm_loadu_pd(&my_join_below_x[i]);
+            const __m128d by  = _mm_loadu_pd(&my_join_below_y[i]);
+            const __m128d ax  = _mm_loadu_pd(&my_join_above_x[i]);
+            const __m128d ay  = _mm_loadu_pd(&my_join_above_y[i]);
+            const __m128d width       = _mm_loadu_pd(&my_widths[i]);
+            const __m128d join_width  = _mm_loadu_pd(&my_join_widths[i]);
+            const __m128d other_width = _mm_loadu_pd(&my_other_join_widths[i]);
+
+            // Direction of the edge, used by all joins and by the dead ends.
+            __m128d dir_x = _mm_sub_pd(jx, p1x);
+            __m128d dir_y = _mm_sub_pd(jy, p1y);
+            normalize(dir_x, dir_y);
+
+            // Dead ends: the points perpendicular to the edge.
+            const __m128d perp_x = _mm_sub_pd(_mm_setzero_pd(), dir_y);
+            const __m128d perp_y = dir_x;
+            const __m128d dead_below_x = _mm_sub_pd(jx, _mm_mul_pd(perp_x, width));
+            const __m128d dead_below_y = _mm_sub_pd(jy, _mm_mul_pd(perp_y, width));
+            const __m128d dead_above_x = _mm_add_pd(jx, _mm_mul_pd(perp_x, width));
+            const __m128d dead_above_y = _mm_add_pd(jy, _mm_mul_pd(perp_y, width));
+
+            // Join below, with the continuation or the edge after.
+            __m128d below_dir_x = _mm_sub_pd(jx, bx);
+            __m128d below_dir_y = _mm_sub_pd(jy, by);
+            normalize(below_dir_x, below_dir_y);
+            __m128d below_x, below_y;
+            const __m128d below_valid = join(jx, jy, dir_x, dir_y, below_dir_x, below_dir_y, join_width, other_width, below_x, below_y);
+
+            // Join above, with the edge before.
+            __m128d above_dir_x = _mm_sub_pd(jx, ax);
+            __m128d above_dir_y = _mm_sub_pd(jy, ay);
+            normalize(above_dir_x, above_dir_y);
+            __m128d above_x, above_y;
+            const __m128d above_valid = join(jx, jy, above_dir_x, above_dir_y, dir_x, dir_y, other_width, join_width, above_x, above_y);
+
+            // Continuations reflect the join below through the joint.
+            const __m128d reflect_x = _mm_add_pd(below_x, _mm_mul_pd(_mm_sub_pd(jx, below_x), two));
+            const __m128d reflect_y = _mm_add_pd(below_y, _mm_mul_pd(_mm_sub_pd(jy, below_y), two));
+
+            const __m128d is_continuation = kind_mask(&my_kinds[i], junction_kind_t::continuation);
+            const __m128d is_intersection = kind_mask(&my_kinds[i], junction_kind_t::intersection);
+
+            const __m128d use_below = _mm_and_pd(below_valid, _mm_or_pd(is_continuation, is_intersection));
+            const __m128d use_reflect = _mm_and_pd(below_valid, is_continuation);
+            const __m128d use_above = _mm_and_pd(above_valid, is_intersection);
+
+            _mm_storeu_pd(&my_below_x[i], select(use_below, below_x, dead_below_x));
+            _mm_storeu_pd(&my_below_y[i], select(use_below, below_y, dead_below_y));
+            _mm_storeu_pd(&my_above_x[i], select(use_reflect, reflect_x, select(use_above, above_x, dead_above_x)));
+            _mm_storeu_pd(&my_above_y[i], select(use_reflect, reflect_y, select(use_above, above_y, dead_above_y)));
+         }
+
+         compute_scalar(i, end);
+      }
+
+#else
+
+      void junctions_t::compute_sse2(size_t begin, size_t end)
+      {
+         compute_scalar(begin, end);
+      }
+
+#endif
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
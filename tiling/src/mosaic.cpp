@@ -1,22 +1,243 @@
 #include <dak/tiling/mosaic.h>
+#include <dak/tiling/batch_transform.h>
+#include <dak/tiling/trace.h>
+#include <dak/tiling/translation_tiling.h>
+#include <dak/tiling/vertex_keys.h>
 
 #include <dak/geometry/utility.h>
 #include <dak/geometry/transform.h>
 
+#include <cmath>
+#include <unordered_set>
+
 namespace dak
 {
    namespace tiling
    {
+      using geometry::edge_t;
       using geometry::edges_map_t;
       using geometry::transform_t;
 
-      mosaic_t::mosaic_t(const mosaic_t& other)
-      : tiling(other.tiling)
+      namespace
       {
-         for (const auto& tile_fig : other.tile_figures)
+         // The canonical edges of the figure of a tile and the placements of the tile.
+         struct tile_edges_t
+         {
+            const std::vector<transform_t>* placements = nullptr;
+            std::vector<edge_t> edges;
+         };
+
+         std::vector<tile_edges_t> gather_tile_edges(const mosaic_t& mosaic)
+         {
+            std::vector<tile_edges_t> tile_edges;
+            for (const auto& tile_placements : mosaic.tiling->tiles)
+            {
+               const auto iter = mosaic.tile_figures.find(tile_placements.first);
+               if (iter == mosaic.tile_figures.end())
+                  continue;
+
+               tile_edges_t te;
+               te.placements = &tile_placements.second;
+               for (const auto& edge : iter->second->get_map().all())
+                  if (edge.is_canonical())
+                     te.edges.emplace_back(edge);
+               tile_edges.emplace_back(std::move(te));
+            }
+            return tile_edges;
+         }
+
+         edges_map_t construct_quantized(const mosaic_t& mosaic, const rectangle_t& region)
+         {
+            DAK_TILING_TRACE("mosaic_t::construct_quantized");
+
+            const std::vector<tile_edges_t> tile_edges = gather_tile_edges(mosaic);
+
+            // Note: the tiling edges are counted in both directions.
+            const size_t expected_count = mosaic.tiling->count_fill_copies(region) * mosaic.count_tiling_edges() / 2;
+
+            quantized_vertices_t vertices;
+            vertices.reserve(expected_count);
+            unique_edges_t unique_edges;
+            unique_edges.reserve(expected_count);
+            std::vector<edge_t> edges;
+            edges.reserve(expected_count);
+
+            std::vector<edge_t> placed;
+            mosaic.tiling->fill(region, [&](const tiling_t&, const transform_t& receive_trf)
+            {
+               for (const auto& te : tile_edges)
+               {
+                  placed.resize(te.edges.size());
+                  for (const auto& trf : *te.placements)
+                  {
+                     apply_transform(receive_trf.compose(trf), te.edges.data(), placed.data(), placed.size());
+                     for (const edge_t& edge : placed)
+                     {
+                        const uint32_t v1 = vertices.add(edge.p1);
+                        const uint32_t v2 = vertices.add(edge.p2);
+                        if (unique_edges.add(v1, v2))
+                           edges.emplace_back(vertices.get_point(v1), vertices.get_point(v2));
+                     }
+                  }
+               }
+            });
+
+            return make_map_from_unique_edges(edges);
+         }
+
+         // A vertex of a translation tiling: a representative vertex of the
+         // base unit translated by an integer combination of the translations.
+         struct lattice_vertex_t
+         {
+            uint32_t rep = 0;
+            int32_t i = 0;
+            int32_t j = 0;
+
+            bool operator==(const lattice_vertex_t& other) const { return rep == other.rep && i == other.i && j == other.j; }
+            bool operator<(const lattice_vertex_t& other) const
+            {
+               if (rep != other.rep) return rep < other.rep;
+               if (i != other.i) return i < other.i;
+               return j < other.j;
+            }
+         };
+
+         struct lattice_edge_t
+         {
+            lattice_vertex_t v1;
+            lattice_vertex_t v2;
+
+            bool operator==(const lattice_edge_t& other) const { return v1 == other.v1 && v2 == other.v2; }
+         };
+
+         struct lattice_edge_hash_t
          {
-            tile_figures[tile_fig.first] = tile_fig.second->clone();
+            size_t operator()(const lattice_edge_t& edge) const
+            {
+               uint64_t hash = 0xcbf29ce484222325ull;
+               for (const uint32_t value : { edge.v1.rep, uint32_t(edge.v1.i), uint32_t(edge.v1.j), edge.v2.rep, uint32_t(edge.v2.i), uint32_t(edge.v2.j) })
+                  hash = (hash ^ value) * 0x100000001b3ull;
+               return size_t(hash);
+            }
+         };
+
+         // Find the copy of the unit cell spanned by the translations that contains the point,
+         // by solving for its coordinates in the translations. Returns false if the translations
+         // are parallel or the point is too far to be placed.
+         bool find_lattice_cell(const translation_tiling_t& tiling, const point_t& pt, int32_t& i, int32_t& j)
+         {
+            const double det = tiling.t1.x * tiling.t2.y - tiling.t1.y * tiling.t2.x;
+            if (utility::near_zero(det))
+               return false;
+
+            const double a = std::floor((pt.x * tiling.t2.y - pt.y * tiling.t2.x) / det);
+            const double b = std::floor((tiling.t1.x * pt.y - tiling.t1.y * pt.x) / det);
+            constexpr double max_cell = 1e9;
+            if (!(std::abs(a) < max_cell && std::abs(b) < max_cell))
+               return false;
+
+            i = int32_t(a);
+            j = int32_t(b);
+            return true;
          }
+
+         edges_map_t construct_lattice(const mosaic_t& mosaic, const translation_tiling_t& tiling, const rectangle_t& region)
+         {
+            DAK_TILING_TRACE("mosaic_t::construct_lattice");
+
+            const std::vector<tile_edges_t> tile_edges = gather_tile_edges(mosaic);
+
+            // Find the distinct vertices and edges of the base unit.
+            quantized_vertices_t base_vertices;
+            unique_edges_t base_unique_edges;
+            std::vector<std::pair<uint32_t, uint32_t>> base_edges;
+            std::vector<edge_t> placed;
+            for (const auto& te : tile_edges)
+            {
+               placed.resize(te.edges.size());
+               for (const auto& trf : *te.placements)
+               {
+                  apply_transform(trf, te.edges.data(), placed.data(), placed.size());
+                  for (const edge_t& edge : placed)
+                  {
+                     const uint32_t v1 = base_vertices.add(edge.p1);
+                     const uint32_t v2 = base_vertices.add(edge.p2);
+                     if (base_unique_edges.add(v1, v2))
+                        base_edges.emplace_back(v1, v2);
+                  }
+               }
+            }
+
+            // Vertices placed by different translations of a tile are also the same
+            // vertex in different copies of the unit. Key them all by the same
+            // representative vertex by bringing them back into the unit cell.
+            //
+            // Note: vertices on the border of the cell may be brought back on either
+            //       side of it, so the neighbour cells are also searched.
+            quantized_vertices_t reps;
+            std::vector<lattice_vertex_t> lattice(base_vertices.size());
+            for (uint32_t v = 0; v < base_vertices.size(); ++v)
+            {
+               int32_t cell_i, cell_j;
+               if (!find_lattice_cell(tiling, base_vertices.get_point(v), cell_i, cell_j))
+                  return construct_quantized(mosaic, region);
+
+               const point_t pt = base_vertices.get_point(v) + tiling.t1.scale(-cell_i) + tiling.t2.scale(-cell_j);
+               bool found = false;
+               for (int32_t j = -1; j <= 1 && !found; ++j)
+               {
+                  for (int32_t i = -1; i <= 1 && !found; ++i)
+                  {
+                     uint32_t rep;
+                     if (reps.find(pt + tiling.t1.scale(-i) + tiling.t2.scale(-j), rep))
+                     {
+                        lattice[v] = lattice_vertex_t{ rep, cell_i + i, cell_j + j };
+                        found = true;
+                     }
+                  }
+               }
+               if (!found)
+                  lattice[v] = lattice_vertex_t{ reps.add(pt), cell_i, cell_j };
+            }
+
+            const size_t expected_count = tiling.count_fill_copies(region) * base_edges.size();
+            std::unordered_set<lattice_edge_t, lattice_edge_hash_t> unique_edges;
+            unique_edges.reserve(expected_count);
+            std::vector<edge_t> edges;
+            edges.reserve(expected_count);
+
+            // Note: the position of a vertex only depends on its key, so a vertex
+            //       shared by multiple edges always gets the exact same position.
+            auto position = [&reps, &tiling](const lattice_vertex_t& v)
+            {
+               return reps.get_point(v.rep) + tiling.t1.scale(v.i) + tiling.t2.scale(v.j);
+            };
+
+            geometry::fill(region, tiling.t1, tiling.t2, [&](int i, int j)
+            {
+               for (const auto& base_edge : base_edges)
+               {
+                  lattice_vertex_t v1 = lattice[base_edge.first];
+                  v1.i += i;
+                  v1.j += j;
+                  lattice_vertex_t v2 = lattice[base_edge.second];
+                  v2.i += i;
+                  v2.j += j;
+                  if (v2 < v1)
+                     std::swap(v1, v2);
+
+                  if (unique_edges.insert(lattice_edge_t{ v1, v2 }).second)
+                     edges.emplace_back(position(v1), position(v2));
+               }
+            });
+
+            return make_map_from_unique_edges(edges);
+         }
+      }
+
+      mosaic_t::mosaic_t(const mosaic_t& other)
+      : tiling(other.tiling), tile_figures(other.tile_figures)
+      {
       }
 
       mosaic_t& mosaic_t::operator=(const mosaic_t& other)
@@ -37,6 +258,59 @@ namespace dak
          return tiling == other.tiling && same_figures(other);
       }
 
+      std::shared_ptr<figure_t> mosaic_t::get_modifiable_figure(const polygon_t& tile)
+      {
+         const auto iter = tile_figures.find(tile);
+         if (iter == tile_figures.end())
+            return nullptr;
+
+         // Note: the map holds one reference, any other means the figure is shared.
+         auto& fig = iter->second;
+         if (fig && fig.use_count() > 1)
+            fig = fig->clone();
+
+         return fig;
+      }
+
+      uint64_t mosaic_t::content_hash() const
+      {
+         content_hash_t hash;
+         hash.add(tiling ? tiling->content_hash() : uint64_t(0));
+         hash.add(uint64_t(tile_figures.size()));
+         for (const auto& tile_fig : tile_figures)
+         {
+            hash.add(tile_fig.first);
+            hash.add(tile_fig.second ? tile_fig.second->content_hash() : uint64_t(0));
+         }
+         return hash.value();
+      }
+
+      size_t mosaic_t::memory_usage() const
+      {
+         counted_objects_t counted;
+         return memory_usage(counted);
+      }
+
+      size_t mosaic_t::memory_usage(counted_objects_t& counted) const
+      {
+         if (!counted.insert(this).second)
+            return 0;
+
+         size_t usage = 0;
+         if (tiling && counted.insert(tiling.get()).second)
+            usage += tiling->memory_usage();
+
+         for (const auto& tile_fig : tile_figures)
+         {
+            usage += map_node_memory_usage<std::pair<const polygon_t, std::shared_ptr<figure_t>>>();
+            usage += dak::tiling::memory_usage(tile_fig.first);
+            if (tile_fig.second && counted.insert(tile_fig.second.get()).second)
+               usage += tile_fig.second->memory_usage();
+         }
+
+         return usage;
+      }
+
       bool mosaic_t::same_figures(const mosaic_t& other) const
       {
          if (tile_figures.size() != other.tile_figures.size())
@@ -47,6 +321,8 @@ namespace dak
             const auto other_tile_fig = other.tile_figures.find(tile_fig.first);
             if (other_tile_fig == other.tile_figures.end())
                return false;
+            if (tile_fig.second == other_tile_fig->second)
+               continue;
             if (*(tile_fig.second) != *(other_tile_fig->second))
                return false;
          }
@@ -54,6 +330,28 @@ namespace dak
          return true;
       }
 
+      bool mosaic_t::shares_figures(const mosaic_t& other) const
+      {
+         if (tiling != other.tiling)
+            return false;
+
+         if (tile_figures.size() != other.tile_figures.size())
+            return false;
+
+         // Note: both maps are sorted by tile, so they can be compared in order.
+         auto other_tile_fig = other.tile_figures.begin();
+         for (const auto& tile_fig : tile_figures)
+         {
+            if (tile_fig.second != other_tile_fig->second)
+               return false;
+            if (!(tile_fig.first == other_tile_fig->first))
+               return false;
+            ++other_tile_fig;
+         }
+
+         return true;
+      }
+
       size_t mosaic_t::count_tiling_edges() const
       {
          size_t count = 0;
@@ -73,6 +371,8 @@ namespace dak
 
       edges_map_t mosaic_t::construct(const rectangle_t& region) const
       {
+         DAK_TILING_TRACE("mosaic_t::construct");
+
          edges_map_t final_map;
          final_map.reserve(tiling->count_fill_copies(region) * count_tiling_edges());
          final_map.begin_merge_non_overlapping();
@@ -97,6 +397,24 @@ namespace dak
          final_map.end_merge_non_overlapping();
          return final_map;
       }
+
+      edges_map_t mosaic_t::construct(const rectangle_t& region, vertex_merge_t merge) const
+      {
+         switch (merge)
+         {
+            case vertex_merge_t::lattice:
+               if (const auto trans_tiling = std::dynamic_pointer_cast<const translation_tiling_t>(tiling))
+                  if (!trans_tiling->is_invalid())
+                     return construct_lattice(*this, *trans_tiling, region);
+               // Note: other tilings are not lattices, use the quantized merge.
+               return construct_quantized(*this, region);
+            case vertex_merge_t::quantized:
+               return construct_quantized(*this, region);
+            case vertex_merge_t::tolerance:
+            default:
+               return construct(region);
+         }
+      }
    }
 }
 
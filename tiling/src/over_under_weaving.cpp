@@ -0,0 +1,156 @@
+#include <dak/tiling/over_under_weaving.h>
+#include <dak/tiling/parallel.h>
+
+#include <algorithm>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Minimum number of edges for which finding the neighbours is split over threads.
+         const size_t min_edges_per_thread = 2048;
+      }
+
+      over_under_weaving_t::over_under_weaving_t(const edges_map_t& map)
+      {
+         const auto& edges = map.all();
+         const size_t edge_count = edges.size();
+
+         auto find_index = [&edges](const geometry::edge_t& edge) -> size_t
+         {
+            return std::lower_bound(edges.begin(), edges.end(), edge) - edges.begin();
+         };
+
+         // Each edge has as many neighbours as there are edges at its p1: its
+         // twin and all the edges around p1 except itself.
+         my_is_crossing.resize(edge_count);
+         my_neighbour_offsets.resize(edge_count + 1);
+         parallel_for(edge_count, min_edges_per_thread, [&](size_t begin, size_t end)
+         {
+            for (size_t index = begin; index < end; ++index)
+            {
+               const size_t connection_count = map.outbounds(edges[index].p1).size();
+               my_is_crossing[index] = (connection_count != 2);
+               my_neighbour_offsets[index + 1] = connection_count;
+            }
+         });
+
+         for (size_t index = 0; index < edge_count; ++index)
+            my_neighbour_offsets[index + 1] += my_neighbour_offsets[index];
+
+         my_neighbours.resize(my_neighbour_offsets.back());
+         parallel_for(edge_count, min_edges_per_thread, [&](size_t begin, size_t end)
+         {
+            for (size_t index = begin; index < end; ++index)
+            {
+               const geometry::edge_t& cur_edge = edges[index];
+               const geometry::edges_map_t::range_t connections = map.outbounds(cur_edge.p1);
+               const size_t connection_count = connections.size();
+               const geometry::edge_t* conn_edges = &*(connections.begin());
+
+               const auto cur_iter = std::lower_bound(connections.begin(), connections.end(), cur_edge);
+               const size_t cur_index_in_conns = cur_iter - connections.begin();
+
+               size_t* neighbours = my_neighbours.data() + my_neighbour_offsets[index];
+               neighbours[0] = find_index(cur_edge.twin());
+               for (size_t offset = 1; offset < connection_count; ++offset)
+               {
+                  const size_t next_index_in_conns = (cur_index_in_conns + offset) % connection_count;
+                  neighbours[offset] = find_index(conn_edges[next_index_in_conns]);
+               }
+            }
+         });
+
+         label_components();
+      }
+
+      void over_under_weaving_t::label_components()
+      {
+         // Scanning the edges in order, the first edge not yet reached
+         // starts a new group, so each group starts at its smallest edge.
+         std::vector<uint8_t> reached(edge_count(), 0);
+         std::vector<size_t> todos;
+         for (size_t start = 0; start < edge_count(); ++start)
+         {
+            if (reached[start])
+               continue;
+
+            my_component_starts.emplace_back(start);
+            reached[start] = 1;
+            todos.emplace_back(start);
+            while (todos.size() > 0)
+            {
+               const size_t index = todos.back();
+               todos.pop_back();
+               for (size_t i = my_neighbour_offsets[index]; i < my_neighbour_offsets[index + 1]; ++i)
+               {
+                  const size_t neighbour = my_neighbours[i];
+                  if (reached[neighbour])
+                     continue;
+                  reached[neighbour] = 1;
+                  todos.emplace_back(neighbour);
+               }
+            }
+         }
+      }
+
+      void over_under_weaving_t::weave_component(size_t start, std::vector<uint8_t>& is_over, std::vector<uint8_t>& done, std::vector<size_t>& todos) const
+      {
+         todos.emplace_back(start);
+
+         while (todos.size() > 0)
+         {
+            // Retrieve the new current edge to process and remove it from the stack.
+            const size_t index = todos.back();
+            todos.pop_back();
+
+            // If already processed, skip calculations, else mark it as processed.
+            if (done[index])
+               continue;
+            done[index] = 1;
+
+            // Propagate the over/under state to the twin and to all outbound
+            // edges. We flip the state at each edge since the weaving makes
+            // consecutive edges have opposite over/under state.
+            const bool is_crossing = my_is_crossing[index];
+            bool next_is_over = is_crossing ? !is_over[index] : bool(is_over[index]);
+
+            const size_t* neighbours = my_neighbours.data() + my_neighbour_offsets[index];
+            const size_t neighbour_count = my_neighbour_offsets[index + 1] - my_neighbour_offsets[index];
+            for (size_t i = 0; i < neighbour_count; ++i)
+            {
+               const size_t neighbour = neighbours[i];
+               if (!done[neighbour])
+               {
+                  is_over[neighbour] = next_is_over;
+                  todos.emplace_back(neighbour);
+               }
+
+               // The twin gets the same state as the first outbound edge.
+               if (i > 0)
+                  next_is_over = !next_is_over;
+            }
+         }
+      }
+
+      void over_under_weaving_t::weave(std::vector<bool>& is_p1_over) const
+      {
+         // Work on bytes so the groups can be written concurrently.
+         std::vector<uint8_t> is_over(is_p1_over.begin(), is_p1_over.end());
+         std::vector<uint8_t> done(edge_count(), 0);
+
+         parallel_for(component_count(), 1, [&](size_t begin, size_t end)
+         {
+            std::vector<size_t> todos;
+            for (size_t component = begin; component < end; ++component)
+               weave_component(my_component_starts[component], is_over, done, todos);
+         });
+
+         std::copy(is_over.begin(), is_over.end(), is_p1_over.begin());
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
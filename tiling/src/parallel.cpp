@@ -0,0 +1,212 @@
+#include <dak/tiling/parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         size_t hardware_thread_count()
+         {
+            return std::max<size_t>(1, std::thread::hardware_concurrency());
+         }
+
+         std::atomic<size_t>& current_thread_count()
+         {
+            static std::atomic<size_t> count(hardware_thread_count());
+            return count;
+         }
+
+         ////////////////////////////////////////////////////////////////////////////
+         //
+         // Threads kept between calls to run the queued tasks.
+         //
+         // The threads waiting for their tasks also run the queued tasks, so the
+         // tasks are done even if no thread could be created and parallel calls
+         // made from within a task cannot deadlock.
+
+         class thread_pool_t
+         {
+         public:
+            static thread_pool_t& instance()
+            {
+               static thread_pool_t pool;
+               return pool;
+            }
+
+            ~thread_pool_t()
+            {
+               {
+                  std::lock_guard<std::mutex> lock(my_mutex);
+                  my_stopping = true;
+               }
+               my_task_ready.notify_all();
+               for (auto& thread : my_threads)
+                  thread.join();
+            }
+
+            // Start threads until there are at least the given number.
+            void reserve_threads(size_t count)
+            {
+               std::lock_guard<std::mutex> lock(my_mutex);
+               while (my_threads.size() < count)
+               {
+                  try
+                  {
+                     my_threads.emplace_back([self=this]() { self->work(); });
+                  }
+                  catch (const std::system_error&)
+                  {
+                     // Note: the waiting threads run the tasks, so fewer threads only means less parallelism.
+                     break;
+                  }
+               }
+            }
+
+            void add_task(std::function<void()> task)
+            {
+               {
+                  std::lock_guard<std::mutex> lock(my_mutex);
+                  my_tasks.emplace_back(std::move(task));
+               }
+               my_task_ready.notify_one();
+            }
+
+            // Run queued tasks until the given tasks are done.
+            void wait_for(const std::atomic<size_t>& remaining_tasks)
+            {
+               std::unique_lock<std::mutex> lock(my_mutex);
+               while (remaining_tasks.load() > 0)
+               {
+                  if (my_tasks.empty())
+                  {
+                     my_task_done.wait(lock);
+                     continue;
+                  }
+
+                  run_next_task(lock);
+               }
+            }
+
+         private:
+            thread_pool_t() { }
+
+            void work()
+            {
+               std::unique_lock<std::mutex> lock(my_mutex);
+               while (true)
+               {
+                  my_task_ready.wait(lock, [self=this]() { return self->my_stopping || !self->my_tasks.empty(); });
+                  if (my_tasks.empty())
+                     return;
+
+                  run_next_task(lock);
+               }
+            }
+
+            void run_next_task(std::unique_lock<std::mutex>& lock)
+            {
+               std::function<void()> task = std::move(my_tasks.front());
+               my_tasks.pop_front();
+
+               lock.unlock();
+               task();
+               lock.lock();
+
+               my_task_done.notify_all();
+            }
+
+            std::mutex my_mutex;
+            std::condition_variable my_task_ready;
+            std::condition_variable my_task_done;
+            std::deque<std::function<void()>> my_tasks;
+            std::vector<std::thread> my_threads;
+            bool my_stopping = false;
+         };
+      }
+
+      size_t get_thread_count()
+      {
+         return current_thread_count().load();
+      }
+
+      void set_thread_count(size_t count)
+      {
+         current_thread_count().store(count > 0 ? count : hardware_thread_count());
+      }
+
+      void parallel_for(size_t count, size_t min_range_size, const std::function<void(size_t begin, size_t end)>& func)
+      {
+         if (count <= 0)
+            return;
+
+         min_range_size = std::max<size_t>(1, min_range_size);
+         const size_t range_count = std::min(get_thread_count(), std::max<size_t>(1, count / min_range_size));
+         if (range_count <= 1)
+         {
+            func(0, count);
+            return;
+         }
+
+         std::exception_ptr error;
+         std::mutex error_mutex;
+
+         const auto run_range = [&func, &error, &error_mutex](size_t begin, size_t end)
+         {
+            try
+            {
+               func(begin, end);
+            }
+            catch (...)
+            {
+               std::lock_guard<std::mutex> lock(error_mutex);
+               if (!error)
+                  error = std::current_exception();
+            }
+         };
+
+         thread_pool_t& pool = thread_pool_t::instance();
+         pool.reserve_threads(range_count - 1);
+
+         // Note: the calling thread processes the first range itself.
+         std::atomic<size_t> remaining_ranges(range_count - 1);
+         for (size_t range = 1; range < range_count; ++range)
+         {
+            const size_t begin = count * range / range_count;
+            const size_t end = count * (range + 1) / range_count;
+            try
+            {
+               pool.add_task([&run_range, &remaining_ranges, begin, end]()
+               {
+                  run_range(begin, end);
+                  --remaining_ranges;
+               });
+            }
+            catch (...)
+            {
+               run_range(begin, end);
+               --remaining_ranges;
+            }
+         }
+
+         run_range(0, count / range_count);
+
+         pool.wait_for(remaining_ranges);
+
+         if (error)
+            std::rethrow_exception(error);
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
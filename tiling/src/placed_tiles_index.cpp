@@ -0,0 +1,253 @@
+#include <dak/tiling/placed_tiles_index.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Tiles covering more cells than this are kept apart and always checked.
+         const uint64_t max_cells_per_tile = 256;
+
+         // Tiles further than this number of cells from the origin are also kept apart.
+         const double max_cell_coordinate = 1e9;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Modifications.
+
+      void placed_tiles_index_t::rebuild(const std::vector<std::shared_ptr<placed_tile_t>>& tiles)
+      {
+         clear();
+
+         // Size the cells after the average tile so that each tile covers few cells.
+         double total_size = 0.;
+         size_t sized_count = 0;
+         for (const auto& placed : tiles)
+         {
+            if (!placed || placed->tile.is_invalid())
+               continue;
+            const rectangle_t bounds = placed->tile.apply(placed->trf).bounds();
+            total_size += std::max(bounds.width, bounds.height);
+            sized_count += 1;
+         }
+         if (sized_count > 0 && total_size > 0.)
+            my_cell_size = total_size / sized_count;
+
+         for (const auto& placed : tiles)
+            add(placed);
+      }
+
+      void placed_tiles_index_t::add(const std::shared_ptr<placed_tile_t>& placed)
+      {
+         if (!placed)
+            return;
+
+         if (my_entries.count(placed.get()))
+         {
+            update(placed);
+            return;
+         }
+
+         entry_t& entry = my_entries[placed.get()];
+         entry.placed = placed;
+         entry.polygon = placed->tile.apply(placed->trf);
+         entry.bounds = entry.polygon.bounds();
+         entry.order = my_next_order++;
+         insert_in_cells(entry);
+      }
+
+      void placed_tiles_index_t::update(const std::shared_ptr<placed_tile_t>& placed)
+      {
+         if (!placed)
+            return;
+
+         const auto pos = my_entries.find(placed.get());
+         if (pos == my_entries.end())
+            return;
+
+         entry_t& entry = pos->second;
+         remove_from_cells(entry);
+         entry.polygon = placed->tile.apply(placed->trf);
+         entry.bounds = entry.polygon.bounds();
+         insert_in_cells(entry);
+      }
+
+      void placed_tiles_index_t::remove(const std::shared_ptr<placed_tile_t>& placed)
+      {
+         if (!placed)
+            return;
+
+         const auto pos = my_entries.find(placed.get());
+         if (pos == my_entries.end())
+            return;
+
+         remove_from_cells(pos->second);
+         my_entries.erase(pos);
+      }
+
+      void placed_tiles_index_t::clear()
+      {
+         my_entries.clear();
+         my_cells.clear();
+         my_large_entries.clear();
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Queries.
+
+      std::vector<const placed_tiles_index_t::entry_t*> placed_tiles_index_t::find(const rectangle_t& region) const
+      {
+         std::vector<const entry_t*> found(my_large_entries.begin(), my_large_entries.end());
+
+         const cell_range_t range = cell_range(region);
+         if (!is_large(range))
+         {
+            for (int64_t y = range.min_y; y <= range.max_y; ++y)
+            {
+               for (int64_t x = range.min_x; x <= range.max_x; ++x)
+               {
+                  const auto pos = my_cells.find(cell_key(x, y));
+                  if (pos != my_cells.end())
+                     found.insert(found.end(), pos->second.begin(), pos->second.end());
+               }
+            }
+         }
+         else
+         {
+            for (const auto& placed_entry : my_entries)
+               found.emplace_back(&placed_entry.second);
+         }
+
+         // Note: tiles covering multiple cells are found more than once.
+         std::sort(found.begin(), found.end(), [](const entry_t* a, const entry_t* b) { return a->order > b->order; });
+         found.erase(std::unique(found.begin(), found.end()), found.end());
+
+         const double region_right = region.x + region.width;
+         const double region_bottom = region.y + region.height;
+         found.erase(std::remove_if(found.begin(), found.end(), [&region, region_right, region_bottom](const entry_t* entry)
+         {
+            return entry->bounds.x > region_right
+                || entry->bounds.y > region_bottom
+                || entry->bounds.x + entry->bounds.width < region.x
+                || entry->bounds.y + entry->bounds.height < region.y;
+         }), found.end());
+
+         return found;
+      }
+
+      bool placed_tiles_index_t::is_overlapped(const placed_tile_t& checked, const point_t& t1, const point_t& t2,
+                                               const std::function<bool(const std::shared_ptr<placed_tile_t>&)>& accepted) const
+      {
+         const point_t checked_center = checked.tile.apply(checked.trf).center();
+
+         // Note: a translated tile can only contain the center if the tile bounds
+         //       contain the center translated the opposite way, so only those
+         //       tiles are checked.
+         for (int y = -1; y <= 1; ++y)
+         {
+            for (int x = -1; x <= 1; ++x)
+            {
+               const point_t offset = t1.scale(x) + t2.scale(y);
+               const point_t untranslated_center = checked_center - offset;
+               const transform_t trf = transform_t::translate(offset);
+
+               for (const auto entry : find(rectangle_t(untranslated_center.x, untranslated_center.y, 0., 0.)))
+               {
+                  if (!accepted(entry->placed))
+                     continue;
+
+                  if (*entry->placed == checked)
+                     continue;
+
+                  if (entry->polygon.apply(trf).is_inside(checked_center))
+                     return true;
+               }
+            }
+         }
+
+         return false;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Grid cells.
+
+      uint64_t placed_tiles_index_t::cell_key(int64_t x, int64_t y)
+      {
+         return (uint64_t(uint32_t(int32_t(x))) << 32) | uint64_t(uint32_t(int32_t(y)));
+      }
+
+      placed_tiles_index_t::cell_range_t placed_tiles_index_t::cell_range(const rectangle_t& rect) const
+      {
+         cell_range_t range = { 0, 0, -1, -1 };
+
+         // Note: invalid tiles have invalid bounds, they are treated as large tiles.
+         if (!std::isfinite(rect.x) || !std::isfinite(rect.y) || !std::isfinite(rect.width) || !std::isfinite(rect.height))
+            return range;
+
+         if (std::abs(rect.x) + std::abs(rect.width) > max_cell_coordinate * my_cell_size ||
+             std::abs(rect.y) + std::abs(rect.height) > max_cell_coordinate * my_cell_size)
+            return range;
+
+         range.min_x = int64_t(std::floor(rect.x / my_cell_size));
+         range.min_y = int64_t(std::floor(rect.y / my_cell_size));
+         range.max_x = int64_t(std::floor((rect.x + rect.width) / my_cell_size));
+         range.max_y = int64_t(std::floor((rect.y + rect.height) / my_cell_size));
+         return range;
+      }
+
+      bool placed_tiles_index_t::is_large(const cell_range_t& range) const
+      {
+         return range.max_x < range.min_x
+             || range.max_y < range.min_y
+             || range.count() > max_cells_per_tile;
+      }
+
+      void placed_tiles_index_t::insert_in_cells(const entry_t& entry)
+      {
+         const cell_range_t range = cell_range(entry.bounds);
+         if (is_large(range))
+         {
+            my_large_entries.insert(&entry);
+            return;
+         }
+
+         for (int64_t y = range.min_y; y <= range.max_y; ++y)
+            for (int64_t x = range.min_x; x <= range.max_x; ++x)
+               my_cells[cell_key(x, y)].emplace_back(&entry);
+      }
+
+      void placed_tiles_index_t::remove_from_cells(const entry_t& entry)
+      {
+         const cell_range_t range = cell_range(entry.bounds);
+         if (is_large(range))
+         {
+            my_large_entries.erase(&entry);
+            return;
+         }
+
+         for (int64_t y = range.min_y; y <= range.max_y; ++y)
+         {
+            for (int64_t x = range.min_x; x <= range.max_x; ++x)
+            {
+               const auto pos = my_cells.find(cell_key(x, y));
+               if (pos == my_cells.end())
+                  continue;
+
+               auto& cell = pos->second;
+               cell.erase(std::remove(cell.begin(), cell.end(), &entry), cell.end());
+               if (cell.empty())
+                  my_cells.erase(pos);
+            }
+         }
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -30,8 +30,7 @@ namespace dak
 
       bool radial_figure_t::is_cache_valid() const
       {
-         return my_cached_n_last_build_unit == n
-             && figure_t::is_cache_valid();
+         return my_cached_n_last_build_unit == n;
       }
 
       void radial_figure_t::update_cached_values() const
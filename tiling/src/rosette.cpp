@@ -49,6 +49,11 @@ namespace dak
              && q == other_rosette->q;
       }
 
+      void rosette_t::add_to_hash(content_hash_t& hash) const
+      {
+         hash.add(std::wstring_view(L"rosette")).add(n).add(q).add(s);
+      }
+
       bool rosette_t::is_similar(const figure_t& other) const
       {
          const auto other_rosette = dynamic_cast<const rosette_t *>(&other);
@@ -0,0 +1,272 @@
+#include <dak/tiling/snap_points_index.h>
+
+#include <dak/geometry/utility.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Points further than this number of cells from the origin are kept apart.
+         const double max_cell_coordinate = 1e9;
+
+         // Queries covering more cells than this check all points instead.
+         const int64_t max_query_cells = 1024;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Modifications.
+
+      void snap_points_index_t::rebuild(const std::vector<std::shared_ptr<placed_tile_t>>& tiles)
+      {
+         clear();
+
+         // Size the cells after the average edge, so that each cell holds few points.
+         double total_length = 0.;
+         size_t edge_count = 0;
+         for (const auto& placed : tiles)
+         {
+            if (!placed || placed->tile.is_invalid())
+               continue;
+            const polygon_t poly = placed->tile.apply(placed->trf);
+            const auto& pts = poly.points;
+            for (size_t i = 0; i < pts.size(); ++i)
+               total_length += std::sqrt(pts[i].distance_2(pts[(i + 1) % pts.size()]));
+            edge_count += pts.size();
+         }
+         if (edge_count > 0 && total_length > 0. && std::isfinite(total_length))
+            my_cell_size = total_length / edge_count;
+
+         for (const auto& placed : tiles)
+            add(placed);
+      }
+
+      void snap_points_index_t::add(const std::shared_ptr<placed_tile_t>& placed)
+      {
+         if (!placed)
+            return;
+
+         if (my_tiles.count(placed.get()))
+         {
+            update(placed);
+            return;
+         }
+
+         tile_points_t& tile = my_tiles[placed.get()];
+         tile.placed = placed;
+         tile.order = my_next_order++;
+         fill_points(tile);
+         insert_in_cells(tile);
+      }
+
+      void snap_points_index_t::update(const std::shared_ptr<placed_tile_t>& placed)
+      {
+         if (!placed)
+            return;
+
+         const auto pos = my_tiles.find(placed.get());
+         if (pos == my_tiles.end())
+            return;
+
+         remove_from_cells(pos->second);
+         fill_points(pos->second);
+         insert_in_cells(pos->second);
+      }
+
+      void snap_points_index_t::remove(const std::shared_ptr<placed_tile_t>& placed)
+      {
+         if (!placed)
+            return;
+
+         const auto pos = my_tiles.find(placed.get());
+         if (pos == my_tiles.end())
+            return;
+
+         remove_from_cells(pos->second);
+         my_tiles.erase(pos);
+      }
+
+      void snap_points_index_t::clear()
+      {
+         my_tiles.clear();
+         my_cells.clear();
+         my_far_points.clear();
+      }
+
+      void snap_points_index_t::fill_points(tile_points_t& tile)
+      {
+         tile.points.clear();
+
+         if (tile.placed->tile.is_invalid())
+            return;
+
+         const polygon_t poly = tile.placed->tile.apply(tile.placed->trf);
+         const auto& pts = poly.points;
+         tile.points.reserve(pts.size() * 2 + 1);
+
+         snap_point_t center;
+         center.pt = poly.center();
+         center.tile = &tile;
+         tile.points.emplace_back(center);
+
+         size_t prev_i = pts.size() - 1;
+         for (size_t i = 0; i < pts.size(); ++i)
+         {
+            snap_point_t vertex;
+            vertex.pt = pts[i];
+            vertex.p1 = i;
+            vertex.tile = &tile;
+            tile.points.emplace_back(vertex);
+
+            snap_point_t middle;
+            middle.pt = pts[prev_i].convex_sum(pts[i], 0.5);
+            middle.p1 = prev_i;
+            middle.p2 = i;
+            middle.tile = &tile;
+            tile.points.emplace_back(middle);
+
+            prev_i = i;
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Queries.
+
+      selection_t snap_points_index_t::find(const point_t& wpt, double sel_dist, const selection_t& excluded_sel) const
+      {
+         // Note: snapping is a single type selection, which uses a larger distance.
+         sel_dist *= 4;
+         const double sel_dist_2 = sel_dist * sel_dist;
+         const std::shared_ptr<placed_tile_t> other_than = tiling_selection::get_placed_tile(excluded_sel);
+
+         std::vector<const snap_point_t*> near_points;
+         auto check_point = [&](const snap_point_t* snap)
+         {
+            if (snap->tile->placed == other_than)
+               return;
+
+            if (!geometry::near(wpt, snap->pt, sel_dist_2))
+               return;
+
+            // Only keep the points of the most recently added tile.
+            if (near_points.size() > 0)
+            {
+               if (near_points.front()->tile->order > snap->tile->order)
+                  return;
+               if (near_points.front()->tile->order < snap->tile->order)
+                  near_points.clear();
+            }
+            near_points.emplace_back(snap);
+         };
+
+         for (const snap_point_t* snap : my_far_points)
+            check_point(snap);
+
+         int64_t min_x, min_y, max_x, max_y;
+         const bool in_grid = cell_of(point_t(wpt.x - sel_dist, wpt.y - sel_dist), min_x, min_y)
+                           && cell_of(point_t(wpt.x + sel_dist, wpt.y + sel_dist), max_x, max_y);
+         if (in_grid && (max_x - min_x + 1) * (max_y - min_y + 1) <= max_query_cells)
+         {
+            for (int64_t y = min_y; y <= max_y; ++y)
+            {
+               for (int64_t x = min_x; x <= max_x; ++x)
+               {
+                  const auto pos = my_cells.find(cell_key(x, y));
+                  if (pos == my_cells.end())
+                     continue;
+                  for (const snap_point_t* snap : pos->second)
+                     check_point(snap);
+               }
+            }
+         }
+         else
+         {
+            for (const auto& placed_tile : my_tiles)
+               for (const snap_point_t& snap : placed_tile.second.points)
+                  check_point(&snap);
+         }
+
+         // Note: the points are kept in the tile in the order the selection lists them.
+         std::sort(near_points.begin(), near_points.end());
+         near_points.erase(std::unique(near_points.begin(), near_points.end()), near_points.end());
+
+         selection_t sel;
+         for (const snap_point_t* snap : near_points)
+         {
+            const auto& placed = snap->tile->placed;
+            if (snap->p1 == size_t(-1))
+               sel.add(point_selection_t(placed));
+            else if (snap->p2 == size_t(-1))
+               sel.add(point_selection_t(placed, snap->p1));
+            else
+               sel.add(point_selection_t(placed, snap->p1, snap->p2));
+         }
+         return sel;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Grid cells.
+
+      uint64_t snap_points_index_t::cell_key(int64_t x, int64_t y)
+      {
+         return (uint64_t(uint32_t(int32_t(x))) << 32) | uint64_t(uint32_t(int32_t(y)));
+      }
+
+      bool snap_points_index_t::cell_of(const point_t& pt, int64_t& x, int64_t& y) const
+      {
+         if (!std::isfinite(pt.x) || !std::isfinite(pt.y))
+            return false;
+
+         if (std::abs(pt.x) > max_cell_coordinate * my_cell_size || std::abs(pt.y) > max_cell_coordinate * my_cell_size)
+            return false;
+
+         x = int64_t(std::floor(pt.x / my_cell_size));
+         y = int64_t(std::floor(pt.y / my_cell_size));
+         return true;
+      }
+
+      void snap_points_index_t::insert_in_cells(const tile_points_t& tile)
+      {
+         for (const snap_point_t& snap : tile.points)
+         {
+            int64_t x, y;
+            if (cell_of(snap.pt, x, y))
+               my_cells[cell_key(x, y)].emplace_back(&snap);
+            else
+               my_far_points.emplace_back(&snap);
+         }
+      }
+
+      void snap_points_index_t::remove_from_cells(const tile_points_t& tile)
+      {
+         for (const snap_point_t& snap : tile.points)
+         {
+            int64_t x, y;
+            if (cell_of(snap.pt, x, y))
+            {
+               const auto pos = my_cells.find(cell_key(x, y));
+               if (pos == my_cells.end())
+                  continue;
+
+               auto& cell = pos->second;
+               cell.erase(std::remove(cell.begin(), cell.end(), &snap), cell.end());
+               if (cell.empty())
+                  my_cells.erase(pos);
+            }
+            else
+            {
+               my_far_points.erase(std::remove(my_far_points.begin(), my_far_points.end(), &snap), my_far_points.end());
+            }
+         }
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -44,6 +44,11 @@ namespace dak
              && d == other_star->d;
       }
 
+      void star_t::add_to_hash(content_hash_t& hash) const
+      {
+         hash.add(std::wstring_view(L"star")).add(n).add(d).add(s);
+      }
+
       bool star_t::is_similar(const figure_t& other) const
       {
          const auto other_star = dynamic_cast<const star_t *>(&other);
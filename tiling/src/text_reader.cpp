@@ -0,0 +1,238 @@
+#include <dak/tiling/text_reader.h>
+
+#include <charconv>
+#include <cwctype>
+#include <iterator>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         constexpr wchar_t quote_delim = L'"';
+         constexpr wchar_t quote_escape = L'\\';
+
+         // Longest number we expect in the files: 17 significant digits, sign,
+         // decimal point and exponent fit well within this.
+         constexpr size_t max_number_length = 64;
+
+         bool is_space(wchar_t c)
+         {
+            return std::iswspace(c) != 0;
+         }
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Creation.
+
+      text_reader_t::text_reader_t(std::wistream& file)
+      : my_text(std::istreambuf_iterator<wchar_t>(file), std::istreambuf_iterator<wchar_t>())
+      {
+      }
+
+      text_reader_t::text_reader_t(std::wstring text)
+      : my_text(std::move(text))
+      {
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Tokenizing.
+
+      bool text_reader_t::skip_spaces()
+      {
+         while (my_pos < my_text.size() && is_space(my_text[my_pos]))
+            ++my_pos;
+
+         return my_pos < my_text.size();
+      }
+
+      bool text_reader_t::at_end()
+      {
+         return my_failed || !skip_spaces();
+      }
+
+      std::wstring_view text_reader_t::peek_word()
+      {
+         if (my_failed || !skip_spaces())
+            return {};
+
+         size_t end = my_pos;
+         while (end < my_text.size() && !is_space(my_text[end]))
+            ++end;
+
+         return std::wstring_view(my_text.data() + my_pos, end - my_pos);
+      }
+
+      std::wstring_view text_reader_t::read_word()
+      {
+         const std::wstring_view word = peek_word();
+         if (word.empty())
+            my_failed = true;
+         my_pos += word.size();
+         return word;
+      }
+
+      std::wstring text_reader_t::read_quoted()
+      {
+         if (my_failed || !skip_spaces())
+         {
+            my_failed = true;
+            return {};
+         }
+
+         if (my_text[my_pos] != quote_delim)
+            return std::wstring(read_word());
+
+         std::wstring text;
+         for (++my_pos; my_pos < my_text.size(); ++my_pos)
+         {
+            wchar_t c = my_text[my_pos];
+            if (c == quote_escape)
+            {
+               if (++my_pos >= my_text.size())
+                  break;
+               c = my_text[my_pos];
+            }
+            else if (c == quote_delim)
+            {
+               ++my_pos;
+               return text;
+            }
+            text += c;
+         }
+
+         // Unterminated quote: like the stream, keep what was read but fail.
+         my_failed = true;
+         return text;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Numbers.
+      //
+      // The characters that can form a number are copied in a small narrow
+      // buffer for std::from_chars. Like the stream extraction, a leading plus
+      // sign is accepted and only the longest valid prefix is consumed.
+
+      size_t text_reader_t::copy_number(char* buffer, size_t buffer_size, bool allow_fraction) const
+      {
+         size_t count = 0;
+         while (count < buffer_size && my_pos + count < my_text.size())
+         {
+            const wchar_t c = my_text[my_pos + count];
+            const bool is_number_char = (c >= L'0' && c <= L'9') || c == L'-' || c == L'+'
+                                     || (allow_fraction && (c == L'.' || c == L'e' || c == L'E'));
+            if (!is_number_char)
+               break;
+            buffer[count++] = char(c);
+         }
+         return count;
+      }
+
+      double text_reader_t::read_double()
+      {
+         if (my_failed || !skip_spaces())
+         {
+            my_failed = true;
+            return 0.;
+         }
+
+         char buffer[max_number_length];
+         const size_t count = copy_number(buffer, max_number_length, true);
+         const size_t skip = (count > 0 && buffer[0] == '+') ? 1 : 0;
+
+         double value = 0.;
+         const auto result = std::from_chars(buffer + skip, buffer + count, value);
+         if (result.ec != std::errc())
+         {
+            my_failed = true;
+            return 0.;
+         }
+
+         my_pos += result.ptr - buffer;
+         return value;
+      }
+
+      int text_reader_t::read_int()
+      {
+         if (my_failed || !skip_spaces())
+         {
+            my_failed = true;
+            return 0;
+         }
+
+         char buffer[max_number_length];
+         const size_t count = copy_number(buffer, max_number_length, false);
+         const size_t skip = (count > 0 && buffer[0] == '+') ? 1 : 0;
+
+         int value = 0;
+         const auto result = std::from_chars(buffer + skip, buffer + count, value);
+         if (result.ec != std::errc())
+         {
+            my_failed = true;
+            return 0;
+         }
+
+         my_pos += result.ptr - buffer;
+         return value;
+      }
+
+      size_t text_reader_t::read_size()
+      {
+         const int value = read_int();
+         if (value < 0)
+         {
+            my_failed = true;
+            return 0;
+         }
+         return size_t(value);
+      }
+
+      bool text_reader_t::read_bool()
+      {
+         const std::wstring_view word = peek_word();
+         if (word.starts_with(L"true"))
+         {
+            my_pos += 4;
+            return true;
+         }
+         if (word.starts_with(L"false"))
+         {
+            my_pos += 5;
+            return false;
+         }
+
+         my_failed = true;
+         return false;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Geometry.
+
+      point_t text_reader_t::read_point()
+      {
+         point_t pt;
+         pt.x = read_double();
+         pt.y = read_double();
+         return pt;
+      }
+
+      transform_t text_reader_t::read_transform()
+      {
+         transform_t trf;
+         trf.scale_x = read_double();
+         trf.rot_1   = read_double();
+         trf.trans_x = read_double();
+         trf.rot_2   = read_double();
+         trf.scale_y = read_double();
+         trf.trans_y = read_double();
+         return trf;
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -1,4 +1,5 @@
 #include <dak/tiling/tiling.h>
+#include <dak/tiling/memory_usage.h>
 
 #include <dak/utility/text.h>
 
@@ -30,6 +31,37 @@ namespace dak
          return tiles == other.tiles;
       }
 
+      uint64_t tiling_t::content_hash() const
+      {
+         content_hash_t hash;
+         add_to_hash(hash);
+         return hash.value();
+      }
+
+      size_t tiling_t::memory_usage() const
+      {
+         size_t usage = 0;
+         for (const auto& tile : tiles)
+         {
+            usage += map_node_memory_usage<std::pair<const polygon_t, std::vector<transform_t>>>();
+            usage += tiling::memory_usage(tile.first);
+            usage += tiling::memory_usage(tile.second);
+         }
+         return usage;
+      }
+
+      void tiling_t::add_to_hash(content_hash_t& hash) const
+      {
+         hash.add(uint64_t(tiles.size()));
+         for (const auto& poly_trfs : tiles)
+         {
+            hash.add(poly_trfs.first);
+            hash.add(uint64_t(poly_trfs.second.size()));
+            for (const auto& trf : poly_trfs.second)
+               hash.add(trf);
+         }
+      }
+
       rectangle_t tiling_t::bounds() const
       {
          rectangle_t tiling_bounds;
@@ -7,8 +7,10 @@
 
 #include <dak/geometry/geometry_io.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <map>
+#include <stdexcept>
 
 namespace dak
 {
@@ -27,17 +29,16 @@ namespace dak
       // Functions for reading tilings in from files.  No real error-checking
       // is done, because I don't expect you to write these files by hand --
       // they should be auto-generated from DesignerPanel.
+      //
+      // The whole file is read at once and parsed with the fast text reader.
 
-      static void read_tiles(std::wistream& file, tiling_t& new_tiling, int tile_count)
+      static void read_tiles(text_reader_t& reader, tiling_t& new_tiling, int tile_count)
       {
          for (int i = 0; i < tile_count; ++i)
          {
-            std::wstring tile_type;
-            int side_count = 0;
-            int trf_count = 0;
-            file >> tile_type >> side_count >> trf_count;
-
-            bool reg = (tile_type == L"regular");
+            const bool reg = (reader.read_word() == L"regular");
+            const int side_count = reader.read_int();
+            const int trf_count = reader.read_int();
 
             std::vector<transform_t>* trfs = nullptr;
             if (reg)
@@ -47,97 +48,84 @@ namespace dak
             else
             {
                polygon_t poly;
+               poly.points.reserve(std::max(side_count, 0));
                for (int si = 0; si < side_count; ++si)
-               {
-                  point_t pt;
-                  file >> pt.x >> pt.y;
-                  poly.points.emplace_back(pt);
-               }
+                  poly.points.emplace_back(reader.read_point());
                trfs = &new_tiling.tiles[poly];
             }
 
+            trfs->reserve(trfs->size() + std::max(trf_count, 0));
             for (int trfi = 0; trfi < trf_count; ++trfi)
-            {
-               transform_t trf;
-               file >> trf.scale_x >> trf.rot_1 >> trf.trans_x
-                  >> trf.rot_2 >> trf.scale_y >> trf.trans_y;
-               trfs->emplace_back(trf);
-            }
+               trfs->emplace_back(reader.read_transform());
          }
       }
 
-      static void read_descriptions(std::wistream& file, tiling_t& new_tiling)
+      static void read_descriptions(text_reader_t& reader, tiling_t& new_tiling)
       {
-         file >> std::quoted(new_tiling.description) >> quoted(new_tiling.author);
+         new_tiling.description = reader.read_quoted();
+         new_tiling.author = reader.read_quoted();
+      }
+
+      static edge_t read_edge(text_reader_t& reader)
+      {
+         edge_t edge;
+         edge.p1 = reader.read_point();
+         edge.p2 = reader.read_point();
+         edge.order = edge.angle();
+         return edge;
       }
 
       std::shared_ptr<tiling_t> read_tiling(std::wistream& file)
       {
          file.imbue(std::locale("C"));
 
-         std::wstring sentry;
-         file >> sentry;
+         text_reader_t reader(file);
+         return read_tiling(reader);
+      }
+
+      std::shared_ptr<tiling_t> read_tiling(text_reader_t& reader)
+      {
+         const std::wstring_view sentry = reader.read_word();
          if (sentry != translation_tiling_sentry && sentry != inflation_tiling_sentry && sentry != inflation_old_tiling_sentry)
-            throw std::exception(L::t("This isn't a tiling file."));
+            throw std::runtime_error(L::t("This isn't a tiling file."));
 
          const bool is_inflation = (sentry == inflation_tiling_sentry);
          const bool is_old_inflation = (sentry == inflation_old_tiling_sentry);
 
-         std::wstring name;
-         file >> std::quoted(name);
+         const std::wstring name = reader.read_quoted();
          if (name.empty())
-            throw std::exception(L::t("Invalid tiling file."));
+            throw std::runtime_error(L::t("Invalid tiling file."));
 
-         int tile_count = 0;
-         file >> tile_count;
+         const int tile_count = reader.read_int();
 
          std::shared_ptr<tiling_t> new_tiling;
 
          if (is_inflation)
          {
-            edge_t s1;
-            edge_t s2;
-            transform_t inflation;
-
-            file >> s1.p1.x >> s1.p1.y >> s1.p2.x >> s1.p2.y;
-            file >> s2.p1.x >> s2.p1.y >> s2.p2.x >> s2.p2.y;
-
-            s1.order = s1.angle();
-            s2.order = s2.angle();
-
-            file >> inflation;
+            const edge_t s1 = read_edge(reader);
+            const edge_t s2 = read_edge(reader);
+            const transform_t inflation = reader.read_transform();
 
             new_tiling = std::make_shared<inflation_tiling_t>(name, s1, s2, inflation);
          }
          else if (is_old_inflation)
          {
-            edge_t s1;
-            edge_t s2;
-            double factor;
-
-            file >> s1.p1.x >> s1.p1.y >> s1.p2.x >> s1.p2.y;
-            file >> s2.p1.x >> s2.p1.y >> s2.p2.x >> s2.p2.y;
-
-            s1.order = s1.angle();
-            s2.order = s2.angle();
-
-            file >> factor;
-
-            transform_t inflation = transform_t::scale(factor);
+            const edge_t s1 = read_edge(reader);
+            const edge_t s2 = read_edge(reader);
+            const transform_t inflation = transform_t::scale(reader.read_double());
 
             new_tiling = std::make_shared<inflation_tiling_t>(name, s1, s2, inflation);
          }
          else
          {
-            point_t t1;
-            point_t t2;
-            file >> t1.x >> t1.y >> t2.x >> t2.y;
+            const point_t t1 = reader.read_point();
+            const point_t t2 = reader.read_point();
 
             new_tiling = std::make_shared<translation_tiling_t>(name, t1, t2);
          }
 
-         read_tiles(file, *new_tiling, tile_count);
-         read_descriptions(file, *new_tiling);
+         read_tiles(reader, *new_tiling, tile_count);
+         read_descriptions(reader, *new_tiling);
 
          return new_tiling;
       }
@@ -1,4 +1,5 @@
 #include <dak/tiling/tiling_selection.h>
+#include <dak/tiling/placed_tiles_index.h>
 
 #include <dak/geometry/utility.h>
 
@@ -18,6 +19,59 @@ namespace dak
             return find_selection(tiles, wpt, sel_dist, excluded_sel, selection_type_t::all);
          }
 
+         namespace
+         {
+            // Find what is selected in a single tile, with its transform already applied.
+            selection_t find_tile_selection(const std::shared_ptr<placed_tile_t>& placed, const polygon_t& placed_tile, const point_t& wpt, double sel_dist_2, bool is_single_type, selection_type_t sel_types)
+            {
+               selection_t new_sel;
+
+               if ((sel_types & selection_type_t::tile) == selection_type_t::tile)
+                  if (placed_tile.is_inside(wpt))
+                     new_sel.add(tile_selection_t{placed});
+
+               // When selecting anything, don't select points or edges if the tile is too small.
+               // Here we define too small as 4 times the area, which is 16 when squared.
+               const bool small_tile = (placed_tile.area() < sel_dist_2 * 16);
+               if (small_tile && !is_single_type)
+                  return new_sel;
+
+               if ((sel_types & selection_type_t::point) == selection_type_t::point)
+                  if (geometry::near(wpt, placed_tile.center(), sel_dist_2))
+                     new_sel.add(point_selection_t(placed));
+
+               size_t prev_i = placed_tile.points.size() - 1;
+               for (size_t i = 0; i < placed_tile.points.size(); ++i)
+               {
+                  const point_t& pt = placed_tile.points[i];
+
+                  const point_t& prev_pt = placed_tile.points[prev_i];
+
+                  // Don't allow selecting end-points of the edge when the edge is too short.
+                  // Here we define too short as 4 times the selection distance, which is 16 when squared.
+                  if (is_single_type || pt.distance_2(prev_pt) > sel_dist_2 * 16)
+                     if ((sel_types & selection_type_t::point) == selection_type_t::point)
+                        if (geometry::near(wpt, pt, sel_dist_2))
+                           new_sel.add(point_selection_t(placed, i));
+
+                  // Don't allow selecting the middle of the edge when the edge is too short.
+                  // Here we define too short as 6 times the selection distance, which is 36 when squared.
+                  if (is_single_type || pt.distance_2(prev_pt) > sel_dist_2 * 36)
+                     if ((sel_types & selection_type_t::point) == selection_type_t::point)
+                        if (geometry::near(wpt, prev_pt.convex_sum(pt, 0.5), sel_dist_2))
+                           new_sel.add(point_selection_t(placed, prev_i, i));
+
+                  if ((sel_types & selection_type_t::edge) == selection_type_t::edge)
+                     if (utility::near_less(wpt.distance_2_to_line(prev_pt, pt), sel_dist_2))
+                        new_sel.add(edge_selection_t{ placed, prev_i, i });
+
+                  prev_i = i;
+               }
+
+               return new_sel;
+            }
+         }
+
          selection_t find_selection(std::vector<std::shared_ptr<placed_tile_t>>& tiles, const point_t& wpt, double sel_dist, const selection_t& excluded_sel, selection_type_t sel_types)
          {
             const bool is_single_type = is_selection_single_type(sel_types);
@@ -36,58 +90,34 @@ namespace dak
                if (other_than == placed)
                   continue;
 
-               selection_t new_sel;
-
-               const auto placed_tile = placed->tile.apply(placed->trf);
+               const selection_t new_sel = find_tile_selection(placed, placed->tile.apply(placed->trf), wpt, sel_dist_2, is_single_type, sel_types);
+               if (new_sel.has_selection())
+                  return new_sel;
+            }
 
-               if ((sel_types & selection_type_t::tile) == selection_type_t::tile)
-                  if (placed_tile.is_inside(wpt))
-                     new_sel.add(tile_selection_t{placed});
+            return selection_t();
+         }
 
-               // When selecting anything, don't select points or edges if the tile is too small.
-               // Here we define too small as 4 times the area, which is 16 when squared.
-               const bool small_tile = (placed_tile.area() < sel_dist_2 * 16);
-               if (small_tile && !is_single_type)
-                  goto check_sel;
+         selection_t find_selection(const placed_tiles_index_t& index, const point_t& wpt, double sel_dist, const selection_t& excluded_sel, selection_type_t sel_types)
+         {
+            const bool is_single_type = is_selection_single_type(sel_types);
+            if (is_single_type)
+               sel_dist *= 4;
 
-               if ((sel_types & selection_type_t::point) == selection_type_t::point)
-                  if (geometry::near(wpt, placed_tile.center(), sel_dist_2))
-                     new_sel.add(point_selection_t(placed));
+            const double sel_dist_2 = sel_dist * sel_dist;
+            const std::shared_ptr<placed_tile_t> other_than = get_placed_tile(excluded_sel);
 
-               if (small_tile && !is_single_type)
-                  goto check_sel;
+            // Only the tiles whose bounds are within the selection distance can be selected.
+            const rectangle_t region(wpt.x - sel_dist, wpt.y - sel_dist, sel_dist * 2, sel_dist * 2);
+            for (const auto entry : index.find(region))
+            {
+               if (entry->placed->tile.is_invalid())
+                  continue;
 
-               {
-                  size_t prev_i = placed_tile.points.size() - 1;
-                  for (size_t i = 0; i < placed_tile.points.size(); ++i)
-                  {
-                     const point_t& pt = placed_tile.points[i];
-
-                     const point_t& prev_pt = placed_tile.points[prev_i];
-
-                     // Don't allow selecting end-points of the edge when the edge is too short.
-                     // Here we define too short as 4 times the selection distance, which is 16 when squared.
-                     if (is_single_type || pt.distance_2(prev_pt) > sel_dist_2 * 16)
-                        if ((sel_types & selection_type_t::point) == selection_type_t::point)
-                           if (geometry::near(wpt, pt, sel_dist_2))
-                              new_sel.add(point_selection_t(placed, i));
-
-                     // Don't allow selecting the middle of the edge when the edge is too short.
-                     // Here we define too short as 6 times the selection distance, which is 36 when squared.
-                     if (is_single_type || pt.distance_2(prev_pt) > sel_dist_2 * 36)
-                        if ((sel_types & selection_type_t::point) == selection_type_t::point)
-                           if (geometry::near(wpt, prev_pt.convex_sum(pt, 0.5), sel_dist_2))
-                              new_sel.add(point_selection_t(placed, prev_i, i));
-
-                     if ((sel_types & selection_type_t::edge) == selection_type_t::edge)
-                        if (utility::near_less(wpt.distance_2_to_line(prev_pt, pt), sel_dist_2))
-                           new_sel.add(edge_selection_t{ placed, prev_i, i });
-
-                     prev_i = i;
-                  }
-               }
+               if (other_than == entry->placed)
+                  continue;
 
-            check_sel:
+               const selection_t new_sel = find_tile_selection(entry->placed, entry->polygon, wpt, sel_dist_2, is_single_type, sel_types);
                if (new_sel.has_selection())
                   return new_sel;
             }
@@ -0,0 +1,134 @@
+#include <dak/tiling/trace.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Maximum number of events kept. Older events are overwritten.
+         const size_t max_trace_events = 1 << 20;
+
+         struct trace_event_t
+         {
+            const char* name;
+            uint32_t thread;
+            int64_t start_us;
+            int64_t duration_us;
+         };
+
+         // Recorded events, used as a ring buffer once full.
+         struct trace_recorder_t
+         {
+            std::mutex mutex;
+            std::vector<trace_event_t> events;
+            size_t next = 0;
+         };
+
+         // Time stamps are relative to the start of the program.
+         const trace_clock_t::time_point trace_origin = trace_clock_t::now();
+
+         trace_recorder_t& get_recorder()
+         {
+            static trace_recorder_t recorder;
+            return recorder;
+         }
+
+         // Small thread numbers are easier to read in the trace viewer than
+         // the native thread ids.
+         uint32_t get_thread_number()
+         {
+            static std::atomic<uint32_t> next_thread_number = 1;
+            thread_local const uint32_t thread_number = next_thread_number++;
+            return thread_number;
+         }
+
+         void write_json_string(std::ostream& stream, const char* text)
+         {
+            stream << '"';
+            for (; *text; ++text)
+            {
+               if (*text == '"' || *text == '\\')
+                  stream << '\\';
+               stream << *text;
+            }
+            stream << '"';
+         }
+      }
+
+      void record_trace_event(const char* name, trace_clock_t::time_point start, trace_clock_t::time_point end)
+      {
+         const uint32_t thread = get_thread_number();
+
+         trace_recorder_t& recorder = get_recorder();
+         const trace_event_t event =
+         {
+            name,
+            thread,
+            std::chrono::duration_cast<std::chrono::microseconds>(start - trace_origin).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+         };
+
+         std::lock_guard<std::mutex> lock(recorder.mutex);
+         if (recorder.events.size() < max_trace_events)
+         {
+            recorder.events.push_back(event);
+         }
+         else
+         {
+            recorder.events[recorder.next] = event;
+            recorder.next = (recorder.next + 1) % max_trace_events;
+         }
+      }
+
+      void write_trace(std::ostream& stream)
+      {
+         std::vector<trace_event_t> events;
+         {
+            trace_recorder_t& recorder = get_recorder();
+            std::lock_guard<std::mutex> lock(recorder.mutex);
+            events.reserve(recorder.events.size());
+            events.insert(events.end(), recorder.events.begin() + recorder.next, recorder.events.end());
+            events.insert(events.end(), recorder.events.begin(), recorder.events.begin() + recorder.next);
+         }
+
+         stream << "{\"traceEvents\":[";
+         bool first = true;
+         for (const auto& event : events)
+         {
+            if (!first)
+               stream << ",";
+            first = false;
+            stream << "\n{\"name\":";
+            write_json_string(stream, event.name);
+            stream << ",\"cat\":\"alhambra\",\"ph\":\"X\"";
+            stream << ",\"ts\":" << event.start_us;
+            stream << ",\"dur\":" << event.duration_us;
+            stream << ",\"pid\":1,\"tid\":" << event.thread << "}";
+         }
+         stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+      }
+
+      void clear_trace()
+      {
+         trace_recorder_t& recorder = get_recorder();
+         std::lock_guard<std::mutex> lock(recorder.mutex);
+         recorder.events.clear();
+         recorder.next = 0;
+      }
+
+      size_t trace_event_count()
+      {
+         trace_recorder_t& recorder = get_recorder();
+         std::lock_guard<std::mutex> lock(recorder.mutex);
+         return recorder.events.size();
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
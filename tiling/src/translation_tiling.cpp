@@ -27,6 +27,13 @@ namespace dak
          return tiling_t::is_invalid() || t1.is_invalid() || t1 == point_t(0., 0.) || t2.is_invalid() || t2 == point_t(0., 0.);
       }
 
+      void translation_tiling_t::add_to_hash(content_hash_t& hash) const
+      {
+         hash.add(std::wstring_view(L"translation"));
+         tiling_t::add_to_hash(hash);
+         hash.add(t1).add(t2);
+      }
+
       bool translation_tiling_t::operator==(const tiling_t& other) const
       {
          if (!tiling_t::operator==(other))
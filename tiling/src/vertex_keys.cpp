@@ -0,0 +1,160 @@
+#include <dak/tiling/vertex_keys.h>
+
+#include <dak/geometry/constants.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace dak
+{
+   namespace tiling
+   {
+      namespace
+      {
+         // Points further than this number of cells from the origin are kept apart.
+         const double max_cell_coordinate = 1e15;
+
+         // Number of edges merged at once when creating a map.
+         const size_t merge_chunk_size = 256;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Quantized vertices.
+
+      quantized_vertices_t::quantized_vertices_t()
+      : quantized_vertices_t(geometry::TOLERANCE)
+      {
+      }
+
+      quantized_vertices_t::quantized_vertices_t(double tolerance)
+      : my_tolerance(tolerance), my_tolerance_2(tolerance * tolerance)
+      {
+      }
+
+      void quantized_vertices_t::reserve(size_t count)
+      {
+         my_points.reserve(count);
+         my_cells.reserve(count);
+      }
+
+      uint32_t quantized_vertices_t::add(const point_t& pt)
+      {
+         uint32_t id;
+         if (find(pt, id))
+            return id;
+
+         id = uint32_t(my_points.size());
+         my_points.emplace_back(pt);
+
+         int64_t x, y;
+         if (cell_of(pt, x, y))
+            my_cells.emplace(cell_key(x, y), id);
+         else
+            my_far_points.emplace_back(id);
+
+         return id;
+      }
+
+      bool quantized_vertices_t::find(const point_t& pt, uint32_t& id) const
+      {
+         int64_t x, y;
+         if (!cell_of(pt, x, y))
+         {
+            for (const uint32_t far_id : my_far_points)
+            {
+               if (my_points[far_id].distance_2(pt) <= my_tolerance_2)
+               {
+                  id = far_id;
+                  return true;
+               }
+            }
+            return false;
+         }
+
+         // Note: cells are as large as the tolerance, so the points within
+         //       the tolerance are in the cells around the point.
+         for (int64_t dy = -1; dy <= 1; ++dy)
+         {
+            for (int64_t dx = -1; dx <= 1; ++dx)
+            {
+               const auto range = my_cells.equal_range(cell_key(x + dx, y + dy));
+               for (auto iter = range.first; iter != range.second; ++iter)
+               {
+                  if (my_points[iter->second].distance_2(pt) <= my_tolerance_2)
+                  {
+                     id = iter->second;
+                     return true;
+                  }
+               }
+            }
+         }
+
+         return false;
+      }
+
+      bool quantized_vertices_t::cell_of(const point_t& pt, int64_t& x, int64_t& y) const
+      {
+         const double cell_x = std::floor(pt.x / my_tolerance);
+         const double cell_y = std::floor(pt.y / my_tolerance);
+         if (!(std::abs(cell_x) < max_cell_coordinate) || !(std::abs(cell_y) < max_cell_coordinate))
+            return false;
+
+         x = int64_t(cell_x);
+         y = int64_t(cell_y);
+         return true;
+      }
+
+      uint64_t quantized_vertices_t::cell_key(int64_t x, int64_t y)
+      {
+         // Note: different cells can have the same key, the distance check sorts them out.
+         return uint64_t(x) * 0x9E3779B97F4A7C15ull ^ uint64_t(y);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Unique edges.
+
+      bool unique_edges_t::add(uint32_t v1, uint32_t v2)
+      {
+         if (v1 == v2)
+            return false;
+
+         if (v1 > v2)
+            std::swap(v1, v2);
+
+         return my_edges.insert((uint64_t(v1) << 32) | uint64_t(v2)).second;
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Map creation.
+
+      edges_map_t make_map_from_unique_edges(const std::vector<edge_t>& edges)
+      {
+         // Note: the edges never overlap, so merging small chunks avoids the
+         //       quadratic cost of inserting edges one by one in a large map.
+         edges_map_t map;
+         map.reserve(edges.size() * 2);
+         map.begin_merge_non_overlapping();
+         edges_map_t chunk;
+         size_t chunk_count = 0;
+         for (const edge_t& edge : edges)
+         {
+            chunk.insert(edge);
+            if (++chunk_count >= merge_chunk_size)
+            {
+               map.merge_non_overlapping(chunk);
+               chunk = edges_map_t();
+               chunk_count = 0;
+            }
+         }
+         if (chunk_count > 0)
+            map.merge_non_overlapping(chunk);
+         map.end_merge_non_overlapping();
+         return map;
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
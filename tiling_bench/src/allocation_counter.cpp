@@ -0,0 +1,102 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace dak
+{
+   namespace tiling_bench
+   {
+      namespace
+      {
+         std::atomic<uint64_t> allocation_count = 0;
+         std::atomic<uint64_t> current_bytes = 0;
+         std::atomic<uint64_t> peak_bytes = 0;
+      }
+
+      allocation_stats_t get_allocation_stats()
+      {
+         allocation_stats_t stats;
+         #ifdef DAK_TILING_COUNT_ALLOCATIONS
+            stats.enabled = true;
+         #endif
+         stats.allocation_count = allocation_count;
+         stats.current_bytes = current_bytes;
+         stats.peak_bytes = peak_bytes;
+         return stats;
+      }
+
+      void reset_peak_allocation()
+      {
+         peak_bytes = current_bytes.load();
+      }
+
+      #ifdef DAK_TILING_COUNT_ALLOCATIONS
+
+      namespace
+      {
+         // Each block is prefixed with its size, keeping the alignment of the block.
+         const size_t block_header_size = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+         void* counted_allocate(size_t size) noexcept
+         {
+            char* block = static_cast<char*>(std::malloc(size + block_header_size));
+            if (!block)
+               return nullptr;
+
+            *reinterpret_cast<size_t*>(block) = size;
+
+            allocation_count += 1;
+            const uint64_t now = (current_bytes += size);
+            uint64_t peak = peak_bytes;
+            while (now > peak && !peak_bytes.compare_exchange_weak(peak, now))
+               ;
+
+            return block + block_header_size;
+         }
+
+         void counted_free(void* ptr) noexcept
+         {
+            if (!ptr)
+               return;
+
+            char* block = static_cast<char*>(ptr) - block_header_size;
+            current_bytes -= *reinterpret_cast<size_t*>(block);
+            std::free(block);
+         }
+
+         void* counted_new(size_t size)
+         {
+            void* ptr = counted_allocate(size ? size : 1);
+            if (!ptr)
+               throw std::bad_alloc();
+            return ptr;
+         }
+      }
+
+      #endif
+   }
+}
+
+#ifdef DAK_TILING_COUNT_ALLOCATIONS
+
+// Replacement of the global allocation functions counting the allocated memory.
+// Note: the aligned variants are not replaced and so not counted.
+
+void* operator new(size_t size) { return dak::tiling_bench::counted_new(size); }
+void* operator new[](size_t size) { return dak::tiling_bench::counted_new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return dak::tiling_bench::counted_allocate(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return dak::tiling_bench::counted_allocate(size ? size : 1); }
+
+void operator delete(void* ptr) noexcept { dak::tiling_bench::counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { dak::tiling_bench::counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { dak::tiling_bench::counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { dak::tiling_bench::counted_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { dak::tiling_bench::counted_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { dak::tiling_bench::counted_free(ptr); }
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef DAK_TILING_BENCH_ALLOCATION_COUNTER_H
+#define DAK_TILING_BENCH_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace dak
+{
+   namespace tiling_bench
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Counts of the memory allocated through the global operator new.
+      //
+      // Allocations are only counted when built with DAK_TILING_COUNT_ALLOCATIONS,
+      // otherwise the statistics are all zero and not enabled.
+      //
+      // The replacement of the global operator new is only done in the benchmark
+      // executable: replacing it in a library would mix allocators between the
+      // modules that link it, for example the tests DLL on Windows.
+
+      struct allocation_stats_t
+      {
+         bool enabled = false;
+         uint64_t allocation_count = 0;
+         uint64_t current_bytes = 0;
+         uint64_t peak_bytes = 0;
+      };
+
+      // Retrieve the allocation counts.
+      allocation_stats_t get_allocation_stats();
+
+      // Restart measuring the peak memory from the current memory.
+      void reset_peak_allocation();
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
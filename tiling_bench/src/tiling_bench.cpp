@@ -0,0 +1,550 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// Benchmarks of the tiling and style pipelines.
+//
+// Runs over the tilings found in a folder and times reading the tilings,
+// building figures, constructing mosaics and generating the styles.
+// The results are written as JSON so they can be compared between releases.
+// Each result also gives the estimated memory held by what it produced.
+//
+// Usage: tiling_bench [--tilings folder] [--output file.json]
+//                     [--iterations count] [--filter text]
+//                     [--trace file.json]
+//
+// The trace is only recorded when built with DAK_TILING_TRACING.
+
+#include "allocation_counter.h"
+
+#include <dak/tiling/batch_transform.h>
+#include <dak/tiling/extended_figure.h>
+#include <dak/tiling/infer.h>
+#include <dak/tiling/irregular_figure.h>
+#include <dak/tiling/known_tilings.h>
+#include <dak/tiling/memory_usage.h>
+#include <dak/tiling/mosaic.h>
+#include <dak/tiling/parallel.h>
+#include <dak/tiling/rosette.h>
+#include <dak/tiling/star.h>
+#include <dak/tiling/tiling_io.h>
+#include <dak/tiling/trace.h>
+
+#include <dak/tiling_style/emboss.h>
+#include <dak/tiling_style/interlace.h>
+#include <dak/tiling_style/outline.h>
+
+#include <dak/geometry/face.h>
+
+#include <dak/utility/text.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+   using namespace dak;
+   using namespace dak::tiling;
+   using namespace dak::tiling_style;
+   using geometry::edges_map_t;
+   using geometry::rectangle_t;
+
+   ////////////////////////////////////////////////////////////////////////////
+   //
+   // Measurements.
+
+   struct result_t
+   {
+      std::wstring tiling;
+      std::string benchmark;
+      std::string variant;
+      size_t items = 0;
+      size_t bytes = 0;
+      std::vector<double> times_ms;
+   };
+
+   struct options_t
+   {
+      std::filesystem::path tilings_folder = L"tilings";
+      std::filesystem::path output;
+      int iterations = 3;
+      std::wstring filter;
+      std::filesystem::path trace;
+   };
+
+   template <class FUNC>
+   std::vector<double> measure(int iterations, FUNC&& func)
+   {
+      std::vector<double> times;
+      for (int i = 0; i < iterations; ++i)
+      {
+         const auto start = std::chrono::steady_clock::now();
+         func();
+         const auto end = std::chrono::steady_clock::now();
+         times.emplace_back(std::chrono::duration<double, std::milli>(end - start).count());
+      }
+      return times;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   //
+   // Give access to the style generation steps, which are protected.
+
+   template <class STYLE>
+   class bench_fat_lines_t : public STYLE
+   {
+   public:
+      size_t run_generate_fat_lines()
+      {
+         this->my_cached_fat_lines = this->generate_fat_lines(false);
+         return this->my_cached_fat_lines.size();
+      }
+   };
+
+   class bench_interlace_t : public bench_fat_lines_t<interlace_t>
+   {
+   public:
+      size_t run_propagate_over_under()
+      {
+         my_is_p1_over.assign(my_map.all().size(), false);
+         propagate_over_under();
+         return my_is_p1_over.size();
+      }
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   //
+   // Benchmarks.
+
+   rectangle_t make_region(const tiling_t& tiling, double factor)
+   {
+      const rectangle_t bounds = tiling.bounds();
+      const double size = std::max(bounds.width, bounds.height) * factor;
+      rectangle_t region;
+      region.x = -size / 2.;
+      region.y = -size / 2.;
+      region.width = size;
+      region.height = size;
+      return region;
+   }
+
+   void bench_read_tiling(const options_t& options, const std::filesystem::path& path, const std::wstring& name, std::vector<result_t>& results)
+   {
+      result_t result { name, "read_tiling", "" };
+      result.times_ms = measure(options.iterations, [&]()
+      {
+         std::wifstream file(path);
+         auto tiling = read_tiling(file);
+         result.items = tiling ? tiling->tiles.size() : 0;
+         result.bytes = tiling ? tiling->memory_usage() : 0;
+      });
+      results.emplace_back(std::move(result));
+   }
+
+   void bench_figure(const options_t& options, const std::wstring& name, const std::string& variant,
+                     std::function<std::shared_ptr<figure_t>()> maker, std::vector<result_t>& results)
+   {
+      result_t result { name, "figure_get_map", variant };
+      result.times_ms = measure(options.iterations, [&]()
+      {
+         auto figure = maker();
+         result.items = figure->get_map().all().size();
+         result.bytes = figure->memory_usage();
+      });
+      results.emplace_back(std::move(result));
+   }
+
+   void bench_figures(const options_t& options, const std::shared_ptr<tiling_t>& tiling, const std::wstring& name, std::vector<result_t>& results)
+   {
+      // Note: inferred figures use the figures of the surrounding tiles.
+      auto mosaic = generate_mosaic(tiling);
+      if (!mosaic)
+         return;
+
+      const infer_mode_t infer_modes[] =
+      {
+         infer_mode_t::star,
+         infer_mode_t::girih,
+         infer_mode_t::intersect,
+         infer_mode_t::progressive,
+         infer_mode_t::hourglass,
+         infer_mode_t::rosette,
+         infer_mode_t::extended_rosette,
+         infer_mode_t::simple,
+      };
+
+      for (const auto& placed : tiling->tiles)
+      {
+         const polygon_t& tile = placed.first;
+         const int n = int(tile.points.size());
+         const std::string sides = std::to_string(n);
+
+         if (tile.is_regular())
+         {
+            bench_figure(options, name, "star " + sides, [n]()
+            {
+               return std::make_shared<star_t>(n, n / 3., 3);
+            }, results);
+
+            bench_figure(options, name, "rosette " + sides, [n]()
+            {
+               return std::make_shared<rosette_t>(n, 0.1, n / 4);
+            }, results);
+
+            bench_figure(options, name, "extended rosette " + sides, [n]()
+            {
+               return std::make_shared<extended_figure_t>(std::make_shared<rosette_t>(n, 0.1, n / 4));
+            }, results);
+         }
+
+         result_t setup { name, "infer_setup", sides };
+         setup.times_ms = measure(options.iterations, [&]()
+         {
+            const infer_t inf(mosaic, tile);
+            setup.items = inf.placed.size();
+            setup.bytes = inf.memory_usage();
+         });
+         results.emplace_back(std::move(setup));
+
+         for (const infer_mode_t infer : infer_modes)
+         {
+            const std::string variant = utility::narrow_text(infer_mode_name(infer)) + " " + sides;
+            bench_figure(options, name, variant, [&mosaic, &tile, infer]()
+            {
+               return std::make_shared<irregular_figure_t>(mosaic, tile, infer);
+            }, results);
+         }
+      }
+
+      // Note: irregular figures refer back to their mosaic, break the cycle.
+      mosaic->tile_figures.clear();
+   }
+
+   void bench_styles(const options_t& options, const std::shared_ptr<mosaic_t>& mosaic, const edges_map_t& map, const std::wstring& name, std::vector<result_t>& results)
+   {
+      {
+         bench_fat_lines_t<outline_t> outline;
+         outline.set_map(map, mosaic->tiling);
+         result_t result { name, "generate_fat_lines", "outline" };
+         result.times_ms = measure(options.iterations, [&]() { result.items = outline.run_generate_fat_lines(); });
+         result.bytes = outline.memory_usage();
+         results.emplace_back(std::move(result));
+
+         // Compare with the generation done in a single thread.
+         const size_t thread_count = get_thread_count();
+         set_thread_count(1);
+         result_t single { name, "generate_fat_lines", "outline single thread" };
+         single.times_ms = measure(options.iterations, [&]() { single.items = outline.run_generate_fat_lines(); });
+         single.bytes = outline.memory_usage();
+         results.emplace_back(std::move(single));
+         set_thread_count(thread_count);
+      }
+
+      {
+         bench_fat_lines_t<emboss_t> emboss;
+         emboss.set_map(map, mosaic->tiling);
+         result_t result { name, "generate_fat_lines", "emboss" };
+         result.times_ms = measure(options.iterations, [&]() { result.items = emboss.run_generate_fat_lines(); });
+         result.bytes = emboss.memory_usage();
+         results.emplace_back(std::move(result));
+      }
+
+      {
+         bench_interlace_t interlace;
+         interlace.set_map(map, mosaic->tiling);
+         result_t result { name, "generate_fat_lines", "interlace" };
+         result.times_ms = measure(options.iterations, [&]() { result.items = interlace.run_generate_fat_lines(); });
+         result.bytes = interlace.memory_usage();
+         results.emplace_back(std::move(result));
+
+         result_t propagate { name, "propagate_over_under", "interlace" };
+         propagate.times_ms = measure(options.iterations, [&]() { propagate.items = interlace.run_propagate_over_under(); });
+         results.emplace_back(std::move(propagate));
+      }
+
+      {
+         result_t result { name, "make_faces", "filled" };
+         result.times_ms = measure(options.iterations, [&]()
+         {
+            std::vector<polygon_t> inside, outside, odd;
+            geometry::face_t::faces_t exteriors;
+            geometry::face_t::make_faces(map, inside, outside, odd, exteriors);
+            result.items = inside.size() + outside.size() + odd.size();
+            result.bytes = dak::tiling::memory_usage(inside) + dak::tiling::memory_usage(outside) + dak::tiling::memory_usage(odd);
+         });
+         results.emplace_back(std::move(result));
+      }
+   }
+
+   void bench_transform(const options_t& options, const edges_map_t& map, const std::wstring& name, std::vector<result_t>& results)
+   {
+      const std::vector<geometry::edge_t> edges(map.all().begin(), map.all().end());
+      std::vector<geometry::edge_t> placed(edges.size());
+      const transform_t trf = transform_t::translate(point_t(1.5, -2.5)).compose(transform_t::rotate(0.3));
+
+      // Note: repeat the transform so that the time is measurable on small maps.
+      const int repeat_count = 100;
+
+      const std::pair<simd_level_t, const char*> levels[] =
+      {
+         { simd_level_t::scalar, "scalar" },
+         { simd_level_t::sse2,   "sse2" },
+         { simd_level_t::avx,    "avx" },
+      };
+
+      for (const auto& level : levels)
+      {
+         if (int(level.first) > int(get_supported_simd_level()))
+            continue;
+
+         set_simd_level(level.first);
+         result_t result { name, "batch_transform", level.second };
+         result.times_ms = measure(options.iterations, [&]()
+         {
+            for (int i = 0; i < repeat_count; ++i)
+               apply_transform(trf, edges.data(), placed.data(), edges.size());
+            result.items = edges.size() * repeat_count;
+         });
+         results.emplace_back(std::move(result));
+      }
+
+      set_simd_level(get_supported_simd_level());
+   }
+
+   void bench_mosaic(const options_t& options, const std::shared_ptr<tiling_t>& tiling, const std::wstring& name, std::vector<result_t>& results)
+   {
+      auto mosaic = generate_mosaic(tiling);
+      if (!mosaic || mosaic->is_invalid())
+         return;
+
+      // Note: build the figures first so that only the construction is measured.
+      mosaic->count_tiling_edges();
+
+      const double region_factors[] = { 2., 4., 8. };
+      edges_map_t styled_map;
+      for (const double factor : region_factors)
+      {
+         const rectangle_t region = make_region(*tiling, factor);
+
+         result_t result { name, "mosaic_construct", "region x" + std::to_string(int(factor)) };
+         result.times_ms = measure(options.iterations, [&]()
+         {
+            edges_map_t map = mosaic->construct(region);
+            result.items = map.all().size();
+            result.bytes = dak::tiling::memory_usage(map);
+            if (factor == 4.)
+               styled_map = std::move(map);
+         });
+         results.emplace_back(std::move(result));
+
+         const std::pair<vertex_merge_t, const char*> merges[] =
+         {
+            { vertex_merge_t::quantized, "quantized" },
+            { vertex_merge_t::lattice,   "lattice" },
+         };
+
+         for (const auto& merge : merges)
+         {
+            result_t merged { name, "mosaic_construct", std::string(merge.second) + " region x" + std::to_string(int(factor)) };
+            merged.times_ms = measure(options.iterations, [&]()
+            {
+               edges_map_t map = mosaic->construct(region, merge.first);
+               merged.items = map.all().size();
+               merged.bytes = dak::tiling::memory_usage(map);
+            });
+            results.emplace_back(std::move(merged));
+         }
+      }
+
+      bench_transform(options, styled_map, name, results);
+      bench_styles(options, mosaic, styled_map, name, results);
+
+      mosaic->tile_figures.clear();
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   //
+   // JSON output.
+
+   std::string json_text(const std::string& text)
+   {
+      std::string quoted = "\"";
+      for (const char c : text)
+      {
+         switch (c)
+         {
+            case '"':  quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n";  break;
+            case '\t': quoted += "\\t";  break;
+            default:
+               if (static_cast<unsigned char>(c) < 0x20)
+               {
+                  char escaped[8];
+                  std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                  quoted += escaped;
+               }
+               else
+               {
+                  quoted += c;
+               }
+               break;
+         }
+      }
+      quoted += "\"";
+      return quoted;
+   }
+
+   std::string json_text(const std::wstring& text)
+   {
+      return json_text(utility::narrow_text(text));
+   }
+
+   void write_json(std::ostream& out, const options_t& options, const std::vector<result_t>& results)
+   {
+      out.precision(6);
+      out << std::fixed;
+      out << "{\n";
+      out << "  \"format\": 1,\n";
+      out << "  \"iterations\": " << options.iterations << ",\n";
+      out << "  \"results\": [\n";
+      for (size_t i = 0; i < results.size(); ++i)
+      {
+         const result_t& result = results[i];
+
+         std::vector<double> sorted = result.times_ms;
+         std::sort(sorted.begin(), sorted.end());
+         double total = 0.;
+         for (const double t : sorted)
+            total += t;
+         const double min = sorted.empty() ? 0. : sorted.front();
+         const double median = sorted.empty() ? 0. : sorted[sorted.size() / 2];
+         const double mean = sorted.empty() ? 0. : total / sorted.size();
+
+         out << "    { \"tiling\": " << json_text(result.tiling)
+             << ", \"benchmark\": " << json_text(result.benchmark)
+             << ", \"variant\": " << json_text(result.variant)
+             << ", \"items\": " << result.items
+             << ", \"bytes\": " << result.bytes
+             << ", \"min_ms\": " << min
+             << ", \"median_ms\": " << median
+             << ", \"mean_ms\": " << mean
+             << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+      }
+      out << "  ]";
+
+      const auto allocations = dak::tiling_bench::get_allocation_stats();
+      if (allocations.enabled)
+      {
+         out << ",\n  \"allocations\": { \"count\": " << allocations.allocation_count
+             << ", \"current_bytes\": " << allocations.current_bytes
+             << ", \"peak_bytes\": " << allocations.peak_bytes << " }";
+      }
+
+      out << "\n}\n";
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   //
+   // Command-line.
+
+   bool parse_options(int argc, char** argv, options_t& options)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         const std::string arg = argv[i];
+         const bool has_value = (i + 1 < argc);
+         if (arg == "--tilings" && has_value)
+            options.tilings_folder = argv[++i];
+         else if (arg == "--output" && has_value)
+            options.output = argv[++i];
+         else if (arg == "--iterations" && has_value)
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+         else if (arg == "--filter" && has_value)
+            options.filter = utility::widen_text(argv[++i]);
+         else if (arg == "--trace" && has_value)
+            options.trace = argv[++i];
+         else
+            return false;
+      }
+      return true;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   options_t options;
+   if (!parse_options(argc, argv, options))
+   {
+      std::cerr << "Usage: tiling_bench [--tilings folder] [--output file.json] [--iterations count] [--filter text] [--trace file.json]\n";
+      return 1;
+   }
+
+   std::vector<std::filesystem::path> paths;
+   try
+   {
+      for (const auto& entry : std::filesystem::directory_iterator(options.tilings_folder))
+         if (entry.path().extension() == L".tiling")
+            paths.emplace_back(entry.path());
+   }
+   catch (const std::exception& ex)
+   {
+      std::cerr << "Cannot read the tilings folder: " << ex.what() << "\n";
+      return 1;
+   }
+
+   // Note: sort the tilings so the results are in the same order on all platforms.
+   std::sort(paths.begin(), paths.end());
+
+   std::vector<result_t> results;
+   for (const auto& path : paths)
+   {
+      const std::wstring name = path.stem().wstring();
+      if (!options.filter.empty() && name.find(options.filter) == std::wstring::npos)
+         continue;
+
+      try
+      {
+         std::wifstream file(path);
+         auto tiling = read_tiling(file);
+         if (!tiling || tiling->is_invalid())
+            continue;
+
+         std::wcerr << L"Benchmarking " << name << L"\n";
+
+         bench_read_tiling(options, path, name, results);
+         bench_figures(options, tiling, name, results);
+         bench_mosaic(options, tiling, name, results);
+      }
+      catch (const std::exception& ex)
+      {
+         std::cerr << "Error: " << ex.what() << "\n";
+      }
+   }
+
+   if (options.output.empty())
+   {
+      write_json(std::cout, options, results);
+   }
+   else
+   {
+      std::ofstream out(options.output);
+      write_json(out, options, results);
+   }
+
+   if (!options.trace.empty())
+   {
+      std::ofstream out(options.trace);
+      dak::tiling::write_trace(out);
+   }
+
+   return 0;
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -53,10 +53,16 @@ namespace dak
       protected:
          // The internal draw is called with the layer transform already applied.
          void internal_draw_fat_lines(ui::drawing_t& drw, const fat_lines_t& fat_lines) override;
+         void internal_draw_fat_lines(ui::drawing_t& drw, const compact_fat_lines_t& fat_lines) override;
 
-         void draw_trap(ui::drawing_t& drw, const point_t& a, const point_t& b, const point_t& c, const point_t& d, const point_t& light, const ui::color_t* greys);
+         // Draw either the full or compact fat lines.
+         template <class FAT_LINES>
+         void draw_embossed_fat_lines(ui::drawing_t& drw, const FAT_LINES& fat_lines);
 
-         std::pair<point_t, point_t> get_points_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections) override;
+         // Draw one of the two trapezoids of a fat line, reusing the given polygon.
+         void draw_trap(ui::drawing_t& drw, const point_t& a, const point_t& b, const point_t& c, const point_t& d, const point_t& light, const ui::color_t* greys, polygon_t& trap);
+
+         tiling::junction_t get_junction_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections) override;
       };
    }
 }
@@ -0,0 +1,153 @@
+#pragma once
+
+#ifndef DAK_TILING_STYLE_FAT_LINES_H
+#define DAK_TILING_STYLE_FAT_LINES_H
+
+#include <dak/tiling/compact_geometry.h>
+
+#include <dak/geometry/point.h>
+#include <dak/geometry/polygon.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling_style
+   {
+      using geometry::point_t;
+      using geometry::polygon_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Buffer of the widened edges drawn by the fat styles.
+      //
+      // Each fat line is an hexagon: the three points around the p1 end of
+      // the edge followed by the three points around the p2 end. The points
+      // of all fat lines are kept in a single contiguous array, six points
+      // per line, and the line-end flags are kept in bitsets, so the buffer
+      // only needs a handful of allocations, whatever the number of lines.
+
+      inline const point_t& to_full_point(const point_t& pt) { return pt; }
+      inline point_t to_full_point(const tiling::point32_t& pt) { return pt.to_point(); }
+
+      template <class POINT>
+      class basic_fat_lines_t
+      {
+      public:
+         typedef POINT point_type;
+
+         static constexpr size_t points_per_line = 6;
+
+         // Number of fat lines.
+         size_t size() const { return my_p1_line_ends.size(); }
+         bool empty() const { return my_p1_line_ends.empty(); }
+
+         // Remove all fat lines, keeping the allocated memory.
+         void clear()
+         {
+            my_points.clear();
+            my_p1_line_ends.clear();
+            my_p2_line_ends.clear();
+         }
+
+         // Prepare to receive the given number of fat lines.
+         void reserve(size_t count)
+         {
+            my_points.reserve(count * points_per_line);
+            my_p1_line_ends.reserve(count);
+            my_p2_line_ends.reserve(count);
+         }
+
+         // Change the number of fat lines. New lines are all zeros.
+         void resize(size_t count)
+         {
+            my_points.resize(count * points_per_line);
+            my_p1_line_ends.resize(count, false);
+            my_p2_line_ends.resize(count, false);
+         }
+
+         // Append a copy of a fat line of another buffer.
+         void push_back(const basic_fat_lines_t& other, size_t other_line)
+         {
+            const POINT* pts = other.points(other_line);
+            my_points.insert(my_points.end(), pts, pts + points_per_line);
+            my_p1_line_ends.push_back(other.is_p1_line_end(other_line));
+            my_p2_line_ends.push_back(other.is_p2_line_end(other_line));
+         }
+
+         // Copy a fat line over another one.
+         void copy_line(size_t to_line, size_t from_line)
+         {
+            if (to_line == from_line)
+               return;
+            const POINT* from = points(from_line);
+            POINT* to = points(to_line);
+            for (size_t i = 0; i < points_per_line; ++i)
+               to[i] = from[i];
+            my_p1_line_ends[to_line] = is_p1_line_end(from_line);
+            my_p2_line_ends[to_line] = is_p2_line_end(from_line);
+         }
+
+         // Replace the fat lines with the fat lines of a buffer of another precision.
+         template <class OTHER_POINT>
+         void assign(const basic_fat_lines_t<OTHER_POINT>& other)
+         {
+            my_points.clear();
+            my_points.reserve(other.size() * points_per_line);
+            for (size_t line = 0; line < other.size(); ++line)
+               for (size_t i = 0; i < points_per_line; ++i)
+                  my_points.emplace_back(other.point(line, i));
+            my_p1_line_ends.assign(other.size(), false);
+            my_p2_line_ends.assign(other.size(), false);
+            for (size_t line = 0; line < other.size(); ++line)
+            {
+               my_p1_line_ends[line] = other.is_p1_line_end(line);
+               my_p2_line_ends[line] = other.is_p2_line_end(line);
+            }
+         }
+
+         // Access the six points of a fat line.
+         POINT* points(size_t line) { return my_points.data() + line * points_per_line; }
+         const POINT* points(size_t line) const { return my_points.data() + line * points_per_line; }
+
+         POINT& point(size_t line, size_t index) { return my_points[line * points_per_line + index]; }
+         const POINT& point(size_t line, size_t index) const { return my_points[line * points_per_line + index]; }
+
+         // Retrieve the hexagon of a fat line in full precision.
+         void get_hexagon(size_t line, polygon_t& hexagon) const
+         {
+            hexagon.points.resize(points_per_line);
+            const POINT* pts = points(line);
+            for (size_t i = 0; i < points_per_line; ++i)
+               hexagon.points[i] = to_full_point(pts[i]);
+         }
+
+         // Access the flags telling if the ends of the fat line are line ends.
+         bool is_p1_line_end(size_t line) const { return my_p1_line_ends[line]; }
+         bool is_p2_line_end(size_t line) const { return my_p2_line_ends[line]; }
+         void set_p1_line_end(size_t line, bool is_end) { my_p1_line_ends[line] = is_end; }
+         void set_p2_line_end(size_t line, bool is_end) { my_p2_line_ends[line] = is_end; }
+
+         // Estimated heap memory held by the buffer.
+         size_t memory_usage() const
+         {
+            return my_points.capacity() * sizeof(POINT)
+                 + my_p1_line_ends.capacity() / 8
+                 + my_p2_line_ends.capacity() / 8;
+         }
+
+      private:
+         std::vector<POINT> my_points;
+         std::vector<bool> my_p1_line_ends;
+         std::vector<bool> my_p2_line_ends;
+      };
+
+      typedef basic_fat_lines_t<point_t> fat_lines_t;
+      typedef basic_fat_lines_t<tiling::point32_t> compact_fat_lines_t;
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -45,12 +45,17 @@ namespace dak
          bool operator==(const layer_t& other) const override;
 
          // Set the map used as the basis to build the style.
-         void set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t) override;
+         void set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t, uint64_t map_id = 0) override;
+
+         // Estimated heap memory held by the map and the cached drawing elements.
+         size_t memory_usage() const override;
 
       protected:
          // The internal draw is called with the layer transform already applied.
          void internal_draw(ui::drawing_t& drw) override;
 
+         // The faces only depend on the map, the color is only used when drawing them.
+         uint64_t my_cached_map_version = 0;
          std::vector<polygon_t> my_cached_inside;
          std::vector<polygon_t> my_cached_outside;
          std::vector<polygon_t> my_cached_odd;
@@ -54,6 +54,9 @@ namespace dak
          // Retrieve a description of this style.
          std::wstring describe() const override;
 
+         // Estimated heap memory held by the map and the cached drawing elements.
+         size_t memory_usage() const override;
+
       protected:
          // The total width including outline and gap.
          double total_width() const { return width + outline_width * 0.45 + gap_width; }
@@ -61,6 +64,10 @@ namespace dak
          // Generate the fat lines.
          fat_lines_t generate_fat_lines(bool all_edges) override;
 
+         // Generate the fat lines in compact precision.
+         // The fat lines are combined in full precision, then converted.
+         compact_fat_lines_t generate_compact_fat_lines(bool all_edges) override;
+
          // Combine fat lines with their twin to have the correct contour at both ends.
          fat_lines_t combine_fat_lines(const fat_lines_t& fat_lines);
 
@@ -69,7 +76,7 @@ namespace dak
 
          // Get the two before/after points needed to draw the p2 junction
          // of the given edge given the number of connections.
-         std::pair<point_t, point_t> get_points_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections) override;
+         tiling::junction_t get_junction_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections) override;
 
          // Clear the cache when the map, transform or parameters changes.
          void clear_cache() override;
@@ -77,25 +84,11 @@ namespace dak
          // Verify if the cache is valid.
          bool is_cache_invalid() const override;
 
-         // Context containing all data needed to do the over/under weaving.
+         // Propagate over/under weaving to all edges.
          //
          // Generated fat lines are guaranteed to be in the same order as
-         // the canonical edges.
-         //
-         // This permits us to easily find the edge associated with each
-         // fat line and track which edge have already been processed.
-         struct over_under_context_t
-         {
-            const geometry::edges_map_t::edges_t& edges;
-            std::vector<size_t> todos;
-            std::vector<bool> done_lines;
-         };
-
-         // Propagate over/under weaving.
-         void propagate_over_under(over_under_context_t& ctx);
-
-         // Propagate over/under weaving at the intersection at the p1 point of the given edge.
-         void propagate_over_under_at_edge_p1(const edge_t& cur_edge, size_t index, over_under_context_t& ctx);
+         // the edges, so the over/under flags are kept in that order too.
+         void propagate_over_under();
 
          // Keep a copy of the parameters when the cache was generated to detect when it goes stale.
          double my_cached_shadow_width = NAN;
@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef DAK_TILING_STYLE_LAYERS_SNAPSHOT_H
+#define DAK_TILING_STYLE_LAYERS_SNAPSHOT_H
+
+#include <dak/ui/layer.h>
+
+#include <memory>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling_style
+   {
+      using ui::layer_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Create a snapshot of layers to be kept in the undo stack.
+      //
+      // The layers, mosaics and figures of snapshots are never modified, they
+      // must be cloned before being edited. The figures are shared with the
+      // snapshotted layers since mosaics clone shared figures before modifying
+      // them, see mosaic_t::get_modifiable_figure(). The mosaics are shared with
+      // the previous snapshot when they use the very same tiling and figures.
+      // The styles are copied without their map.
+      //
+      // Since the sharing is based on identity, an unchanged mosaic is found in
+      // time proportional to its number of figures.
+
+      std::vector<std::shared_ptr<layer_t>> snapshot_layers(
+         const std::vector<std::shared_ptr<layer_t>>& layers,
+         const std::vector<std::shared_ptr<layer_t>>& previous_snapshot);
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
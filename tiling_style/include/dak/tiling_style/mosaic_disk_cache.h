@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef DAK_TILING_STYLE_MOSAIC_DISK_CACHE_H
+#define DAK_TILING_STYLE_MOSAIC_DISK_CACHE_H
+
+#include <dak/tiling/mosaic.h>
+
+#include <dak/geometry/edges_map.h>
+#include <dak/geometry/rectangle.h>
+
+#include <cstdint>
+#include <filesystem>
+
+namespace dak
+{
+   namespace tiling_style
+   {
+      using geometry::edges_map_t;
+      using geometry::rectangle_t;
+      using tiling::mosaic_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Persistent cache of the maps constructed from mosaics.
+      //
+      // Each constructed map is kept in its own file, in a compact binary form.
+      // The file is named after a hash of the serialized mosaic and of the
+      // region that was filled, so modifying the mosaic or the region simply
+      // produces a different file. The oldest files are removed when the cache
+      // holds more than the maximum number of entries.
+
+      class mosaic_disk_cache_t
+      {
+      public:
+         // Create a cache keeping its files in the given folder.
+         mosaic_disk_cache_t(const std::filesystem::path& folder, size_t max_entries = 256);
+
+         // Construct the map of the mosaic in the region, reusing the cached map if any.
+         edges_map_t construct(const mosaic_t& mosaic, const rectangle_t& region);
+
+         // Compute the key identifying a mosaic filling a region.
+         static uint64_t make_key(const mosaic_t& mosaic, const rectangle_t& region);
+
+         // Load a cached map. Returns false if the map was not in the cache
+         // or if the cached file is invalid.
+         bool load(uint64_t key, edges_map_t& map) const;
+
+         // Save a map in the cache.
+         void save(uint64_t key, const edges_map_t& map);
+
+         // Remove all cached maps.
+         void clear();
+
+      private:
+         std::filesystem::path file_path(uint64_t key) const;
+         bool load_file(uint64_t key, edges_map_t& map) const;
+         void trim();
+
+         std::filesystem::path my_folder;
+         size_t my_max_entries;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
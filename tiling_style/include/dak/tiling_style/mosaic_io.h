@@ -5,6 +5,7 @@
 
 
 #include <dak/tiling/known_tilings.h>
+#include <dak/tiling/text_reader.h>
 #include <dak/tiling_style/styled_mosaic.h>
 
 #include <vector>
@@ -21,8 +22,16 @@ namespace dak
       // Functions for reading and writing layers of styles from and to I/O streams.
 
       std::vector<std::shared_ptr<styled_mosaic_t>> read_layered_mosaic(std::wistream& file, const known_tilings_t& knowns);
+      std::vector<std::shared_ptr<styled_mosaic_t>> read_layered_mosaic(tiling::text_reader_t& reader, const known_tilings_t& knowns);
 
       void write_layered_mosaic(std::wostream& file, const std::vector<std::shared_ptr<styled_mosaic_t>>& layers);
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Function for writing a single mosaic, without its style nor position.
+      // The caller is responsible to set the precision and locale of the stream.
+
+      void write_mosaic(std::wostream& file, const tiling::mosaic_t& mosaic);
    }
 }
 
@@ -0,0 +1,102 @@
+#pragma once
+
+#ifndef DAK_TILING_STYLE_MOSAIC_MEMORY_CACHE_H
+#define DAK_TILING_STYLE_MOSAIC_MEMORY_CACHE_H
+
+#include <dak/tiling/mosaic.h>
+
+#include <dak/geometry/edges_map.h>
+#include <dak/geometry/rectangle.h>
+#include <dak/geometry/transform.h>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace dak
+{
+   namespace tiling_style
+   {
+      using geometry::edges_map_t;
+      using geometry::rectangle_t;
+      using geometry::transform_t;
+      using tiling::mosaic_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // In-memory cache of the maps constructed from mosaics.
+      //
+      // The maps are keyed by the content hash of the mosaic, the transform
+      // of its layer and the region that was filled, so the cache stays valid
+      // when mosaics are modified in place. Each entry also keeps a copy of
+      // the mosaic, which is compared on a hit so that a hash collision never
+      // returns the wrong map. The copy shares the figures, which is safe since
+      // figures are cloned before being modified, see get_modifiable_figure().
+      // The least recently used maps are dropped when the cache holds more
+      // than the maximum number of bytes.
+
+      class mosaic_memory_cache_t
+      {
+      public:
+         // Function constructing the map when it is not in the cache.
+         typedef std::function<edges_map_t()> constructor_t;
+
+         // Map found in the cache and its unique id, which can be given to
+         // style_t::set_map() to avoid comparing the map with the current one.
+         struct cached_map_t
+         {
+            const edges_map_t& map;
+            uint64_t map_id;
+         };
+
+         // Create a cache holding at most the given number of bytes of maps.
+         mosaic_memory_cache_t(size_t max_bytes = 256 * 1024 * 1024);
+         virtual ~mosaic_memory_cache_t() = default;
+
+         // Retrieve the map of the mosaic, constructing it if it is not in the cache.
+         //
+         // The returned map stays valid until the next call, which can drop it.
+         // The most recent map is always kept, even when it is larger than the maximum.
+         cached_map_t construct(const mosaic_t& mosaic, const transform_t& trf, const rectangle_t& region, const constructor_t& constructor);
+
+         // Remove all cached maps.
+         void clear();
+
+         // Approximate memory used by the cached maps.
+         size_t size_in_bytes() const { return my_bytes; }
+
+      protected:
+         // Create the key of a map. Different mosaics can have the same key,
+         // in which case the new map replaces the old one.
+         virtual uint64_t make_key(const mosaic_t& mosaic, const transform_t& trf, const rectangle_t& region) const;
+
+      private:
+         struct entry_t
+         {
+            uint64_t key;
+            mosaic_t mosaic;
+            transform_t trf;
+            rectangle_t region;
+            edges_map_t map;
+            uint64_t map_id;
+            size_t bytes;
+         };
+
+         typedef std::list<entry_t> entries_t;
+
+         void trim();
+
+         size_t my_max_bytes;
+         size_t my_bytes = 0;
+
+         // Most recently used entries first.
+         entries_t my_entries;
+         std::unordered_map<uint64_t, entries_t::iterator> my_entries_by_key;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -3,8 +3,11 @@
 #ifndef DAK_TILING_STYLE_OUTLINE_H
 #define DAK_TILING_STYLE_OUTLINE_H
 
+#include <dak/tiling_style/fat_lines.h>
 #include <dak/tiling_style/thick.h>
 
+#include <dak/tiling/miter_joins.h>
+
 #include <dak/geometry/polygon.h>
 
 namespace dak
@@ -42,23 +45,25 @@ namespace dak
          std::wstring describe() const override;
 
          // Set the map used as the basis to build the style.
-         void set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t) override;
+         void set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t, uint64_t map_id = 0) override;
+
+         // Estimated heap memory held by the map and the cached drawing elements.
+         size_t memory_usage() const override;
+
+         // Set the precision of the cached drawing elements.
+         void set_precision(geometry_precision_t p) override;
 
       protected:
          // The internal draw is called with the layer transform already applied.
          void internal_draw(ui::drawing_t& drw) override;
 
-         // Information about each widened edge.
-         struct fat_line_t
-         {
-            polygon_t hexagon;
-            bool p1_is_line_end = false;
-            bool p2_is_line_end = false;
-         };
-         typedef std::vector<fat_line_t> fat_lines_t;
-
          // Keep a copy of the parameters when the cache was generated to detect when it goes stale.
+         // Only one of the full or compact fat lines are cached, depending on the precision.
+         // The colors are not kept since they are only used when drawing the fat lines.
          fat_lines_t my_cached_fat_lines;
+         compact_fat_lines_t my_cached_compact_fat_lines;
+         uint64_t my_cached_map_version = 0;
+         geometry_precision_t my_cached_precision = geometry_precision_t::full;
          double my_cached_width = NAN;
          double my_cached_outline_width = NAN;
 
@@ -70,33 +75,42 @@ namespace dak
 
          // Generate the fat lines.
          // The generated fat lines are guaranteed to be in the same order as the canonical edges.
+         // Large maps are split across multiple threads, so generating one fat line must only read the style.
          virtual fat_lines_t generate_fat_lines(bool all_edges);
 
-         // Generate one fat line of the edge and width.
-         fat_line_t generate_fat_line(const edge_t& edge, const size_t edge_index, double width);
+         // Generate the fat lines directly in compact precision.
+         virtual compact_fat_lines_t generate_compact_fat_lines(bool all_edges);
+
+         // Fill the fat lines of either precision, converting each point as it is computed.
+         template <class FAT_LINES>
+         void fill_fat_lines(bool all_edges, FAT_LINES& fat_lines);
 
          // Draw the fat lines. Override in-sub-class to change the rendering.
          virtual void internal_draw_fat_lines(ui::drawing_t& drw, const fat_lines_t& fat_lines);
+         virtual void internal_draw_fat_lines(ui::drawing_t& drw, const compact_fat_lines_t& fat_lines);
 
-         // Get the two points at the left and right needed to draw the p2 junction
-         // of the given edge at the given width.
-         std::pair<point_t, point_t> get_points(const edge_t& edge, size_t index, double width, bool& is_line_end);
+         // Draw either the full or compact fat lines.
+         template <class FAT_LINES>
+         void draw_outlined_fat_lines(ui::drawing_t& drw, const FAT_LINES& fat_lines);
 
-         // Get the two before/after points needed to draw the p2 junction
-         // of the given edge given the number of connections.
-         virtual std::pair<point_t, point_t> get_points_one_connection(  const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
-         virtual std::pair<point_t, point_t> get_points_two_connections( const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
-         virtual std::pair<point_t, point_t> get_points_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
+         // Get the junction needed to draw the two points at the left and right
+         // of the p2 end of the given edge at the given width.
+         tiling::junction_t get_junction(const edge_t& edge, size_t index, double width, bool& is_line_end);
 
-         // Get the two before/after points needed to draw the p2 junction
-         // of the given edge when we want to treat the intersection ina specific way.
-         std::pair<point_t, point_t> get_points_dead_end(    const edge_t& an_edge, size_t index, double width);
-         std::pair<point_t, point_t> get_points_continuation(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
-         std::pair<point_t, point_t> get_points_intersection(const edge_t& an_edge, size_t index, double width, double other_edges_width, const geometry::edges_map_t::range_t& connections);
+         // Get the junction at the p2 end of the given edge given the number of connections.
+         virtual tiling::junction_t get_junction_one_connection(  const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
+         virtual tiling::junction_t get_junction_two_connections( const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
+         virtual tiling::junction_t get_junction_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
 
-         // Calculate the position of a point to draw the junction properly
-         // given the angle between and b at the joint.
-         point_t get_join(const point_t& joint, const point_t& a, const point_t& b, double width, double other_edges_width);
+         // Get the junction at the p2 end of the given edge when we want
+         // to treat the intersection in a specific way.
+         tiling::junction_t get_junction_dead_end(    const edge_t& an_edge, size_t index, double width);
+         tiling::junction_t get_junction_continuation(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
+         tiling::junction_t get_junction_intersection(const edge_t& an_edge, size_t index, double width, double other_edges_width, const geometry::edges_map_t::range_t& connections);
+
+         // Get the two before/after points of the p2 end of the given edge when
+         // it continues straight through the joint, computed right away.
+         std::pair<point_t, point_t> get_points_continuation(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections);
       };
    }
 }
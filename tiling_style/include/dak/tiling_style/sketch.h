@@ -31,6 +31,9 @@ namespace dak
       protected:
          // The internal draw is called with the layer transform already applied.
          void internal_draw(ui::drawing_t& drw) override;
+
+         // Only the compact edges are drawn in compact precision.
+         bool draws_only_compact_edges() const override { return true; }
       };
    }
 }
@@ -3,10 +3,15 @@
 #ifndef DAK_TILING_STYLE_STYLE_H
 #define DAK_TILING_STYLE_STYLE_H
 
+#include <dak/tiling/compact_geometry.h>
+#include <dak/tiling/inflation_widths.h>
+#include <dak/tiling/memory_usage.h>
+
 #include <dak/geometry/edges_map.h>
 #include <dak/ui/layer.h>
 
-#include <map>
+#include <chrono>
+#include <cstdint>
 
 namespace dak
 {
@@ -23,6 +28,7 @@ namespace dak
       using geometry::edges_map_t;
       using tiling::tiling_t;
       using tiling::inflation_tiling_t;
+      using tiling::geometry_precision_t;
 
       ////////////////////////////////////////////////////////////////////////////
       //
@@ -41,8 +47,18 @@ namespace dak
          virtual std::wstring describe() const = 0;
 
          // Set or access the map used as the basis to build the style.
+         // Setting the same map and tiling again keeps the cached drawing elements.
+         //
+         // The optional map id identifies the source of the map, like an entry
+         // of a map cache. When it is the same non-zero id as the current map,
+         // the maps are not compared, otherwise a different id means a new map.
          const geometry::edges_map_t& get_map() const { return my_map; }
-         virtual void set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t);
+         virtual void set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t, uint64_t map_id = 0);
+
+         // Identity of the map. It changes only when a different map or tiling
+         // is set, so the geometry cached by sub-classes can be validated with it,
+         // while the paint parameters, like colors, are only used when drawing.
+         uint64_t get_map_version() const { return my_map_version; }
 
          // Copy a layer.
          void make_similar(const layer_t& other) override;
@@ -50,16 +66,59 @@ namespace dak
          // Comparison.
          virtual bool operator==(const layer_t& other) const { return layer_t::operator==(other); }
 
+         // Statistics about the last generation of the cached drawing elements.
+         struct generation_stats_t
+         {
+            size_t generation_count = 0;
+            double duration_ms = 0.;
+            size_t item_count = 0;
+         };
+
+         const generation_stats_t& get_generation_stats() const { return my_generation_stats; }
+
+         // Estimated heap memory held by the map and the cached drawing elements.
+         virtual size_t memory_usage() const;
+
+         // Set or access the precision of the cached drawing elements.
+         // The compact precision is for display only: exports should use the full precision.
+         //
+         // Styles that only draw the compact edges release their map in compact
+         // precision, so the map must be set again after going back to full precision.
+         geometry_precision_t get_precision() const { return my_precision; }
+         virtual void set_precision(geometry_precision_t p);
+
       protected:
+         // Verify if the style only draws the compact edges in compact precision,
+         // in which case it does not need to keep the full-precision map.
+         virtual bool draws_only_compact_edges() const { return false; }
+
+         // Verify if the full-precision map was released in favor of the compact edges.
+         bool is_map_released() const;
+
+         // Retrieve the canonical edges of the map in compact precision.
+         const tiling::compact_edges_t& get_compact_edges();
+
+         // Record the duration and number of elements of a new generation.
+         void record_generation(std::chrono::steady_clock::time_point start, size_t item_count);
+
          double get_width_at(const point_t& pt, double width) const;
 
          void add_inflation_for_point(const point_t& pt, double inflation);
 
+         // Create a new unique map identity.
+         static uint64_t new_map_version();
+
          edges_map_t my_map;
+         uint64_t my_map_version = new_map_version();
+         uint64_t my_map_id = 0;
+         tiling::compact_edges_t my_compact_edges;
+         geometry_precision_t my_precision = geometry_precision_t::full;
 
          std::shared_ptr<const inflation_tiling_t> my_tiling;
          point_t my_tiling_center;
-         std::map<double, double> my_inflation_by_distances;
+         tiling::inflation_widths_t my_inflation_widths;
+
+         generation_stats_t my_generation_stats;
       };
    }
 }
@@ -30,6 +30,24 @@ namespace dak
          std::shared_ptr<tiling::mosaic_t> mosaic;
          std::shared_ptr<style_t> style;
 
+         // Timings and counts of the last construction and drawing of the layer.
+         // They are not copied with the layer.
+         //
+         // The generation time and memory are those of the last generation of
+         // the style, the generation is cached when the last drawing reused it.
+         struct stats_t
+         {
+            double construct_ms = 0.;
+            double generate_ms = 0.;
+            double draw_ms = 0.;
+            bool generate_cached = false;
+            size_t tiling_edge_count = 0;
+            size_t map_edge_count = 0;
+            size_t item_count = 0;
+            size_t memory_bytes = 0;
+         };
+         stats_t stats;
+
          // Create an empty mosaic layer.
          styled_mosaic_t() { }
 
@@ -43,6 +61,11 @@ namespace dak
          // Comparison.
          bool operator==(const layer_t& other) const;
 
+         // Estimated heap memory held by the mosaic and the style.
+         // Objects that were already counted are skipped.
+         size_t memory_usage() const;
+         size_t memory_usage(tiling::counted_objects_t& counted) const;
+
          // Update the style when the mosaic is modified.
          void update_style(const rectangle_t& region);
 
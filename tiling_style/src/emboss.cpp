@@ -46,6 +46,17 @@ namespace dak
       }
 
       void emboss_t::internal_draw_fat_lines(ui::drawing_t& drw, const fat_lines_t& fat_lines)
+      {
+         draw_embossed_fat_lines(drw, fat_lines);
+      }
+
+      void emboss_t::internal_draw_fat_lines(ui::drawing_t& drw, const compact_fat_lines_t& fat_lines)
+      {
+         draw_embossed_fat_lines(drw, fat_lines);
+      }
+
+      template <class FAT_LINES>
+      void emboss_t::draw_embossed_fat_lines(ui::drawing_t& drw, const FAT_LINES& fat_lines)
       {
          ui::color_t greys[17] =
          {
@@ -62,12 +73,15 @@ namespace dak
             greys[idx] = ui::color_t(ui::color_t::channel(color.r * t), ui::color_t::channel(color.g * t), ui::color_t::channel(color.b * t), 255);
          }
 
+         polygon_t hexagon;
+         polygon_t trap;
          const point_t light(std::cos(angle), std::sin(angle));
-         for (const auto& fat_line : fat_lines)
+         for (size_t line = 0; line < fat_lines.size(); ++line)
          {
-            const std::vector<point_t>& pts = fat_line.hexagon.points;
-            draw_trap(drw, pts[1], pts[2], pts[3], pts[4], light, greys);
-            draw_trap(drw, pts[4], pts[5], pts[0], pts[1], light, greys);
+            fat_lines.get_hexagon(line, hexagon);
+            const std::vector<point_t>& pts = hexagon.points;
+            draw_trap(drw, pts[1], pts[2], pts[3], pts[4], light, greys, trap);
+            draw_trap(drw, pts[4], pts[5], pts[0], pts[1], light, greys, trap);
          }
 
          if (utility::near_zero(outline_width))
@@ -75,15 +89,16 @@ namespace dak
 
          drw.set_stroke(ui::stroke_t(1.));
          drw.set_color(outline_color);
-         for (const auto& fat_line : fat_lines)
+         for (size_t line = 0; line < fat_lines.size(); ++line)
          {
-            drw.draw_polygon(fat_line.hexagon);
-            const std::vector<point_t>& pts = fat_line.hexagon.points;
+            fat_lines.get_hexagon(line, hexagon);
+            drw.draw_polygon(hexagon);
+            const std::vector<point_t>& pts = hexagon.points;
             drw.draw_line(pts[1], pts[4]);
          }
       }
 
-      void emboss_t::draw_trap(ui::drawing_t& drw, const point_t& a, const point_t& b, const point_t& c, const point_t& d, const point_t& light, const ui::color_t* greys)
+      void emboss_t::draw_trap(ui::drawing_t& drw, const point_t& a, const point_t& b, const point_t& c, const point_t& d, const point_t& light, const ui::color_t* greys, polygon_t& trap)
       {
          const point_t N = (a - d).perp().normalize();
 
@@ -95,13 +110,17 @@ namespace dak
          const int bb = (int) std::round(16. * dd);
          drw.set_color(greys[bb]);
 
-         const geometry::polygon_t poly({ a, b, c, d });
-         drw.fill_polygon(poly);
+         trap.points.resize(4);
+         trap.points[0] = a;
+         trap.points[1] = b;
+         trap.points[2] = c;
+         trap.points[3] = d;
+         drw.fill_polygon(trap);
       }
 
-      std::pair<point_t, point_t> emboss_t::get_points_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
+      tiling::junction_t emboss_t::get_junction_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
       {
-         return get_points_intersection(an_edge, index, width, width, connections);
+         return get_junction_intersection(an_edge, index, width, width, connections);
       }
    }
 }
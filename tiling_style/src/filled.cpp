@@ -1,5 +1,7 @@
 #include <dak/tiling_style/filled.h>
 
+#include <dak/tiling/trace.h>
+
 #include <dak/ui/drawing.h>
 
 #include <dak/utility/text.h>
@@ -41,28 +43,45 @@ namespace dak
          return false;
       }
 
+      size_t filled_t::memory_usage() const
+      {
+         return colored_t::memory_usage()
+              + tiling::memory_usage(my_cached_inside)
+              + tiling::memory_usage(my_cached_outside)
+              + tiling::memory_usage(my_cached_odd);
+      }
+
       std::wstring filled_t::describe() const
       {
          return L::t(L"Filled");
       }
 
-      void filled_t::set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t)
+      void filled_t::set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t, uint64_t map_id)
       {
-         my_cached_inside.clear();
-         my_cached_outside.clear();
-         my_cached_odd.clear();
-         colored_t::set_map(m, t);
+         colored_t::set_map(m, t, map_id);
+         if (my_cached_map_version != get_map_version())
+         {
+            my_cached_inside.clear();
+            my_cached_outside.clear();
+            my_cached_odd.clear();
+         }
       }
 
       // The internal draw is called with the layer transform already applied.
       void filled_t::internal_draw(ui::drawing_t& drw)
       {
-         if (my_cached_inside.empty())
+         DAK_TILING_TRACE("filled_t::internal_draw");
+
+         if (my_cached_inside.empty() || my_cached_map_version != get_map_version())
          {
+            my_cached_map_version = get_map_version();
+            my_cached_inside.clear();
             my_cached_outside.clear();
             my_cached_odd.clear();
             geometry::face_t::faces_t exteriors;
+            const auto start = std::chrono::steady_clock::now();
             geometry::face_t::make_faces(my_map, my_cached_inside, my_cached_outside, my_cached_odd, exteriors);
+            record_generation(start, my_cached_inside.size() + my_cached_outside.size());
          }
 
          drw.set_color(color);
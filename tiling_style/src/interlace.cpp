@@ -1,5 +1,8 @@
 #include <dak/tiling_style/interlace.h>
 
+#include <dak/tiling/over_under_weaving.h>
+#include <dak/tiling/trace.h>
+
 #include <dak/geometry/intersect.h>
 
 #include <dak/utility/text.h>
@@ -9,6 +12,7 @@
 #include <algorithm>
 #include <random>
 #include <cmath>
+#include <map>
 #include <set>
 
 namespace dak
@@ -48,97 +52,32 @@ namespace dak
          return false;
       }
 
-      std::wstring interlace_t::describe() const
+      size_t interlace_t::memory_usage() const
       {
-         return L::t(L"Interlaced");
+         return outline_t::memory_usage() + tiling::memory_usage(my_is_p1_over);
       }
 
-      void interlace_t::propagate_over_under_at_edge_p1(const edge_t& cur_edge, size_t index, over_under_context_t& ctx)
+      std::wstring interlace_t::describe() const
       {
-         const geometry::edges_map_t::range_t connections = my_map.outbounds(cur_edge.p1);
-         const size_t connection_count = connections.size();
-         const edge_t* conn_edges = &*(connections.begin());
-
-         const auto todo_iter = std::lower_bound(connections.begin(), connections.end(), cur_edge);
-         const size_t cur_index_in_conns = todo_iter - connections.begin();
-
-         const bool is_crossing_over = my_is_p1_over[index];
-
-         const bool is_not_a_crossing = (connection_count == 2);
-
-         // Propagate to its twin.
-         const bool twin_is_over = is_not_a_crossing ? is_crossing_over : !is_crossing_over;
-         const edge_t twin_edge = cur_edge.twin();
-         const auto twin_iter = std::lower_bound(ctx.edges.begin(), ctx.edges.end(), twin_edge);
-         const size_t twin_index = twin_iter - ctx.edges.begin();
-         if (!ctx.done_lines[twin_index])
-         {
-            my_is_p1_over[twin_index] = twin_is_over;
-            ctx.todos.push_back(twin_index);
-         }
-
-         // Propagate the over/under state to all outbound edges. We flip the state
-         // at each edge since the weaving makes consecutive edges have opposite
-         // over/under state.
-         bool next_is_over = is_not_a_crossing ? is_crossing_over : !is_crossing_over;
-         for (size_t offset = 1; offset < connection_count; ++offset)
-         {
-            const size_t next_index_in_conns = (cur_index_in_conns + offset) % connection_count;
-            const edge_t& next_edge = conn_edges[next_index_in_conns];
-            const auto next_iter = std::lower_bound(ctx.edges.begin(), ctx.edges.end(), next_edge);
-            const size_t next_index = next_iter - ctx.edges.begin();
-            if (!ctx.done_lines[next_index])
-            {
-               my_is_p1_over[next_index] = next_is_over;
-               ctx.todos.push_back(next_index);
-            }
-            next_is_over = !next_is_over;
-         }
+         return L::t(L"Interlaced");
       }
 
-      void interlace_t::propagate_over_under(over_under_context_t& ctx)
+      void interlace_t::propagate_over_under()
       {
-         // Propagate over/under weaving at the intersection of the given edge p1.
-
-         for (size_t i = 0; i < ctx.done_lines.size(); ++i)
-         {
-            if (ctx.done_lines[i])
-               continue;
-
-            // We start a new batch of edges, can happen because there are
-            // isolated islands of edges. The over/under state of the first
-            // edge is arbitraty; we start at false, because it's better if
-            // line-ends are under.
-            ctx.todos.push_back(i);
-
-            while (ctx.todos.size() > 0)
-            {
-               // Retrieve the new current edge to process and remove it from the stack.
-               size_t index_todo = ctx.todos.back();
-               ctx.todos.pop_back();
-
-               // If already processed, skip calculations, else mark it as processed.
-               if (ctx.done_lines[index_todo])
-                  continue;
-               else
-                  ctx.done_lines[index_todo] = true;
-
-               // Propagate at the p1 of the edge to all neighbour and its twin.
-               propagate_over_under_at_edge_p1(ctx.edges[index_todo], index_todo, ctx);
-            }
-         }
+         const tiling::over_under_weaving_t weaving(my_map);
+         weaving.weave(my_is_p1_over);
       }
 
-      interlace_t::fat_lines_t interlace_t::generate_fat_lines(bool all_edges)
+      fat_lines_t interlace_t::generate_fat_lines(bool all_edges)
       {
+         DAK_TILING_TRACE("interlace_t::generate_fat_lines");
+
          my_cached_shadow_width = shadow_width;
          my_cached_gap_width = gap_width;
 
          // Recalculate the over/under propagation.
-         over_under_context_t ctx({ my_map.all() });
-         ctx.done_lines.resize(ctx.edges.size(), false);
-         my_is_p1_over.resize(ctx.edges.size(), false);
-         propagate_over_under(ctx);
+         my_is_p1_over.resize(my_map.all().size(), false);
+         propagate_over_under();
 
          all_edges = true;
          fat_lines_t fat_lines = outline_t::generate_fat_lines(all_edges);
@@ -150,9 +89,16 @@ namespace dak
          return fat_lines;
       }
 
-      interlace_t::fat_lines_t interlace_t::combine_continuations(const interlace_t::fat_lines_t& fat_lines)
+      compact_fat_lines_t interlace_t::generate_compact_fat_lines(bool all_edges)
+      {
+         compact_fat_lines_t compact;
+         compact.assign(generate_fat_lines(all_edges));
+         return compact;
+      }
+
+      fat_lines_t interlace_t::combine_continuations(const fat_lines_t& fat_lines)
       {
-         interlace_t::fat_lines_t combined(fat_lines);
+         fat_lines_t combined(fat_lines);
 
          std::map<size_t, std::vector<size_t>> combined_with;
 
@@ -198,7 +144,8 @@ namespace dak
                // Combine the two edges contour.
 
                // Use the edge fat-line as the basis.
-               fat_line_t& fat_line = combined[edge_index];
+               point_t* pts = combined.points(edge_index);
+               const point_t* other_pts = combined.points(other_index);
 
                const size_t index_0 = is_first_over ? 0 : 3;
                const size_t index_1 = is_first_over ? 1 : 4;
@@ -206,18 +153,18 @@ namespace dak
 
                if (continuation_edge.is_canonical())
                {
-                  fat_line.hexagon.points[index_0] = combined[other_index].hexagon.points[3];
-                  fat_line.hexagon.points[index_1] = combined[other_index].hexagon.points[4];
-                  fat_line.hexagon.points[index_2] = combined[other_index].hexagon.points[5];
+                  pts[index_0] = other_pts[3];
+                  pts[index_1] = other_pts[4];
+                  pts[index_2] = other_pts[5];
                }
                else
                {
-                  fat_line.hexagon.points[index_0] = combined[other_index].hexagon.points[0];
-                  fat_line.hexagon.points[index_1] = combined[other_index].hexagon.points[1];
-                  fat_line.hexagon.points[index_2] = combined[other_index].hexagon.points[2];
+                  pts[index_0] = other_pts[0];
+                  pts[index_1] = other_pts[1];
+                  pts[index_2] = other_pts[2];
                }
 
-               combined[other_index] = fat_line;
+               combined.copy_line(other_index, edge_index);
 
                combined_with[edge_index].push_back(other_index);
                combined_with[other_index].push_back(edge_index);
@@ -226,7 +173,7 @@ namespace dak
                {
                   if (index != edge_index && index != other_index)
                   {
-                     combined[index] = fat_line;
+                     combined.copy_line(index, edge_index);
                      combined_with[other_index].push_back(index);
                   }
                }
@@ -235,7 +182,7 @@ namespace dak
                {
                   if (index != edge_index && index != other_index)
                   {
-                     combined[index] = fat_line;
+                     combined.copy_line(index, edge_index);
                      combined_with[edge_index].push_back(index);
                   }
                }
@@ -245,7 +192,7 @@ namespace dak
          // Reduce the size of combined to keep only canonical and only
          // one copy of each combined fsat line.
 
-         interlace_t::fat_lines_t reduced_combined;
+         fat_lines_t reduced_combined;
          reduced_combined.reserve(edges.size() / 2 + 1);
 
          for (size_t edge_index = 0; edge_index < edges.size(); ++edge_index)
@@ -270,36 +217,37 @@ namespace dak
                   continue;
             }
 
-            reduced_combined.push_back(combined[edge_index]);
+            reduced_combined.push_back(combined, edge_index);
          }
 
          return reduced_combined;
       }
 
 
-      interlace_t::fat_lines_t interlace_t::combine_fat_lines(const interlace_t::fat_lines_t& fat_lines)
+      fat_lines_t interlace_t::combine_fat_lines(const fat_lines_t& fat_lines)
       {
-         interlace_t::fat_lines_t combined;
+         fat_lines_t combined;
          combined.reserve(fat_lines.size());
 
          const auto& edges = my_map.all();
          for (size_t edge_index = 0; edge_index < edges.size(); ++edge_index)
          {
             const auto& edge = edges[edge_index];
-            combined.emplace_back(fat_lines[edge_index]);
+            combined.push_back(fat_lines, edge_index);
             if (!edge.is_canonical())
                continue;
 
             // Use the edge fat-line as the basis.
-            auto& fat_line = combined.back();
+            point_t* pts = combined.points(edge_index);
 
             // Add the twin contour for the other end.
             const auto twin = edge.twin();
             const size_t twin_index = std::lower_bound(edges.begin(), edges.end(), twin) - edges.begin();
 
-            fat_line.hexagon.points[3] = fat_lines[twin_index].hexagon.points[0];
-            fat_line.hexagon.points[4] = fat_lines[twin_index].hexagon.points[1];
-            fat_line.hexagon.points[5] = fat_lines[twin_index].hexagon.points[2];
+            const point_t* twin_pts = fat_lines.points(twin_index);
+            pts[3] = twin_pts[0];
+            pts[4] = twin_pts[1];
+            pts[5] = twin_pts[2];
 
             // Adjust mid-points to be properly placed.
             //
@@ -315,11 +263,11 @@ namespace dak
                const auto& intersecting_edge = my_map.before(twin);
                const size_t intersecting_edge_index = std::lower_bound(edges.begin(), edges.end(), intersecting_edge) - edges.begin();
                const auto intersecting_edge_outer_points = get_points_continuation(intersecting_edge.twin(), intersecting_edge_index, max_width, my_map.outbounds(edge.p1));
-               const double proj_on_line = intersecting_edge_outer_points.first.parameterization_on_line(fat_line.hexagon.points[0], fat_line.hexagon.points[2]);
+               const double proj_on_line = intersecting_edge_outer_points.first.parameterization_on_line(pts[0], pts[2]);
                if (utility::near_greater_or_equal(proj_on_line, 0.) && utility::near_less_or_equal(proj_on_line, 1.))
-                  fat_line.hexagon.points[1] = intersecting_edge_outer_points.first;
+                  pts[1] = intersecting_edge_outer_points.first;
                else
-                  fat_line.hexagon.points[1] = fat_line.hexagon.points[0].convex_sum(fat_line.hexagon.points[2], 0.5);
+                  pts[1] = pts[0].convex_sum(pts[2], 0.5);
             }
 
             if (!my_is_p1_over[twin_index] && my_map.outbounds(edge.p2).size() > 2)
@@ -327,24 +275,24 @@ namespace dak
                const auto& intersecting_edge = my_map.after(edge);
                const size_t intersecting_edge_index = std::lower_bound(edges.begin(), edges.end(), intersecting_edge) - edges.begin();
                const auto intersecting_edge_outer_points = get_points_continuation(intersecting_edge.twin(), intersecting_edge_index, max_width, my_map.outbounds(edge.p2));
-               const double proj_on_line = intersecting_edge_outer_points.second.parameterization_on_line(fat_line.hexagon.points[3], fat_line.hexagon.points[5]);
+               const double proj_on_line = intersecting_edge_outer_points.second.parameterization_on_line(pts[3], pts[5]);
                if (utility::near_greater_or_equal(proj_on_line, 0.) && utility::near_less_or_equal(proj_on_line, 1.))
-                  fat_line.hexagon.points[4] = intersecting_edge_outer_points.second;
+                  pts[4] = intersecting_edge_outer_points.second;
                else
-                  fat_line.hexagon.points[4] = fat_line.hexagon.points[3].convex_sum(fat_line.hexagon.points[5], 0.5);
+                  pts[4] = pts[3].convex_sum(pts[5], 0.5);
             }
          }
 
          return combined;
       }
 
-      std::pair<point_t, point_t> interlace_t::get_points_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
+      tiling::junction_t interlace_t::get_junction_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
       {
          if (my_is_p1_over[index])
-            return get_points_continuation(an_edge, index, width, connections);
+            return get_junction_continuation(an_edge, index, width, connections);
          else
             // TODO: sometimes this moves the line outside the normal path (outward widening when meeting a corner).
-            return get_points_intersection(an_edge, index, width, total_width(), connections);
+            return get_junction_intersection(an_edge, index, width, total_width(), connections);
       }
 
       void interlace_t::clear_cache()
@@ -56,7 +56,7 @@ namespace dak
          if (my_iter == my_filenames.end())
             return L"";
          else
-            return my_iter->filename();
+            return my_iter->filename().wstring();
       }
 
       known_mosaics_generator_t::layered_mosaic_t known_mosaics_generator_t::generate_current(const tiling::known_tilings_t& known_tilings, std::vector<std::wstring>& errors) const
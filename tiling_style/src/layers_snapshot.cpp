@@ -0,0 +1,78 @@
+#include <dak/tiling_style/layers_snapshot.h>
+#include <dak/tiling_style/styled_mosaic.h>
+
+#include <dak/tiling/content_hash.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace dak
+{
+   namespace tiling_style
+   {
+      using tiling::mosaic_t;
+      using tiling::content_hash_t;
+
+      namespace
+      {
+         // Hash of the identity of the tiling and figures of a mosaic.
+         uint64_t identity_hash(const mosaic_t& mosaic)
+         {
+            content_hash_t hash;
+            hash.add(uint64_t(reinterpret_cast<uintptr_t>(mosaic.tiling.get())));
+            hash.add(uint64_t(mosaic.tile_figures.size()));
+            for (const auto& tile_fig : mosaic.tile_figures)
+               hash.add(uint64_t(reinterpret_cast<uintptr_t>(tile_fig.second.get())));
+            return hash.value();
+         }
+      }
+
+      std::vector<std::shared_ptr<layer_t>> snapshot_layers(
+         const std::vector<std::shared_ptr<layer_t>>& layers,
+         const std::vector<std::shared_ptr<layer_t>>& previous_snapshot)
+      {
+         std::unordered_multimap<uint64_t, std::shared_ptr<mosaic_t>> previous_mosaics;
+         for (const auto& previous : previous_snapshot)
+            if (auto prev_mo_layer = std::dynamic_pointer_cast<styled_mosaic_t>(previous))
+               if (prev_mo_layer->mosaic)
+                  previous_mosaics.emplace(identity_hash(*prev_mo_layer->mosaic), prev_mo_layer->mosaic);
+
+         std::vector<std::shared_ptr<layer_t>> snapshot;
+         for (const auto& layer : layers)
+         {
+            auto mo_layer = std::dynamic_pointer_cast<styled_mosaic_t>(layer);
+            if (!mo_layer || !mo_layer->mosaic || !mo_layer->style)
+            {
+               snapshot.emplace_back(layer->clone());
+               continue;
+            }
+
+            auto snap_layer = std::make_shared<styled_mosaic_t>();
+            static_cast<layer_t&>(*snap_layer) = *mo_layer;
+
+            const auto range = previous_mosaics.equal_range(identity_hash(*mo_layer->mosaic));
+            for (auto pos = range.first; pos != range.second; ++pos)
+            {
+               if (pos->second->shares_figures(*mo_layer->mosaic))
+               {
+                  snap_layer->mosaic = pos->second;
+                  break;
+               }
+            }
+
+            // Note: the copy shares the figures.
+            if (!snap_layer->mosaic)
+               snap_layer->mosaic = std::make_shared<mosaic_t>(*mo_layer->mosaic);
+
+            snap_layer->style = std::dynamic_pointer_cast<style_t>(mo_layer->style->clone());
+            snap_layer->style->set_map(edges_map_t(), nullptr);
+
+            snapshot.emplace_back(snap_layer);
+         }
+
+         return snapshot;
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -0,0 +1,231 @@
+#include <dak/tiling_style/mosaic_disk_cache.h>
+#include <dak/tiling_style/mosaic_io.h>
+
+#include <dak/tiling/content_hash.h>
+#include <dak/tiling/vertex_keys.h>
+
+#include <algorithm>
+#include <cwchar>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling_style
+   {
+      using geometry::edge_t;
+      using geometry::point_t;
+      using tiling::content_hash_t;
+
+      namespace
+      {
+         // Bump the version whenever the file format or the construction changes.
+         const char cache_magic[8] = { 'A', 'L', 'H', 'M', 'A', 'P', '\0', '\0' };
+         const uint32_t cache_version = 2;
+
+         struct cache_header_t
+         {
+            char magic[8];
+            uint32_t version;
+            uint32_t reserved;
+            uint64_t key;
+            uint64_t edge_count;
+         };
+      }
+
+      mosaic_disk_cache_t::mosaic_disk_cache_t(const std::filesystem::path& folder, size_t max_entries)
+      : my_folder(folder), my_max_entries(max_entries)
+      {
+      }
+
+      uint64_t mosaic_disk_cache_t::make_key(const mosaic_t& mosaic, const rectangle_t& region)
+      {
+         std::wostringstream stream;
+         stream.precision(17);
+         stream.imbue(std::locale("C"));
+         write_mosaic(stream, mosaic);
+
+         // Note: the mosaic text only names the tiling, so the tiling
+         //       geometry is added to detect a tiling edited under the same name.
+         content_hash_t hash;
+         hash.add(uint64_t(cache_version));
+         hash.add(stream.str());
+         hash.add(mosaic.tiling ? mosaic.tiling->content_hash() : uint64_t(0));
+         hash.add(region.x).add(region.y).add(region.width).add(region.height);
+         return hash.value();
+      }
+
+      std::filesystem::path mosaic_disk_cache_t::file_path(uint64_t key) const
+      {
+         wchar_t name[32];
+         swprintf(name, sizeof(name) / sizeof(name[0]), L"%016llx.map", static_cast<unsigned long long>(key));
+         return my_folder / name;
+      }
+
+      edges_map_t mosaic_disk_cache_t::construct(const mosaic_t& mosaic, const rectangle_t& region)
+      {
+         if (mosaic.is_invalid())
+            return mosaic.construct(region);
+
+         const uint64_t key = make_key(mosaic, region);
+
+         edges_map_t map;
+         if (load(key, map))
+            return map;
+
+         map = mosaic.construct(region);
+         save(key, map);
+         return map;
+      }
+
+      bool mosaic_disk_cache_t::load(uint64_t key, edges_map_t& map) const
+      {
+         try
+         {
+            return load_file(key, map);
+         }
+         catch (const std::exception&)
+         {
+            // Treat a corrupted file like a missing one: the cache is only an optimization.
+            return false;
+         }
+      }
+
+      bool mosaic_disk_cache_t::load_file(uint64_t key, edges_map_t& map) const
+      {
+         const std::filesystem::path path = file_path(key);
+
+         std::error_code size_error;
+         const uintmax_t file_size = std::filesystem::file_size(path, size_error);
+         if (size_error || file_size < sizeof(cache_header_t))
+            return false;
+
+         std::ifstream file(path, std::ios::in | std::ios::binary);
+         if (!file)
+            return false;
+
+         cache_header_t header;
+         if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return false;
+
+         if (!std::equal(std::begin(cache_magic), std::end(cache_magic), header.magic))
+            return false;
+
+         if (header.version != cache_version || header.key != key)
+            return false;
+
+         // Verify the edge count against the file size before allocating anything.
+         const uintmax_t edge_bytes = 4 * sizeof(double);
+         if (header.edge_count != (file_size - sizeof(header)) / edge_bytes
+          || (file_size - sizeof(header)) % edge_bytes != 0)
+            return false;
+
+         std::vector<double> coords(header.edge_count * 4);
+         if (!file.read(reinterpret_cast<char*>(coords.data()), coords.size() * sizeof(double)))
+            return false;
+
+         // Note: the saved edges come from a fully merged map, so they never overlap.
+         std::vector<edge_t> edges;
+         edges.reserve(header.edge_count);
+         for (size_t i = 0; i < coords.size(); i += 4)
+            edges.emplace_back(point_t(coords[i], coords[i + 1]), point_t(coords[i + 2], coords[i + 3]));
+
+         map = tiling::make_map_from_unique_edges(edges);
+
+         // Mark the file as recently used so that trimming the cache keeps it.
+         std::error_code error;
+         std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+         return true;
+      }
+
+      void mosaic_disk_cache_t::save(uint64_t key, const edges_map_t& map)
+      {
+         std::vector<double> coords;
+         coords.reserve(map.all().size() * 2);
+         for (const auto& edge : map.all())
+         {
+            if (!edge.is_canonical())
+               continue;
+            coords.push_back(edge.p1.x);
+            coords.push_back(edge.p1.y);
+            coords.push_back(edge.p2.x);
+            coords.push_back(edge.p2.y);
+         }
+
+         cache_header_t header = {};
+         std::copy(std::begin(cache_magic), std::end(cache_magic), header.magic);
+         header.version = cache_version;
+         header.key = key;
+         header.edge_count = coords.size() / 4;
+
+         // Write to a temporary file first so that a partially written file
+         // never gets used.
+         const std::filesystem::path final_path = file_path(key);
+         std::filesystem::path temp_path = final_path;
+         temp_path += L".tmp";
+
+         try
+         {
+            std::filesystem::create_directories(my_folder);
+
+            bool written = false;
+            {
+               std::ofstream file(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+               file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+               file.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(double));
+               file.close();
+               written = !file.fail();
+            }
+
+            if (written)
+            {
+               std::filesystem::rename(temp_path, final_path);
+               trim();
+               return;
+            }
+         }
+         catch (const std::exception&)
+         {
+            // Ignore: the cache is only an optimization.
+         }
+
+         // Don't leave a partial file behind when the write or the rename failed.
+         std::error_code error;
+         std::filesystem::remove(temp_path, error);
+      }
+
+      void mosaic_disk_cache_t::trim()
+      {
+         std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+         for (const auto& entry : std::filesystem::directory_iterator(my_folder))
+            if (entry.path().extension() == L".map")
+               entries.emplace_back(entry.last_write_time(), entry.path());
+
+         if (entries.size() <= my_max_entries)
+            return;
+
+         std::sort(entries.begin(), entries.end());
+         const size_t remove_count = entries.size() - my_max_entries;
+         for (size_t i = 0; i < remove_count; ++i)
+            std::filesystem::remove(entries[i].second);
+      }
+
+      void mosaic_disk_cache_t::clear()
+      {
+         try
+         {
+            for (const auto& entry : std::filesystem::directory_iterator(my_folder))
+               if (entry.path().extension() == L".map")
+                  std::filesystem::remove(entry.path());
+         }
+         catch (const std::exception&)
+         {
+            // Ignore: folder does not exists.
+         }
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -21,7 +21,9 @@
 
 #include <dak/geometry/geometry_io.h>
 
+#include <algorithm>
 #include <iomanip>
+#include <stdexcept>
 #include <string>
 
 namespace dak
@@ -32,6 +34,7 @@ namespace dak
       using tiling::infer_mode_from_name;
       using tiling::mosaic_t;
       using geometry::transform_t;
+      using tiling::text_reader_t;
 
       namespace
       {
@@ -68,31 +71,35 @@ namespace dak
             return file;
          }
          
-         std::wistream& operator>>(std::wistream& file, stroke_t::join_style_t& join_style)
+         stroke_t::join_style_t read_join(text_reader_t& reader)
          {
-            std::wstring join_text;
-            file >> join_text;
+            const std::wstring_view join_text = reader.read_word();
 
             if (join_text == L"miter")
-               join_style = stroke_t::join_style_t::miter;
+               return stroke_t::join_style_t::miter;
             else if (join_text == L"bevel")
-               join_style = stroke_t::join_style_t::bevel;
+               return stroke_t::join_style_t::bevel;
             else
-               join_style = stroke_t::join_style_t::round;
+               return stroke_t::join_style_t::round;
+         }
 
-            return file;
+         ui::color_t read_color(text_reader_t& reader)
+         {
+            const int r = reader.read_int();
+            const int g = reader.read_int();
+            const int b = reader.read_int();
+            const int a = reader.read_int();
+            return ui::color_t(r, g, b, a);
          }
 
          ////////////////////////////////////////////////////////////////////////////
          //
          // Functions for reading and writing the styles.
 
-         void read_colored(std::wistream& file, colored_t& new_style)
+         void read_colored(text_reader_t& reader, colored_t& new_style)
          {
-            std::wstring dummy;
-            int r = 0, g = 0, b = 0, a = 0;
-            file >> dummy >> r >> g >> b >> a;
-            new_style.color = ui::color_t(r, g, b, a);
+            reader.read_word();
+            new_style.color = read_color(reader);
          }
 
          void write_colored(std::wostream& file, const colored_t& style)
@@ -101,11 +108,10 @@ namespace dak
             file << "  " << colored_name << " " << r << " " << g << " " << b << " " << a << L"\n";
          }
 
-         void read_plain(std::wistream& file, plain_t& new_style)
+         void read_plain(text_reader_t& reader, plain_t& new_style)
          {
-            std::wstring dummy;
-            file >> dummy;
-            read_colored(file, new_style);
+            reader.read_word();
+            read_colored(reader, new_style);
          }
 
          void write_plain(std::wostream& file, const plain_t& style)
@@ -114,12 +120,12 @@ namespace dak
             write_colored(file, style);
          }
 
-         void read_sketch(std::wistream& file, sketch_t& new_style)
+         void read_sketch(text_reader_t& reader, sketch_t& new_style)
          {
-            std::wstring dummy;
             // Note: in the text format, sketch derives from plain... so we read two sentinels.
-            file >> dummy >> dummy;
-            read_colored(file, new_style);
+            reader.read_word();
+            reader.read_word();
+            read_colored(reader, new_style);
          }
 
          void write_sketch(std::wostream& file, const sketch_t& style)
@@ -130,11 +136,12 @@ namespace dak
             write_colored(file, style);
          }
 
-         void read_filled(std::wistream& file, filled_t& new_style)
+         void read_filled(text_reader_t& reader, filled_t& new_style)
          {
-            std::wstring dummy;
-            file >> dummy >> std::boolalpha >> new_style.draw_inside >> std::boolalpha >> new_style.draw_outside;
-            read_colored(file, new_style);
+            reader.read_word();
+            new_style.draw_inside = reader.read_bool();
+            new_style.draw_outside = reader.read_bool();
+            read_colored(reader, new_style);
          }
 
          void write_filled(std::wostream& file, const filled_t& style)
@@ -143,19 +150,16 @@ namespace dak
             write_colored(file, style);
          }
 
-         void read_thick(std::wistream& file, thick_t& new_style, bool has_join, bool has_outline_color)
+         void read_thick(text_reader_t& reader, thick_t& new_style, bool has_join, bool has_outline_color)
          {
-            std::wstring dummy;
-            file >> dummy >> new_style.width >> new_style.outline_width;
+            reader.read_word();
+            new_style.width = reader.read_double();
+            new_style.outline_width = reader.read_double();
             if (has_join)
-               file >> new_style.join;
+               new_style.join = read_join(reader);
             if (has_outline_color)
-            {
-               int r = 0, g = 0, b = 0, a = 0;
-               file >> r >> g >> b >> a;
-               new_style.outline_color = ui::color_t(r, g, b, a);
-            }
-            read_colored(file, new_style);
+               new_style.outline_color = read_color(reader);
+            read_colored(reader, new_style);
          }
 
          void write_thick(std::wostream& file, const thick_t& style)
@@ -166,11 +170,10 @@ namespace dak
             write_colored(file, style);
          }
 
-         void read_outline(std::wistream& file, outline_t& new_style, bool has_join, bool has_outline_color)
+         void read_outline(text_reader_t& reader, outline_t& new_style, bool has_join, bool has_outline_color)
          {
-            std::wstring dummy;
-            file >> dummy;
-            read_thick(file, new_style, has_join, has_outline_color);
+            reader.read_word();
+            read_thick(reader, new_style, has_join, has_outline_color);
          }
 
          void write_outline(std::wostream& file, const outline_t& style)
@@ -179,11 +182,11 @@ namespace dak
             write_thick(file, style);
          }
 
-         void read_emboss(std::wistream& file, emboss_t& new_style, bool has_join, bool has_outline_color)
+         void read_emboss(text_reader_t& reader, emboss_t& new_style, bool has_join, bool has_outline_color)
          {
-            std::wstring dummy;
-            file >> dummy >> new_style.angle;
-            read_outline(file, new_style, has_join, has_outline_color);
+            reader.read_word();
+            new_style.angle = reader.read_double();
+            read_outline(reader, new_style, has_join, has_outline_color);
          }
 
          void write_emboss(std::wostream& file, const emboss_t& style)
@@ -192,12 +195,13 @@ namespace dak
             write_outline(file, style);
          }
 
-         void read_interlace(std::wistream& file, interlace_t& new_style, bool has_join, bool has_outline_color)
+         void read_interlace(text_reader_t& reader, interlace_t& new_style, bool has_join, bool has_outline_color)
          {
-            std::wstring dummy;
-            file >> dummy >> new_style.gap_width >> new_style.shadow_width;
+            reader.read_word();
+            new_style.gap_width = reader.read_double();
+            new_style.shadow_width = reader.read_double();
             // In the text format, interlace derives from thick, not outline.
-            read_thick(file, new_style, has_join, has_outline_color);
+            read_thick(reader, new_style, has_join, has_outline_color);
          }
 
          void write_interlace(std::wostream& file, const interlace_t& style)
@@ -224,17 +228,19 @@ namespace dak
             else if (const auto plain = dynamic_cast<const tiling_style::plain_t *>(&a_style))
                write_plain(file, *plain);
             else
-               throw std::exception(L::t("Unknown style type."));
+               throw std::runtime_error(L::t("Unknown style type."));
          }
 
          ////////////////////////////////////////////////////////////////////////////
          //
          // Functions for reading and writing figures.
 
-         void read_star(std::wistream& file, tiling::star_t& new_star)
+         void read_star(text_reader_t& reader, tiling::star_t& new_star)
          {
-            std::wstring dummy;
-            file >> dummy >> new_star.n >> new_star.d >> new_star.s;
+            reader.read_word();
+            new_star.n = reader.read_int();
+            new_star.d = reader.read_double();
+            new_star.s = reader.read_int();
          }
 
          void write_star(std::wostream& file, const tiling::star_t& star)
@@ -242,10 +248,12 @@ namespace dak
             file << L"    star " << star.n << " " << star.d << " " << star.s << L"\n";
          }
 
-         void read_rosette(std::wistream& file, tiling::rosette_t& new_rosette)
+         void read_rosette(text_reader_t& reader, tiling::rosette_t& new_rosette)
          {
-            std::wstring dummy;
-            file >> dummy >> new_rosette.n >> new_rosette.q >> new_rosette.s;
+            reader.read_word();
+            new_rosette.n = reader.read_int();
+            new_rosette.q = reader.read_double();
+            new_rosette.s = reader.read_int();
          }
 
          void write_rosette(std::wostream& file, const tiling::rosette_t& rosette)
@@ -253,17 +261,18 @@ namespace dak
             file << L"    rosette " << rosette.n << " " << rosette.q << " " << rosette.s << L"\n";
          }
 
-         void read_explicit_figure(std::wistream& file, tiling::irregular_figure_t&)
+         void read_explicit_figure(text_reader_t& reader, tiling::irregular_figure_t&)
          {
-            std::wstring dummy;
-            file >> dummy;
+            reader.read_word();
          }
 
-         void read_irregular_figure(std::wistream& file, tiling::irregular_figure_t& new_irregular)
+         void read_irregular_figure(text_reader_t& reader, tiling::irregular_figure_t& new_irregular)
          {
-            std::wstring dummy;
-            std::wstring infer;
-            file >> dummy >> std::quoted(infer) >> new_irregular.q >> new_irregular.d >> new_irregular.s;
+            reader.read_word();
+            const std::wstring infer = reader.read_quoted();
+            new_irregular.q = reader.read_double();
+            new_irregular.d = reader.read_double();
+            new_irregular.s = reader.read_int();
             new_irregular.infer = infer_mode_from_name(infer.c_str());
          }
 
@@ -272,12 +281,14 @@ namespace dak
             file << L"    irregular " << std::quoted(infer_mode_name(irregular.infer)) << " " << irregular.q << " " << irregular.d << " " << irregular.s << L"\n";
          }
 
-         void read_extended_figure(std::wistream& file, tiling::extended_figure_t& new_extended_figure)
+         void read_extended_figure(text_reader_t& reader, tiling::extended_figure_t& new_extended_figure)
          {
-            std::wstring dummy;
-            double dummy_s;
             tiling::rosette_t rosette;
-            file >> dummy >> dummy_s >> rosette.n >> rosette.q >> rosette.s;
+            reader.read_word();
+            reader.read_double();
+            rosette.n = reader.read_int();
+            rosette.q = reader.read_double();
+            rosette.s = reader.read_int();
             // Note: for some reason, the mosaic saved from the old Taprats have bad Q and S values...
             if (rosette.q > 1.)
                rosette.q = 0.33;
@@ -300,28 +311,24 @@ namespace dak
             }
          }
 
-         std::shared_ptr<mosaic_t> read_mosaic(std::wistream& file, const known_tilings_t& known_tilings)
+         std::shared_ptr<mosaic_t> read_mosaic(text_reader_t& reader, const known_tilings_t& known_tilings)
          {
             auto new_mosaic = std::make_shared<mosaic_t>();
 
-            std::wstring dummy;
-            std::wstring tiling_name;
-            int figure_count = 0;
-            file >> dummy >> std::quoted(tiling_name) >> figure_count;
+            reader.read_word();
+            const std::wstring tiling_name = reader.read_quoted();
+            const int figure_count = reader.read_int();
 
             new_mosaic->tiling = tiling::find_tiling(known_tilings, tiling_name);
             if (!new_mosaic->tiling)
-               throw std::exception(
+               throw std::runtime_error(
                   utility::narrow_text(
                      utility::format(L::t(L"Unknown tiling %s."), tiling_name.c_str())).c_str());
 
             for (int i = 0; i < figure_count; ++i)
             {
-               std::wstring tile_type;
-               int side_count = 0;
-               file >> tile_type >> side_count;
-
-               bool reg = (tile_type == L"regular");
+               const bool reg = (reader.read_word() == L"regular");
+               const int side_count = reader.read_int();
 
                polygon_t poly;
                if (reg)
@@ -330,49 +337,43 @@ namespace dak
                }
                else
                {
+                  poly.points.reserve(std::max(side_count, 0));
                   for (int si = 0; si < side_count; ++si)
-                  {
-                     point_t pt;
-                     file >> pt.x >> pt.y;
-                     poly.points.emplace_back(pt);
-                  }
+                     poly.points.emplace_back(reader.read_point());
                }
                std::shared_ptr<tiling::figure_t>& fig = new_mosaic->tile_figures[poly];
 
-               std::wstring figure_type;
-               const auto pos = file.tellg();
-               file >> figure_type;
-               file.seekg(pos);
+               const std::wstring_view figure_type = reader.peek_word();
 
                if (figure_type == L"star")
                {
                   std::shared_ptr<tiling::star_t> new_star(new tiling::star_t);
-                  read_star(file, *new_star);
+                  read_star(reader, *new_star);
                   fig = new_star;
                }
                else if (figure_type == L"rosette")
                {
                   std::shared_ptr<tiling::rosette_t> new_rosette(new tiling::rosette_t);
-                  read_rosette(file, *new_rosette);
+                  read_rosette(reader, *new_rosette);
                   fig = new_rosette;
                }
                else if (figure_type == L"explicit")
                {
                   std::shared_ptr<tiling::irregular_figure_t> new_irregular_figure(new tiling::irregular_figure_t(new_mosaic, poly));
-                  read_explicit_figure(file, *new_irregular_figure);
+                  read_explicit_figure(reader, *new_irregular_figure);
                   fig = new_irregular_figure;
                }
                else if (figure_type == L"irregular")
                {
                   std::shared_ptr<tiling::irregular_figure_t> new_irregular_figure(new tiling::irregular_figure_t(new_mosaic, poly));
-                  read_irregular_figure(file, *new_irregular_figure);
+                  read_irregular_figure(reader, *new_irregular_figure);
                   fig = new_irregular_figure;
                }
                else if (figure_type == L"extended")
                {
                   std::shared_ptr<tiling::radial_figure_t> child_rosette = std::make_shared<tiling::rosette_t>(6, 2, 2);
                   std::shared_ptr<tiling::extended_figure_t> new_extended_figure(new tiling::extended_figure_t(child_rosette));
-                  read_extended_figure(file, *new_extended_figure);
+                  read_extended_figure(reader, *new_extended_figure);
                   fig = new_extended_figure;
                }
             }
@@ -391,47 +392,48 @@ namespace dak
             else if (const auto irregular_figure = dynamic_cast<const tiling::irregular_figure_t*>(&fig))
                write_irregular_figure(file, *irregular_figure);
             else
-               throw std::exception(L::t("Unknown figure type."));
+               throw std::runtime_error(L::t("Unknown figure type."));
          }
 
-         void write_mosaic(std::wostream& file, const mosaic_t& mosaic)
+         transform_t read_transform(text_reader_t& reader)
          {
-            file << L"  mosaic " << std::quoted(mosaic.tiling->name) << " " << mosaic.tile_figures.size() << L"\n";
-
-            for (const auto& poly_figure : mosaic.tile_figures)
-            {
-               const polygon_t& poly = poly_figure.first;
-               const auto& fig = poly_figure.second;
-
-               if (poly.is_regular())
-               {
-                  file << L"    regular " << poly.points.size() << L"\n";
-               }
-               else
-               {
-                  file << L"    polygon " << poly.points.size() << L"\n";
-                  for (const auto& pt : poly.points)
-                  {
-                     file << "      " << pt.x << " " << pt.y << L"\n";
-                  }
-               }
-
-               write_figure(file, *fig);
-            }
+            reader.read_word();
+            return reader.read_transform();
          }
 
-
-         transform_t read_transform(std::wistream& file)
+         void write_transform(std::wostream& file, const transform_t& trf)
          {
-            transform_t trf;
-            std::wstring dummy;
-            file >> dummy >> trf;
-            return trf;
+            file << L"  position " << trf << L"\n";
          }
+      }
 
-         void write_transform(std::wostream& file, const transform_t& trf)
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Function for writing a single mosaic.
+
+      void write_mosaic(std::wostream& file, const mosaic_t& mosaic)
+      {
+         file << L"  mosaic " << std::quoted(mosaic.tiling->name) << " " << mosaic.tile_figures.size() << L"\n";
+
+         for (const auto& poly_figure : mosaic.tile_figures)
          {
-            file << L"  position " << trf << L"\n";
+            const polygon_t& poly = poly_figure.first;
+            const auto& fig = poly_figure.second;
+
+            if (poly.is_regular())
+            {
+               file << L"    regular " << poly.points.size() << L"\n";
+            }
+            else
+            {
+               file << L"    polygon " << poly.points.size() << L"\n";
+               for (const auto& pt : poly.points)
+               {
+                  file << "      " << pt.x << " " << pt.y << L"\n";
+               }
+            }
+
+            write_figure(file, *fig);
          }
       }
 
@@ -443,11 +445,16 @@ namespace dak
       {
          file.imbue(std::locale("C"));
 
+         text_reader_t reader(file);
+         return read_layered_mosaic(reader, known_tilings);
+      }
+
+      std::vector<std::shared_ptr<styled_mosaic_t>> read_layered_mosaic(text_reader_t& reader, const known_tilings_t& known_tilings)
+      {
          std::vector<std::shared_ptr<styled_mosaic_t>> new_layers;
 
-         std::wstring sentry;
-         size_t count = 0;
-         file >> sentry >> count;
+         const std::wstring_view sentry = reader.read_word();
+         const size_t count = reader.read_size();
 
          const bool is_colored = (sentry == colored_movable_join_layer_sentry);
          const bool is_movable_join = (sentry == movable_join_layer_sentry || sentry == colored_movable_join_layer_sentry);
@@ -455,64 +462,61 @@ namespace dak
 
          for (size_t i = 0; i < count; ++i)
          {
-            std::wstring style_type;
-            const auto pos = file.tellg();
-            file >> style_type;
-            file.seekg(pos);
+            const std::wstring_view style_type = reader.peek_word();
 
             std::shared_ptr<styled_mosaic_t> new_mosaic_layer(new styled_mosaic_t);
             if (style_type == emboss_name)
             {
                std::shared_ptr<emboss_t> new_emboss(new emboss_t);
-               read_emboss(file, *new_emboss, is_movable_join, is_colored);
+               read_emboss(reader, *new_emboss, is_movable_join, is_colored);
                new_mosaic_layer->style = new_emboss;
             }
             else if (style_type == filled_name)
             {
                std::shared_ptr<filled_t> new_filled(new filled_t);
-               read_filled(file, *new_filled);
+               read_filled(reader, *new_filled);
                new_mosaic_layer->style = new_filled;
             }
             else if (style_type == interlace_name)
             {
                std::shared_ptr<interlace_t> new_interlace(new interlace_t);
-               read_interlace(file, *new_interlace, is_movable_join, is_colored);
+               read_interlace(reader, *new_interlace, is_movable_join, is_colored);
                new_mosaic_layer->style = new_interlace;
             }
             else if (style_type == outline_name)
             {
                std::shared_ptr<outline_t> new_outline(new outline_t);
-               read_outline(file, *new_outline, is_movable_join, is_colored);
+               read_outline(reader, *new_outline, is_movable_join, is_colored);
                new_mosaic_layer->style = new_outline;
             }
             else if (style_type == plain_name)
             {
                std::shared_ptr<plain_t> new_plain(new plain_t);
-               read_plain(file, *new_plain);
+               read_plain(reader, *new_plain);
                new_mosaic_layer->style = new_plain;
             }
             else if (style_type == sketch_name)
             {
                std::shared_ptr<sketch_t> new_sketch(new sketch_t);
-               read_sketch(file, *new_sketch);
+               read_sketch(reader, *new_sketch);
                new_mosaic_layer->style = new_sketch;
             }
             else if (style_type == thick_name)
             {
                std::shared_ptr<thick_t> new_thick(new thick_t);
-               read_thick(file, *new_thick, is_movable_join, is_colored);
+               read_thick(reader, *new_thick, is_movable_join, is_colored);
                new_mosaic_layer->style = new_thick;
             }
             else
             {
-               throw std::exception(L::t("Unknown style type."));
+               throw std::runtime_error(L::t("Unknown style type."));
             }
 
             // TODO: shared identical mosaic between layers? That would speed-up map updates.
-            new_mosaic_layer->mosaic = read_mosaic(file, known_tilings);
+            new_mosaic_layer->mosaic = read_mosaic(reader, known_tilings);
 
             if (is_movable)
-               new_mosaic_layer->set_transform(read_transform(file));
+               new_mosaic_layer->set_transform(read_transform(reader));
 
             new_layers.emplace_back(new_mosaic_layer);
          }
@@ -0,0 +1,105 @@
+#include <dak/tiling_style/mosaic_memory_cache.h>
+
+#include <dak/tiling/content_hash.h>
+
+#include <atomic>
+
+namespace dak
+{
+   namespace tiling_style
+   {
+      using geometry::edge_t;
+      using tiling::content_hash_t;
+
+      namespace
+      {
+         bool same_region(const rectangle_t& a, const rectangle_t& b)
+         {
+            return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+         }
+
+         // Note: the tilings are compared by content, since copies of a mosaic
+         //       can refer to identical tilings read or edited separately.
+         bool same_mosaic(const mosaic_t& a, const mosaic_t& b)
+         {
+            if (a.tiling != b.tiling)
+               if (!a.tiling || !b.tiling || !(*a.tiling == *b.tiling))
+                  return false;
+
+            return a.same_figures(b);
+         }
+
+         // Note: the ids are unique across caches since styles only keep the id.
+         uint64_t new_map_id()
+         {
+            static std::atomic<uint64_t> last_id = 0;
+            return ++last_id;
+         }
+      }
+
+      mosaic_memory_cache_t::mosaic_memory_cache_t(size_t max_bytes)
+      : my_max_bytes(max_bytes)
+      {
+      }
+
+      mosaic_memory_cache_t::cached_map_t mosaic_memory_cache_t::construct(const mosaic_t& mosaic, const transform_t& trf, const rectangle_t& region, const constructor_t& constructor)
+      {
+         const uint64_t key = make_key(mosaic, trf, region);
+
+         const auto pos = my_entries_by_key.find(key);
+         if (pos != my_entries_by_key.end())
+         {
+            const auto entry = pos->second;
+            if (entry->trf == trf && same_region(entry->region, region) && same_mosaic(entry->mosaic, mosaic))
+            {
+               my_entries.splice(my_entries.begin(), my_entries, entry);
+               return { entry->map, entry->map_id };
+            }
+
+            // Note: hash collision, the new map replaces the old one.
+            my_bytes -= entry->bytes;
+            my_entries.erase(entry);
+            my_entries_by_key.erase(pos);
+         }
+
+         edges_map_t map = constructor();
+         const size_t bytes = sizeof(edges_map_t) + map.all().size() * sizeof(edge_t);
+         my_entries.push_front(entry_t{ key, mosaic, trf, region, std::move(map), new_map_id(), bytes });
+         my_entries_by_key[key] = my_entries.begin();
+         my_bytes += bytes;
+
+         trim();
+
+         return { my_entries.front().map, my_entries.front().map_id };
+      }
+
+      uint64_t mosaic_memory_cache_t::make_key(const mosaic_t& mosaic, const transform_t& trf, const rectangle_t& region) const
+      {
+         content_hash_t hash;
+         hash.add(mosaic.content_hash()).add(trf);
+         hash.add(region.x).add(region.y).add(region.width).add(region.height);
+         return hash.value();
+      }
+
+      void mosaic_memory_cache_t::trim()
+      {
+         // Note: always keep the most recent map, even if it is larger than the maximum.
+         while (my_bytes > my_max_bytes && my_entries.size() > 1)
+         {
+            const entry_t& oldest = my_entries.back();
+            my_bytes -= oldest.bytes;
+            my_entries_by_key.erase(oldest.key);
+            my_entries.pop_back();
+         }
+      }
+
+      void mosaic_memory_cache_t::clear()
+      {
+         my_entries.clear();
+         my_entries_by_key.clear();
+         my_bytes = 0;
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -1,5 +1,9 @@
 #include <dak/tiling_style/outline.h>
 
+#include <dak/tiling/miter_joins.h>
+#include <dak/tiling/parallel.h>
+#include <dak/tiling/trace.h>
+
 #include <dak/geometry/utility.h>
 
 #include <dak/utility/text.h>
@@ -7,6 +11,7 @@
 #include <dak/ui/drawing.h>
 
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
 
 namespace dak
@@ -20,48 +25,95 @@ namespace dak
       using geometry::is_colinear;
       using utility::L;
 
+      namespace
+      {
+         // Minimum number of fat lines generated by each thread.
+         const size_t min_fat_lines_per_thread = 1024;
+      }
+
       std::shared_ptr<layer_t> outline_t::clone() const
       {
          return std::make_shared<outline_t>(*this);
       }
 
+      size_t outline_t::memory_usage() const
+      {
+         return thick_t::memory_usage()
+              + my_cached_fat_lines.memory_usage()
+              + my_cached_compact_fat_lines.memory_usage();
+      }
+
       std::wstring outline_t::describe() const
       {
          return L::t(L"Outlined");
       }
 
-      void outline_t::set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t)
+      void outline_t::set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t, uint64_t map_id)
       {
-         clear_cache();
-         thick_t::set_map(m, t);
+         thick_t::set_map(m, t, map_id);
+         if (my_cached_map_version != get_map_version())
+            clear_cache();
+      }
+
+      void outline_t::set_precision(geometry_precision_t p)
+      {
+         if (p != get_precision())
+            clear_cache();
+         thick_t::set_precision(p);
       }
 
       void outline_t::internal_draw(ui::drawing_t& drw)
       {
          if (is_cache_invalid())
          {
+            my_cached_map_version = get_map_version();
             my_cached_width = width;
             my_cached_outline_width  = outline_width;
-            my_cached_fat_lines = generate_fat_lines(false);
+            my_cached_precision = get_precision();
+            const auto start = std::chrono::steady_clock::now();
+            if (my_cached_precision == geometry_precision_t::compact)
+               my_cached_compact_fat_lines = generate_compact_fat_lines(false);
+            else
+               my_cached_fat_lines = generate_fat_lines(false);
+            record_generation(start, my_cached_fat_lines.size() + my_cached_compact_fat_lines.size());
          }
-         internal_draw_fat_lines(drw, my_cached_fat_lines);
+
+         if (my_cached_precision == geometry_precision_t::compact)
+            internal_draw_fat_lines(drw, my_cached_compact_fat_lines);
+         else
+            internal_draw_fat_lines(drw, my_cached_fat_lines);
       }
 
       void outline_t::clear_cache()
       {
          my_cached_fat_lines.clear();
+         my_cached_compact_fat_lines.clear();
+         my_cached_map_version = 0;
          my_cached_width = NAN;
          my_cached_outline_width = NAN;
       }
 
       bool outline_t::is_cache_invalid() const
       {
-         return my_cached_fat_lines.size() <= 0
+         return (my_cached_fat_lines.size() <= 0 && my_cached_compact_fat_lines.size() <= 0)
+            || my_cached_map_version != get_map_version()
+            || my_cached_precision != get_precision()
             || my_cached_width != width
             || my_cached_outline_width != outline_width;
       }
 
       void outline_t::internal_draw_fat_lines(ui::drawing_t& drw, const fat_lines_t& fat_lines)
+      {
+         draw_outlined_fat_lines(drw, fat_lines);
+      }
+
+      void outline_t::internal_draw_fat_lines(ui::drawing_t& drw, const compact_fat_lines_t& fat_lines)
+      {
+         draw_outlined_fat_lines(drw, fat_lines);
+      }
+
+      template <class FAT_LINES>
+      void outline_t::draw_outlined_fat_lines(ui::drawing_t& drw, const FAT_LINES& fat_lines)
       {
          //#define DAK_TILING_STYLE_OUTLINE_RANDOM_COLOR
 
@@ -71,8 +123,11 @@ namespace dak
 
          const ui::stroke_t outline_stroke = get_stroke(drw, outline_width);
 
-         for (const auto& fat_line : fat_lines)
+         polygon_t hexagon;
+         for (size_t line = 0; line < fat_lines.size(); ++line)
          {
+            fat_lines.get_hexagon(line, hexagon);
+
             #ifdef DAK_TILING_STYLE_OUTLINE_RANDOM_COLOR
                auto c = rnd_color.any();
                c.a = 120;
@@ -80,7 +135,7 @@ namespace dak
             #else
                drw.set_color(color);
             #endif
-            drw.fill_polygon(fat_line.hexagon);
+            drw.fill_polygon(hexagon);
 
             if (utility::near_zero(outline_stroke.width))
                continue;
@@ -88,53 +143,102 @@ namespace dak
             drw.set_stroke(outline_stroke);
             drw.set_color(outline_color);
 
-            const auto& pts = fat_line.hexagon.points;
+            const auto& pts = hexagon.points;
             drw.draw_line(pts[2], pts[3]);
             drw.draw_line(pts[5], pts[0]);
 
-            if (fat_line.p1_is_line_end)
+            if (fat_lines.is_p1_line_end(line))
                drw.draw_line(pts[0], pts[2]);
 
-            if (fat_line.p2_is_line_end)
+            if (fat_lines.is_p2_line_end(line))
                drw.draw_line(pts[3], pts[5]);
          }
       }
 
-      outline_t::fat_lines_t outline_t::generate_fat_lines(bool all_edges)
+      fat_lines_t outline_t::generate_fat_lines(bool all_edges)
       {
-         fat_lines_t fat_lines;
-         fat_lines.reserve(my_map.all().size() / (all_edges ? 1 : 2));
+         DAK_TILING_TRACE("outline_t::generate_fat_lines");
 
-         const edge_t* const first_edge = &*(my_map.all().begin());
+         fat_lines_t fat_lines;
+         fill_fat_lines(all_edges, fat_lines);
+         return fat_lines;
+      }
 
-         for (const auto& edge : my_map.all())
-         {
-            if (!all_edges && !edge.is_canonical())
-               continue;
-            const size_t edge_index = &edge - first_edge;
-            fat_lines.emplace_back(generate_fat_line(edge, edge_index, width));
-         }
+      compact_fat_lines_t outline_t::generate_compact_fat_lines(bool all_edges)
+      {
+         DAK_TILING_TRACE("outline_t::generate_compact_fat_lines");
 
+         compact_fat_lines_t fat_lines;
+         fill_fat_lines(all_edges, fat_lines);
          return fat_lines;
       }
 
-      outline_t::fat_line_t outline_t::generate_fat_line(const edge_t& edge, const size_t edge_index, double width)
+      template <class FAT_LINES>
+      void outline_t::fill_fat_lines(bool all_edges, FAT_LINES& fat_lines)
       {
-         fat_line_t fat_line;
+         typedef typename FAT_LINES::point_type point_type;
 
-         const auto tops = get_points(edge,        edge_index, width, fat_line.p2_is_line_end);
-         const auto bots = get_points(edge.twin(), edge_index, width, fat_line.p1_is_line_end);
+         const auto& edges = my_map.all();
 
-         fat_line.hexagon = polygon_t({ bots.first, edge.p1, bots.second,
-                                        tops.first, edge.p2, tops.second, });
+         // The index of the edge of each fat line.
+         std::vector<size_t> line_edges;
+         line_edges.reserve(edges.size() / (all_edges ? 1 : 2));
+         for (size_t edge_index = 0; edge_index < edges.size(); ++edge_index)
+            if (all_edges || edges[edge_index].is_canonical())
+               line_edges.emplace_back(edge_index);
 
-         return fat_line;
+         fat_lines.clear();
+         fat_lines.resize(line_edges.size());
+
+         // The junctions at the p2 end of each fat line, followed by the one at its p1 end.
+         tiling::junctions_t junctions;
+         junctions.resize(line_edges.size() * 2);
+
+         // Note: the line-end flags are kept in bitsets, which cannot be written
+         //       concurrently, so they are gathered per line and set afterward.
+         std::vector<uint8_t> line_ends(line_edges.size(), 0);
+
+         tiling::parallel_for(line_edges.size(), min_fat_lines_per_thread, [self=this, &edges, &line_edges, &fat_lines, &junctions, &line_ends](size_t begin, size_t end)
+         {
+            // First gather the junctions, which needs to look up the map.
+            for (size_t line = begin; line < end; ++line)
+            {
+               const size_t edge_index = line_edges[line];
+               const edge_t& edge = edges[edge_index];
+               bool p1_is_line_end = false;
+               bool p2_is_line_end = false;
+               junctions.set(line * 2,     self->get_junction(edge,        edge_index, self->width, p2_is_line_end));
+               junctions.set(line * 2 + 1, self->get_junction(edge.twin(), edge_index, self->width, p1_is_line_end));
+               line_ends[line] = (p1_is_line_end ? 1 : 0) | (p2_is_line_end ? 2 : 0);
+            }
+
+            // Then compute all the joins at once.
+            junctions.compute(begin * 2, end * 2);
+
+            for (size_t line = begin; line < end; ++line)
+            {
+               const edge_t& edge = edges[line_edges[line]];
+               point_type* hexagon = fat_lines.points(line);
+               hexagon[0] = point_type(junctions.get_below(line * 2 + 1));
+               hexagon[1] = point_type(edge.p1);
+               hexagon[2] = point_type(junctions.get_above(line * 2 + 1));
+               hexagon[3] = point_type(junctions.get_below(line * 2));
+               hexagon[4] = point_type(edge.p2);
+               hexagon[5] = point_type(junctions.get_above(line * 2));
+            }
+         });
+
+         for (size_t line = 0; line < line_ends.size(); ++line)
+         {
+            fat_lines.set_p1_line_end(line, (line_ends[line] & 1) != 0);
+            fat_lines.set_p2_line_end(line, (line_ends[line] & 2) != 0);
+         }
       }
 
       // Look at a given edge and construct a plausible set of points
       // to draw at the edge's 'p2' point.  Call this twice to get the
       // complete outline of the hexagon to draw for this edge.
-      std::pair<point_t, point_t> outline_t::get_points(const edge_t& an_edge, size_t index, double width, bool& is_line_end)
+      tiling::junction_t outline_t::get_junction(const edge_t& an_edge, size_t index, double width, bool& is_line_end)
       {
          const geometry::edges_map_t::range_t connections = my_map.outbounds(an_edge.p2);
          const size_t connection_count = connections.size();
@@ -142,47 +246,50 @@ namespace dak
          if (connection_count == 1)
          {
             is_line_end = true;
-            return get_points_one_connection(an_edge, index, width, connections);
+            return get_junction_one_connection(an_edge, index, width, connections);
          }
          else
          {
             if (connection_count == 2)
             {
-               return get_points_two_connections(an_edge, index, width, connections);
+               return get_junction_two_connections(an_edge, index, width, connections);
             }
             else
             {
-               return get_points_many_connections(an_edge, index, width, connections);
+               return get_junction_many_connections(an_edge, index, width, connections);
             }
 
          }
       }
 
-      std::pair<point_t, point_t> outline_t::get_points_one_connection(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t&)
+      tiling::junction_t outline_t::get_junction_one_connection(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t&)
       {
-         return get_points_dead_end(an_edge, index, width);
+         return get_junction_dead_end(an_edge, index, width);
       }
 
-      std::pair<point_t, point_t> outline_t::get_points_two_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
+      tiling::junction_t outline_t::get_junction_two_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
       {
-         return get_points_continuation(an_edge, index, width, connections);
+         return get_junction_continuation(an_edge, index, width, connections);
       }
 
-      std::pair<point_t, point_t> outline_t::get_points_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
+      tiling::junction_t outline_t::get_junction_many_connections(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
       {
-         return get_points_intersection(an_edge, index, width, width, connections);
+         return get_junction_intersection(an_edge, index, width, width, connections);
       }
 
-      std::pair<point_t, point_t> outline_t::get_points_dead_end(const edge_t& an_edge, size_t index, double width)
+      tiling::junction_t outline_t::get_junction_dead_end(const edge_t& an_edge, size_t index, double width)
       {
-         const point_t dir = (an_edge.p2 - an_edge.p1).normalize();
-         const point_t perp = dir.perp();
-         const point_t below = an_edge.p2 - perp.scale(get_width_at(an_edge.p2, width));
-         const point_t above = an_edge.p2 + perp.scale(get_width_at(an_edge.p2, width));
-         return std::pair<point_t, point_t>(below, above);
+         tiling::junction_t junction;
+         junction.kind = tiling::junction_kind_t::dead_end;
+         junction.p1 = an_edge.p1;
+         junction.joint = an_edge.p2;
+         junction.below = an_edge.p1;
+         junction.above = an_edge.p1;
+         junction.width = get_width_at(an_edge.p2, width);
+         return junction;
       }
 
-      std::pair<point_t, point_t> outline_t::get_points_continuation(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
+      tiling::junction_t outline_t::get_junction_continuation(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
       {
          const auto continuation = geometry::edges_map_t::continuation(connections, an_edge);
 
@@ -190,20 +297,17 @@ namespace dak
          //       should be an edge before and an edge after the edge,
          //       but we need to handle failure just in case.
          if (continuation.is_invalid())
-            return get_points_dead_end(an_edge, index, width);
-
-         const point_t jp = get_join(an_edge.p2, an_edge.p1, continuation.p2, width, width);
-
-         if (jp.is_invalid())
-            return get_points_dead_end(an_edge, index, width);
-
-         const point_t below = jp;
-         const point_t above = jp.convex_sum(an_edge.p2, 2.0);
-
-         return std::pair<point_t, point_t>(below, above);
+            return get_junction_dead_end(an_edge, index, width);
+
+         tiling::junction_t junction = get_junction_dead_end(an_edge, index, width);
+         junction.kind = tiling::junction_kind_t::continuation;
+         junction.below = continuation.p2;
+         junction.join_width = junction.width;
+         junction.other_join_width = junction.width;
+         return junction;
       }
 
-      std::pair<point_t, point_t> outline_t::get_points_intersection(const edge_t& an_edge, size_t index, double width, double other_edges_width, const geometry::edges_map_t::range_t& connections)
+      tiling::junction_t outline_t::get_junction_intersection(const edge_t& an_edge, size_t index, double width, double other_edges_width, const geometry::edges_map_t::range_t& connections)
       {
          const auto before_after = geometry::edges_map_t::before_after(connections, an_edge);
 
@@ -211,60 +315,25 @@ namespace dak
          //       should be an edge before and an edge after the edge,
          //       but we need to handle failure just in case.
          if (before_after.first.is_invalid())
-            return get_points_dead_end(an_edge, index, width);
+            return get_junction_dead_end(an_edge, index, width);
 
-         // TODO: the code below is bad when the width is large and multiple
+         // TODO: the joins are bad when the width is large and multiple
          //       intersections are nearer to each other than the width.
          //       It results in inversion of polygon points.
-         point_t dir = (an_edge.p2 - an_edge.p1);
-         const double dist = dir.mag();
-         dir = dir.scale(1.0 / dist);
-         const point_t perp = dir.perp();
-
-         const double limited_width = std::min(width, dist);
-         const double limited_other_edges_width = std::min(other_edges_width, dist);
-
-         point_t below = get_join(an_edge.p2, an_edge.p1, before_after.second.p2, limited_width, limited_other_edges_width);
-         if (below.is_invalid())
-            below = an_edge.p2 - perp.scale(get_width_at(an_edge.p2, width));
-
-         point_t above = get_join(an_edge.p2, before_after.first.p2, an_edge.p1, limited_other_edges_width, limited_width);
-         if (above.is_invalid())
-            above = an_edge.p2 + perp.scale(get_width_at(an_edge.p2, width));
-
-         return std::pair<point_t, point_t>(below, above);
+         const double dist = (an_edge.p2 - an_edge.p1).mag();
+
+         tiling::junction_t junction = get_junction_dead_end(an_edge, index, width);
+         junction.kind = tiling::junction_kind_t::intersection;
+         junction.below = before_after.second.p2;
+         junction.above = before_after.first.p2;
+         junction.join_width = get_width_at(an_edge.p2, std::min(width, dist));
+         junction.other_join_width = get_width_at(an_edge.p2, std::min(other_edges_width, dist));
+         return junction;
       }
 
-      // Do a mitered join of the two fat lines (a la postscript, for example).
-      // The join point on the other side of the joint can be computed by
-      // reflecting the point returned by this function through the joint.
-      point_t outline_t::get_join(const point_t& joint, const point_t& a, const point_t& b, double width_a, double width_b)
+      std::pair<point_t, point_t> outline_t::get_points_continuation(const edge_t& an_edge, size_t index, double width, const geometry::edges_map_t::range_t& connections)
       {
-         // Using the sine dot porudct to compute the equivalent of:
-         // 
-         //double th = joint.sweep(a, b);
-         //const double sth = std::sin(th);
-         //
-         // But without calling atan and sin, which saves time.
-         const point_t da = (joint - a).normalize();
-         const point_t db = (joint - b).normalize();
-         const double sth = db.sin_dot(da);
-
-         if (utility::near(sth, 0, 0.01))
-         {
-            return point_t();
-         }
-         else
-         {
-            width_a = get_width_at(joint, width_a);
-            width_b = get_width_at(joint, width_b);
-
-            const double la = width_b / sth;
-            const double lb = width_a / sth;
-            const double isx = joint.x - (da.x * la + db.x * lb);
-            const double isy = joint.y - (da.y * la + db.y * lb);
-            return point_t(isx, isy);
-         }
+         return tiling::compute_junction(get_junction_continuation(an_edge, index, width, connections));
       }
    }
 }
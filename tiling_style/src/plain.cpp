@@ -26,6 +26,14 @@ namespace dak
       {
          drw.set_color(color);
          drw.set_stroke(stroke_t(1., stroke_t::cap_style_t::round, stroke_t::join_style_t::round));
+
+         if (get_precision() == geometry_precision_t::compact)
+         {
+            for (const auto& e : get_compact_edges())
+               drw.draw_line(e.p1.to_point(), e.p2.to_point());
+            return;
+         }
+
          for (const auto& e : my_map.all())
             if (e.is_canonical())
                drw.draw_line(e.p1, e.p2);
@@ -33,18 +33,31 @@ namespace dak
          const double val = drw.get_transform().dist_from_inverted_zero(15.0);
          const point_t jitter(val, val);
          const point_t halfjit(val / 2, val / 2);
-         for (const auto& e : my_map.all())
-         {
-            if (!e.is_canonical())
-               continue;
 
-            const point_t p1 = e.p1 - halfjit;
-            const point_t p2 = e.p2 - halfjit;
+         const auto draw_sketched_line = [&drw, &rand, &jitter, &halfjit](const point_t& e_p1, const point_t& e_p2)
+         {
+            const point_t p1 = e_p1 - halfjit;
+            const point_t p2 = e_p2 - halfjit;
 
             for (int c = 0; c < 8; ++c)
             {
                drw.draw_line(p1 + jitter.scale(rand() / (double) rand.max()), p2 + jitter.scale(rand() / (double) rand.max()));
             }
+         };
+
+         if (get_precision() == geometry_precision_t::compact)
+         {
+            for (const auto& e : get_compact_edges())
+               draw_sketched_line(e.p1.to_point(), e.p2.to_point());
+            return;
+         }
+
+         for (const auto& e : my_map.all())
+         {
+            if (!e.is_canonical())
+               continue;
+
+            draw_sketched_line(e.p1, e.p2);
          }
       }
    }
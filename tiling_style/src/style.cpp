@@ -4,6 +4,8 @@
 
 #include <dak/geometry/utility.h>
 
+#include <atomic>
+
 namespace dak
 {
    namespace tiling_style
@@ -11,18 +13,47 @@ namespace dak
       using geometry::transform_t;
       using geometry::polygon_t;
 
+      uint64_t style_t::new_map_version()
+      {
+         static std::atomic<uint64_t> last_version = 0;
+         return ++last_version;
+      }
+
       void style_t::add_inflation_for_point(const point_t& pt, double inflation)
       {
          const double distance = my_tiling_center.distance_2(pt);
-         my_inflation_by_distances[distance] = inflation;
+         my_inflation_widths.add(distance, inflation);
       }
 
-      void style_t::set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t)
+      void style_t::set_map(const geometry::edges_map_t& m, const std::shared_ptr<const tiling_t>& t, uint64_t map_id)
       {
-         my_map = m;
-         my_tiling = std::dynamic_pointer_cast<const inflation_tiling_t>(t);
+         // Only inflation tilings affect the style geometry.
+         auto new_tiling = std::dynamic_pointer_cast<const inflation_tiling_t>(t);
+         // Note: a known map id avoids comparing all the edges. When the map was
+         //       released, the id is the only way to detect the same map.
+         if (new_tiling == my_tiling)
+         {
+            if (map_id != 0 && map_id == my_map_id)
+               return;
+            if (map_id == 0 && !is_map_released() && (&m == &my_map || m.all() == my_map.all()))
+               return;
+         }
 
-         my_inflation_by_distances.clear();
+         if (is_map_released())
+         {
+            my_map = edges_map_t();
+            my_compact_edges = tiling::make_compact_edges(m);
+         }
+         else
+         {
+            my_map = m;
+            my_compact_edges.clear();
+         }
+         my_map_version = new_map_version();
+         my_map_id = map_id;
+         my_tiling = std::move(new_tiling);
+
+         my_inflation_widths.clear();
          my_tiling_center = point_t();
 
          if (!my_tiling)
@@ -53,33 +84,67 @@ namespace dak
             const double inflated_peri = inflated_tile.perimeter();
             self->add_inflation_for_point(inflated_tile.center(), inflated_peri / perimeter);
          });
+
+         my_inflation_widths.build();
       }
 
       double style_t::get_width_at(const point_t& pt, double width) const
       {
-         if (my_inflation_by_distances.size() < 2)
+         if (my_inflation_widths.size() < 2)
             return width;
 
-         const double distance = my_tiling_center.distance_2(pt);
-         const auto pos = my_inflation_by_distances.lower_bound(distance);
-         if (pos == my_inflation_by_distances.begin())
-            return width;
+         return my_inflation_widths.get_width(my_tiling_center.distance_2(pt), width);
+      }
 
-         if (pos == my_inflation_by_distances.end())
+      void style_t::set_precision(geometry_precision_t p)
+      {
+         if (p == my_precision)
+            return;
+
+         // Note: a released map must be set again, so it no longer matches its id.
+         if (is_map_released())
+            my_map_id = 0;
+
+         my_precision = p;
+         if (is_map_released())
          {
-            const auto pred = std::prev(pos);
-            const double inflation = pred->second;
-            return width * inflation;
+            if (my_compact_edges.size() <= 0)
+               my_compact_edges = tiling::make_compact_edges(my_map);
+            my_map = edges_map_t();
          }
-         else
+         else if (my_precision == geometry_precision_t::full)
          {
-            const auto pred = std::prev(pos);
-            const double ratio = (distance - pred->first) / (pos->first - pred->first);
-            const double inflation = pred->second + (pos->second - pred->second) * ratio;
-            return width * inflation;
+            my_compact_edges = tiling::compact_edges_t();
          }
       }
 
+      bool style_t::is_map_released() const
+      {
+         return my_precision == geometry_precision_t::compact && draws_only_compact_edges();
+      }
+
+      const tiling::compact_edges_t& style_t::get_compact_edges()
+      {
+         if (my_compact_edges.size() <= 0 && !is_map_released())
+            my_compact_edges = tiling::make_compact_edges(my_map);
+         return my_compact_edges;
+      }
+
+      size_t style_t::memory_usage() const
+      {
+         return tiling::memory_usage(my_map)
+              + tiling::memory_usage(my_compact_edges)
+              + my_inflation_widths.memory_usage();
+      }
+
+      void style_t::record_generation(std::chrono::steady_clock::time_point start, size_t item_count)
+      {
+         const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+         my_generation_stats.generation_count += 1;
+         my_generation_stats.duration_ms = duration.count();
+         my_generation_stats.item_count = item_count;
+      }
+
       void style_t::make_similar(const layer_t& other)
       {
          layer_t::make_similar(other);
@@ -87,6 +152,20 @@ namespace dak
          if (const style_t* other_style = dynamic_cast<const style_t*>(&other))
          {
             my_map = other_style->my_map;
+            my_map_version = new_map_version();
+            // Note: a released map cannot be restored here, so it will need to be set again.
+            my_map_id = (other_style->is_map_released() && !is_map_released()) ? 0 : other_style->my_map_id;
+            my_compact_edges = other_style->my_compact_edges;
+            if (is_map_released())
+            {
+               if (my_compact_edges.size() <= 0)
+                  my_compact_edges = tiling::make_compact_edges(my_map);
+               my_map = edges_map_t();
+            }
+            else
+            {
+               my_compact_edges.clear();
+            }
          }
       }
    }
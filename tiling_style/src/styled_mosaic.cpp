@@ -70,6 +70,22 @@ namespace dak
          return std::make_shared<styled_mosaic_t>(*this);
       }
 
+      size_t styled_mosaic_t::memory_usage() const
+      {
+         tiling::counted_objects_t counted;
+         return memory_usage(counted);
+      }
+
+      size_t styled_mosaic_t::memory_usage(tiling::counted_objects_t& counted) const
+      {
+         size_t usage = 0;
+         if (mosaic)
+            usage += mosaic->memory_usage(counted);
+         if (style && counted.insert(style.get()).second)
+            usage += style->memory_usage();
+         return usage;
+      }
+
       void styled_mosaic_t::update_style(const rectangle_t& region)
       {
          if (!style)
@@ -86,7 +102,25 @@ namespace dak
          if (!style)
             return;
 
+         const size_t generation_count = style->get_generation_stats().generation_count;
+         const auto start = std::chrono::steady_clock::now();
+
          style->draw(drw);
+
+         // Note: the style generates its drawing elements while drawing, so
+         //       remove the generation time from the draw time.
+         const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+         const auto& generation = style->get_generation_stats();
+         const bool generated = (generation.generation_count != generation_count);
+         if (generated)
+         {
+            stats.generate_ms = generation.duration_ms;
+            // Note: the memory mostly changes when the style generates, so only measure it then.
+            stats.memory_bytes = memory_usage();
+         }
+         stats.generate_cached = !generated;
+         stats.draw_ms = duration.count() - (generated ? generation.duration_ms : 0.);
+         stats.item_count = generation.item_count;
       }
    }
 }
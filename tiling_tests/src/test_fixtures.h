@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef DAK_TILING_TESTS_TEST_FIXTURES_H
+#define DAK_TILING_TESTS_TEST_FIXTURES_H
+
+#include <dak/tiling/translation_tiling.h>
+#include <dak/tiling/known_tilings.h>
+#include <dak/tiling/mosaic.h>
+#include <dak/tiling/star.h>
+#include <dak/tiling/tiling_io.h>
+
+#include "CppUnitTest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace tiling_tests
+{
+   using namespace dak::geometry;
+   using namespace dak::tiling;
+
+   using Microsoft::VisualStudio::CppUnitTestFramework::Assert;
+
+   // Verify that two maps have the same edges, within the tolerance of the vertex merges.
+   inline void assert_same_edges(const edges_map_t& expected, const edges_map_t& actual)
+   {
+      Assert::AreEqual(expected.all().size(), actual.all().size());
+      for (size_t i = 0; i < expected.all().size(); ++i)
+      {
+         const edge_t& expected_edge = expected.all()[i];
+         const edge_t& actual_edge = actual.all()[i];
+         Assert::AreEqual(expected_edge.p1.x, actual_edge.p1.x, 1e-9);
+         Assert::AreEqual(expected_edge.p1.y, actual_edge.p1.y, 1e-9);
+         Assert::AreEqual(expected_edge.p2.x, actual_edge.p2.x, 1e-9);
+         Assert::AreEqual(expected_edge.p2.y, actual_edge.p2.y, 1e-9);
+      }
+   }
+
+   // Folder of the tilings shipped with the application, relative to the tests.
+   #define KNOWN_TILINGS_DIR L"../../../tiling/tilings"
+
+   // The tile of the square tiling.
+   inline polygon_t make_square_tile()
+   {
+      return polygon_t::make_regular(4);
+   }
+
+   // Tiling of unit squares, with a single tile per translation unit.
+   inline std::shared_ptr<translation_tiling_t> make_square_tiling()
+   {
+      auto tiling = std::make_shared<translation_tiling_t>(L"squares", point_t(1., 0.), point_t(0., 1.));
+      tiling->tiles[make_square_tile()].emplace_back(transform_t::identity());
+      return tiling;
+   }
+
+   // Mosaic of the square tiling drawing each square with the given figure.
+   inline mosaic_t make_square_mosaic(const std::shared_ptr<figure_t>& figure = std::make_shared<star_t>(4, 2., 1))
+   {
+      mosaic_t mo(make_square_tiling());
+      mo.tile_figures[make_square_tile()] = figure;
+      return mo;
+   }
+
+   // Read one of the tilings shipped with the application.
+   inline std::shared_ptr<tiling_t> read_known_tiling(const std::wstring& name)
+   {
+      std::wifstream file(std::filesystem::path(KNOWN_TILINGS_DIR) / (name + L".tiling"));
+      return read_tiling(file);
+   }
+
+   // Mosaic of a shipped tiling with several tile shapes and rotated placements,
+   // drawn with the default figures.
+   inline std::shared_ptr<mosaic_t> make_multi_tile_mosaic()
+   {
+      return generate_mosaic(read_known_tiling(L"3.4.6"));
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
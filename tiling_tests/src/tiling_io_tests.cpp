@@ -2,6 +2,8 @@
 #include <dak/tiling/rosette.h>
 #include <dak/tiling/star.h>
 #include <dak/tiling/irregular_figure.h>
+#include <dak/tiling/tiling_io.h>
+#include <dak/tiling/text_reader.h>
 
 #include <dak/geometry/face.h>
 #include <dak/geometry/utility.h>
@@ -9,6 +11,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 
 #include "CppUnitTest.h"
 
@@ -38,6 +41,49 @@ namespace tiling_tests
          }
       }
 
+      TEST_METHOD(tiling_io_round_trip_all_tilings)
+      {
+         std::vector<std::wstring> errors;
+         known_tilings_t tilings = read_tilings(KNOWN_TILINGS_DIR, errors);
+         for (const auto& name_and_tiling : tilings)
+         {
+            const auto tiling = name_and_tiling.second;
+
+            std::wstringstream stream;
+            write_tiling(tiling, stream);
+            const auto reread = read_tiling(stream);
+
+            Assert::IsTrue(*tiling == *reread, (tiling->name + std::wstring(L" changed after write and read")).c_str());
+            Assert::AreEqual(tiling->name, reread->name);
+            Assert::AreEqual(tiling->description, reread->description);
+            Assert::AreEqual(tiling->author, reread->author);
+         }
+      }
+
+      TEST_METHOD(tiling_io_text_reader)
+      {
+         text_reader_t reader(L"  word \"quoted \\\"text\\\"\" unquoted +12 -3.5e2 7.25 true false 1,5");
+
+         Assert::IsTrue(reader.peek_word() == L"word");
+         Assert::IsTrue(reader.read_word() == L"word");
+         Assert::AreEqual(std::wstring(L"quoted \"text\""), reader.read_quoted());
+         Assert::AreEqual(std::wstring(L"unquoted"), reader.read_quoted());
+         Assert::AreEqual(12, reader.read_int());
+         Assert::AreEqual(-350., reader.read_double());
+         Assert::AreEqual(7, reader.read_int());
+         Assert::AreEqual(.25, reader.read_double());
+         Assert::IsTrue(reader.read_bool());
+         Assert::IsFalse(reader.read_bool());
+         Assert::AreEqual(1., reader.read_double());
+         Assert::IsFalse(reader.failed());
+
+         // Like a stream, a failed read makes all further reads fail.
+         Assert::AreEqual(0., reader.read_double());
+         Assert::IsTrue(reader.failed());
+         Assert::AreEqual(0, reader.read_int());
+         Assert::IsTrue(reader.at_end());
+      }
+
       #define SLOW_DAK_GEOMETRY_TILING_IO_TESTS
 
       #ifdef SLOW_DAK_GEOMETRY_TILING_IO_TESTS
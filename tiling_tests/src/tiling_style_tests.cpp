@@ -0,0 +1,402 @@
+#include <dak/tiling_style/filled.h>
+#include <dak/tiling_style/layers_snapshot.h>
+#include <dak/tiling_style/mosaic_disk_cache.h>
+#include <dak/tiling_style/mosaic_memory_cache.h>
+#include <dak/tiling_style/outline.h>
+#include <dak/tiling_style/styled_mosaic.h>
+
+#include <dak/tiling/translation_tiling.h>
+#include <dak/tiling/mosaic.h>
+#include <dak/tiling/star.h>
+#include <dak/tiling/rosette.h>
+
+#include <dak/geometry/face.h>
+
+#include "CppUnitTest.h"
+#include "test_fixtures.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace dak::geometry;
+using namespace dak::tiling;
+using namespace dak::tiling_style;
+
+namespace tiling_tests
+{
+   // Outline giving access to its cached fat lines without drawing.
+   class test_outline_t : public outline_t
+   {
+   public:
+      void fill_cache()
+      {
+         my_cached_map_version = get_map_version();
+         my_cached_width = width;
+         my_cached_outline_width = outline_width;
+         my_cached_precision = get_precision();
+         my_cached_fat_lines = generate_fat_lines(false);
+      }
+
+      bool has_cache() const
+      {
+         return !is_cache_invalid();
+      }
+   };
+
+   // Filled style giving access to its cached faces without drawing.
+   class test_filled_t : public filled_t
+   {
+   public:
+      void fill_cache()
+      {
+         my_cached_map_version = get_map_version();
+         face_t::faces_t exteriors;
+         face_t::make_faces(my_map, my_cached_inside, my_cached_outside, my_cached_odd, exteriors);
+      }
+
+      bool has_cache() const
+      {
+         return !my_cached_inside.empty() && my_cached_map_version == get_map_version();
+      }
+   };
+
+   // Memory cache giving the same key to all maps, so that they all collide.
+   class colliding_memory_cache_t : public mosaic_memory_cache_t
+   {
+   protected:
+      uint64_t make_key(const mosaic_t&, const transform_t&, const rectangle_t&) const override
+      {
+         return 1;
+      }
+   };
+
+   // Constructor of a mosaic map counting how many times it is called.
+   mosaic_memory_cache_t::constructor_t counted_constructor(const mosaic_t& mo, const rectangle_t& region, size_t& count)
+   {
+      return [&mo, region, &count]()
+      {
+         ++count;
+         return mo.construct(region);
+      };
+   }
+
+   // Empty folder for a disk cache used by a test.
+   std::filesystem::path make_empty_cache_folder(const std::wstring& name)
+   {
+      const std::filesystem::path folder = std::filesystem::temp_directory_path() / L"alhambra_tests" / name;
+      std::filesystem::remove_all(folder);
+      std::filesystem::create_directories(folder);
+      return folder;
+   }
+
+   // Find the single map file of a disk cache.
+   std::filesystem::path find_cached_map_file(const std::filesystem::path& folder)
+   {
+      std::filesystem::path found;
+      for (const auto& entry : std::filesystem::directory_iterator(folder))
+      {
+         if (entry.path().extension() != L".map")
+            continue;
+         Assert::IsTrue(found.empty());
+         found = entry.path();
+      }
+      Assert::IsFalse(found.empty());
+      return found;
+   }
+
+   TEST_CLASS(tiling_style_tests)
+   {
+   public:
+      TEST_METHOD(style_caches_survive_color_changes)
+      {
+         const polygon_t square = make_square_tile();
+         mosaic_t mo = make_square_mosaic();
+         const auto tiling = mo.tiling;
+
+         const rectangle_t region(-2., -2., 4., 4.);
+         mosaic_memory_cache_t cache;
+         const auto construct = [&mo, &region]() { return mo.construct(region); };
+
+         const auto first = cache.construct(mo, transform_t::identity(), region, construct);
+
+         test_outline_t outline;
+         outline.set_map(first.map, tiling, first.map_id);
+         outline.fill_cache();
+         Assert::IsTrue(outline.has_cache());
+
+         test_filled_t filled;
+         filled.set_map(first.map, tiling, first.map_id);
+         filled.fill_cache();
+         Assert::IsTrue(filled.has_cache());
+
+         // Setting the same cached map after a color change keeps the caches.
+         const auto again = cache.construct(mo, transform_t::identity(), region, construct);
+         Assert::AreEqual(first.map_id, again.map_id);
+
+         outline.color = dak::ui::color_t(255, 0, 0, 255);
+         outline.outline_color = dak::ui::color_t(0, 0, 255, 255);
+         outline.set_map(again.map, tiling, again.map_id);
+         Assert::IsTrue(outline.has_cache());
+
+         filled.color = dak::ui::color_t(255, 0, 0, 255);
+         filled.set_map(again.map, tiling, again.map_id);
+         Assert::IsTrue(filled.has_cache());
+
+         // Changing the width invalidates the outline.
+         outline.width *= 2.;
+         Assert::IsFalse(outline.has_cache());
+         outline.fill_cache();
+         Assert::IsTrue(outline.has_cache());
+
+         // Changing the map clears both caches.
+         mo.tile_figures[square] = std::make_shared<star_t>(4, 1.5, 1);
+         const auto changed = cache.construct(mo, transform_t::identity(), region, construct);
+         Assert::AreNotEqual(first.map_id, changed.map_id);
+
+         outline.set_map(changed.map, tiling, changed.map_id);
+         Assert::IsFalse(outline.has_cache());
+
+         filled.set_map(changed.map, tiling, changed.map_id);
+         Assert::IsFalse(filled.has_cache());
+      }
+
+      TEST_METHOD(memory_cache_misses_on_transform_or_region_change)
+      {
+         const mosaic_t mo = make_square_mosaic();
+         const rectangle_t region(-2., -2., 4., 4.);
+         const rectangle_t larger_region(-2., -2., 5., 4.);
+         const transform_t moved = transform_t::translate(point_t(0.5, 0.));
+
+         mosaic_memory_cache_t cache;
+         size_t count = 0;
+
+         const uint64_t first_id = cache.construct(mo, transform_t::identity(), region, counted_constructor(mo, region, count)).map_id;
+         Assert::AreEqual(size_t(1), count);
+
+         Assert::AreEqual(first_id, cache.construct(mo, transform_t::identity(), region, counted_constructor(mo, region, count)).map_id);
+         Assert::AreEqual(size_t(1), count);
+
+         Assert::AreNotEqual(first_id, cache.construct(mo, moved, region, counted_constructor(mo, region, count)).map_id);
+         Assert::AreEqual(size_t(2), count);
+
+         Assert::AreNotEqual(first_id, cache.construct(mo, transform_t::identity(), larger_region, counted_constructor(mo, larger_region, count)).map_id);
+         Assert::AreEqual(size_t(3), count);
+
+         // The first map is still cached.
+         Assert::AreEqual(first_id, cache.construct(mo, transform_t::identity(), region, counted_constructor(mo, region, count)).map_id);
+         Assert::AreEqual(size_t(3), count);
+      }
+
+      TEST_METHOD(memory_cache_evicts_least_recently_used)
+      {
+         const mosaic_t mo = make_square_mosaic();
+         const rectangle_t region(-2., -2., 4., 4.);
+         const transform_t trf_a = transform_t::identity();
+         const transform_t trf_b = transform_t::translate(point_t(1., 0.));
+         const transform_t trf_c = transform_t::translate(point_t(2., 0.));
+
+         // Note: the translated maps have the same number of edges, so the same size.
+         size_t count = 0;
+         mosaic_memory_cache_t probe;
+         probe.construct(mo, trf_a, region, counted_constructor(mo, region, count));
+         const size_t map_bytes = probe.size_in_bytes();
+
+         mosaic_memory_cache_t cache(2 * map_bytes);
+         count = 0;
+         cache.construct(mo, trf_a, region, counted_constructor(mo, region, count));
+         cache.construct(mo, trf_b, region, counted_constructor(mo, region, count));
+         cache.construct(mo, trf_a, region, counted_constructor(mo, region, count));
+         Assert::AreEqual(size_t(2), count);
+
+         // Adding a third map drops the least recently used one, b.
+         cache.construct(mo, trf_c, region, counted_constructor(mo, region, count));
+         Assert::AreEqual(size_t(3), count);
+         Assert::AreEqual(2 * map_bytes, cache.size_in_bytes());
+
+         cache.construct(mo, trf_a, region, counted_constructor(mo, region, count));
+         cache.construct(mo, trf_c, region, counted_constructor(mo, region, count));
+         Assert::AreEqual(size_t(3), count);
+
+         cache.construct(mo, trf_b, region, counted_constructor(mo, region, count));
+         Assert::AreEqual(size_t(4), count);
+      }
+
+      TEST_METHOD(memory_cache_replaces_colliding_maps)
+      {
+         const mosaic_t star_mo = make_square_mosaic(std::make_shared<star_t>(4, 2., 1));
+         const mosaic_t rosette_mo = make_square_mosaic(std::make_shared<rosette_t>(4, 0.2, 1));
+         const rectangle_t region(-2., -2., 4., 4.);
+
+         colliding_memory_cache_t cache;
+         size_t count = 0;
+
+         const uint64_t star_id = cache.construct(star_mo, transform_t::identity(), region, counted_constructor(star_mo, region, count)).map_id;
+         const auto rosette = cache.construct(rosette_mo, transform_t::identity(), region, counted_constructor(rosette_mo, region, count));
+         Assert::AreEqual(size_t(2), count);
+         Assert::AreNotEqual(star_id, rosette.map_id);
+         Assert::AreEqual(rosette_mo.construct(region).all().size(), rosette.map.all().size());
+
+         // The rosette replaced the star.
+         const uint64_t new_star_id = cache.construct(star_mo, transform_t::identity(), region, counted_constructor(star_mo, region, count)).map_id;
+         Assert::AreEqual(size_t(3), count);
+         Assert::AreNotEqual(star_id, new_star_id);
+
+         // A separate copy with the same content is found.
+         const mosaic_t star_copy = make_square_mosaic(std::make_shared<star_t>(4, 2., 1));
+         Assert::AreEqual(new_star_id, cache.construct(star_copy, transform_t::identity(), region, counted_constructor(star_copy, region, count)).map_id);
+         Assert::AreEqual(size_t(3), count);
+      }
+
+      TEST_METHOD(memory_cache_keeps_only_the_most_recent_map)
+      {
+         const mosaic_t mo = make_square_mosaic();
+         const rectangle_t region(-2., -2., 4., 4.);
+         const size_t edge_count = mo.construct(region).all().size();
+
+         // Note: the cache holds no bytes, so each call drops the previous map.
+         mosaic_memory_cache_t cache(0);
+         size_t count = 0;
+
+         const auto first = cache.construct(mo, transform_t::identity(), region, counted_constructor(mo, region, count));
+         Assert::AreEqual(edge_count, first.map.all().size());
+         Assert::IsTrue(cache.size_in_bytes() > 0);
+
+         const auto second = cache.construct(mo, transform_t::translate(point_t(1., 0.)), region, counted_constructor(mo, region, count));
+         Assert::AreEqual(edge_count, second.map.all().size());
+         Assert::AreEqual(size_t(2), count);
+
+         cache.construct(mo, transform_t::identity(), region, counted_constructor(mo, region, count));
+         Assert::AreEqual(size_t(3), count);
+      }
+
+      TEST_METHOD(disk_cache_reloads_the_constructed_map)
+      {
+         mosaic_disk_cache_t cache(make_empty_cache_folder(L"reload"));
+
+         // Note: the shipped tiling produces a map large enough to be read in several chunks.
+         const mosaic_t mosaics[] =
+         {
+            make_square_mosaic(),
+            *make_multi_tile_mosaic(),
+         };
+
+         const rectangle_t region(-4., -4., 8., 8.);
+         for (const auto& mo : mosaics)
+         {
+            const edges_map_t expected = mo.construct(region);
+            const uint64_t key = mosaic_disk_cache_t::make_key(mo, region);
+
+            edges_map_t loaded;
+            Assert::IsFalse(cache.load(key, loaded));
+
+            assert_same_edges(expected, cache.construct(mo, region));
+
+            Assert::IsTrue(cache.load(key, loaded));
+            assert_same_edges(expected, loaded);
+            assert_same_edges(expected, cache.construct(mo, region));
+         }
+      }
+
+      TEST_METHOD(disk_cache_misses_after_figure_edit)
+      {
+         mosaic_disk_cache_t cache(make_empty_cache_folder(L"edit"));
+
+         mosaic_t mo = make_square_mosaic();
+         const rectangle_t region(-2., -2., 4., 4.);
+         cache.construct(mo, region);
+
+         edges_map_t loaded;
+         Assert::IsTrue(cache.load(mosaic_disk_cache_t::make_key(mo, region), loaded));
+
+         auto star = std::dynamic_pointer_cast<star_t>(mo.get_modifiable_figure(make_square_tile()));
+         star->d = 1.5;
+
+         const uint64_t edited_key = mosaic_disk_cache_t::make_key(mo, region);
+         Assert::IsFalse(cache.load(edited_key, loaded));
+
+         assert_same_edges(mo.construct(region), cache.construct(mo, region));
+         Assert::IsTrue(cache.load(edited_key, loaded));
+      }
+
+      TEST_METHOD(disk_cache_misses_other_versions)
+      {
+         const std::filesystem::path folder = make_empty_cache_folder(L"version");
+         mosaic_disk_cache_t cache(folder);
+
+         const mosaic_t mo = make_square_mosaic();
+         const rectangle_t region(-2., -2., 4., 4.);
+         const uint64_t key = mosaic_disk_cache_t::make_key(mo, region);
+         cache.construct(mo, region);
+
+         // Bump the version written in the file header, after the magic.
+         const std::filesystem::path path = find_cached_map_file(folder);
+         {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            uint32_t version = 0;
+            file.seekg(8);
+            file.read(reinterpret_cast<char*>(&version), sizeof(version));
+            version += 1;
+            file.seekp(8);
+            file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+         }
+
+         edges_map_t loaded;
+         Assert::IsFalse(cache.load(key, loaded));
+
+         // The map is constructed and saved again.
+         assert_same_edges(mo.construct(region), cache.construct(mo, region));
+         Assert::IsTrue(cache.load(key, loaded));
+      }
+
+      TEST_METHOD(snapshot_shares_unchanged_mosaics_and_figures)
+      {
+         const polygon_t square = make_square_tile();
+         const polygon_t small_square = square.apply(transform_t::scale(0.5));
+         auto tiling = make_square_tiling();
+         tiling->tiles[small_square].emplace_back(transform_t::translate(0.5, 0.5));
+
+         std::vector<std::shared_ptr<layer_t>> layers;
+         for (int i = 0; i < 2; ++i)
+         {
+            auto mo_layer = std::make_shared<styled_mosaic_t>();
+            mo_layer->mosaic = std::make_shared<mosaic_t>(tiling);
+            mo_layer->mosaic->tile_figures[square] = std::make_shared<star_t>(4, 2., 1);
+            mo_layer->mosaic->tile_figures[small_square] = std::make_shared<star_t>(4, 1., 1);
+            mo_layer->style = std::make_shared<outline_t>();
+            layers.emplace_back(mo_layer);
+         }
+
+         const auto first = snapshot_layers(layers, {});
+
+         // Edit a figure of the first layer of a clone of the snapshot, like undo does,
+         // by an amount that comparisons with a tolerance would not see.
+         std::vector<std::shared_ptr<layer_t>> edited;
+         for (const auto& layer : first)
+            edited.emplace_back(layer->clone());
+
+         const double edited_d = 2. + 1e-12;
+         auto edited_mosaic = std::dynamic_pointer_cast<styled_mosaic_t>(edited[0])->mosaic;
+         std::dynamic_pointer_cast<star_t>(edited_mosaic->get_modifiable_figure(square))->d = edited_d;
+
+         const auto second = snapshot_layers(edited, first);
+
+         const auto first_0 = std::dynamic_pointer_cast<styled_mosaic_t>(first[0])->mosaic;
+         const auto first_1 = std::dynamic_pointer_cast<styled_mosaic_t>(first[1])->mosaic;
+         const auto second_0 = std::dynamic_pointer_cast<styled_mosaic_t>(second[0])->mosaic;
+         const auto second_1 = std::dynamic_pointer_cast<styled_mosaic_t>(second[1])->mosaic;
+
+         // The unchanged layer and figure are shared.
+         Assert::IsTrue(first_1 == second_1);
+         Assert::IsTrue(first_0 != second_0);
+         Assert::IsTrue(first_0->tile_figures[small_square] == second_0->tile_figures[small_square]);
+         Assert::IsTrue(first_0->tile_figures[square] != second_0->tile_figures[square]);
+
+         // Undoing and redoing restores the exact values.
+         auto undone = std::dynamic_pointer_cast<styled_mosaic_t>(first[0]->clone());
+         Assert::AreEqual(2., std::dynamic_pointer_cast<star_t>(undone->mosaic->tile_figures[square])->d);
+
+         auto redone = std::dynamic_pointer_cast<styled_mosaic_t>(second[0]->clone());
+         Assert::AreEqual(edited_d, std::dynamic_pointer_cast<star_t>(redone->mosaic->tile_figures[square])->d);
+      }
+   };
+}
+
+// vim: sw=3 : sts=3 : et : sta :
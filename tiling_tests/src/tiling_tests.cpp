@@ -1,6 +1,27 @@
 #include <dak/tiling/translation_tiling.h>
+#include <dak/tiling/mosaic.h>
+#include <dak/tiling/star.h>
+#include <dak/tiling/rosette.h>
+#include <dak/tiling/explicit_figure.h>
+#include <dak/tiling/extended_figure.h>
+#include <dak/tiling/irregular_figure.h>
+#include <dak/tiling/placed_tiles_index.h>
+#include <dak/tiling/snap_points_index.h>
+#include <dak/tiling/incremental_mosaic.h>
+#include <dak/tiling/batch_transform.h>
+#include <dak/tiling/compact_geometry.h>
+#include <dak/tiling/inflation_widths.h>
+#include <dak/tiling/miter_joins.h>
+#include <dak/tiling/over_under_weaving.h>
+#include <dak/tiling/parallel.h>
 
 #include "CppUnitTest.h"
+#include "test_fixtures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace dak::geometry;
@@ -8,6 +29,96 @@ using namespace dak::tiling;
 
 namespace tiling_tests
 {		
+   // Verify that two point selections select the same points of the same tiles.
+   void assert_same_points(const selection_t& expected, const selection_t& actual)
+   {
+      Assert::AreEqual(expected.data.size(), actual.data.size());
+      for (size_t i = 0; i < expected.data.size(); ++i)
+      {
+         const point_selection_t* expected_pt = std::any_cast<point_selection_t>(&expected.data[i]);
+         const point_selection_t* actual_pt = std::any_cast<point_selection_t>(&actual.data[i]);
+         Assert::IsTrue(expected_pt != nullptr && actual_pt != nullptr);
+         Assert::IsTrue(expected_pt->tile == actual_pt->tile);
+         Assert::IsTrue(expected_pt->points == actual_pt->points);
+      }
+   }
+
+   // The original overlap check of the tiling editor, comparing each tile with all the others.
+   bool brute_force_is_overlapped(const std::vector<std::shared_ptr<placed_tile_t>>& tiles,
+                                  const placed_tile_t& checked, const point_t& t1, const point_t& t2)
+   {
+      const point_t checked_center = checked.tile.apply(checked.trf).center();
+      for (const auto& placed : tiles)
+      {
+         if (*placed == checked)
+            continue;
+
+         const polygon_t tile = placed->tile.apply(placed->trf);
+         for (int y = -1; y <= 1; ++y)
+            for (int x = -1; x <= 1; ++x)
+               if (tile.apply(transform_t::translate(t1.scale(x) + t2.scale(y))).is_inside(checked_center))
+                  return true;
+      }
+      return false;
+   }
+
+   // The original sequential depth-first over/under propagation of the interlace style.
+   std::vector<bool> sequential_over_under(const edges_map_t& map)
+   {
+      const auto& edges = map.all();
+      std::vector<bool> is_p1_over(edges.size(), false);
+      std::vector<bool> done_lines(edges.size(), false);
+      std::vector<size_t> todos;
+
+      auto index_of = [&edges](const edge_t& edge) { return size_t(std::lower_bound(edges.begin(), edges.end(), edge) - edges.begin()); };
+
+      for (size_t i = 0; i < done_lines.size(); ++i)
+      {
+         if (done_lines[i])
+            continue;
+
+         todos.push_back(i);
+         while (todos.size() > 0)
+         {
+            const size_t index = todos.back();
+            todos.pop_back();
+            if (done_lines[index])
+               continue;
+            done_lines[index] = true;
+
+            const edge_t& cur_edge = edges[index];
+            const auto connections = map.outbounds(cur_edge.p1);
+            const size_t connection_count = connections.size();
+            const edge_t* conn_edges = &*(connections.begin());
+            const size_t cur_index_in_conns = std::lower_bound(connections.begin(), connections.end(), cur_edge) - connections.begin();
+
+            const bool is_crossing_over = is_p1_over[index];
+            const bool is_not_a_crossing = (connection_count == 2);
+
+            const size_t twin_index = index_of(cur_edge.twin());
+            if (!done_lines[twin_index])
+            {
+               is_p1_over[twin_index] = is_not_a_crossing ? is_crossing_over : !is_crossing_over;
+               todos.push_back(twin_index);
+            }
+
+            bool next_is_over = is_not_a_crossing ? is_crossing_over : !is_crossing_over;
+            for (size_t offset = 1; offset < connection_count; ++offset)
+            {
+               const size_t next_index = index_of(conn_edges[(cur_index_in_conns + offset) % connection_count]);
+               if (!done_lines[next_index])
+               {
+                  is_p1_over[next_index] = next_is_over;
+                  todos.push_back(next_index);
+               }
+               next_is_over = !next_is_over;
+            }
+         }
+      }
+
+      return is_p1_over;
+   }
+
 	TEST_CLASS(tiling_tests)
 	{
 	public:
@@ -36,5 +147,521 @@ namespace tiling_tests
          Assert::IsFalse(t2.tiles.begin()->second.empty());
       }
 
+      TEST_METHOD(mosaic_content_hash)
+      {
+         auto tiling = std::make_shared<translation_tiling_t>(L"tiling", point_t(1., 0.), point_t(0., 1.));
+         const polygon_t square({ point_t(0., 0.), point_t(1., 0.), point_t(1., 1.), point_t(0., 1.) });
+         tiling->tiles[square].emplace_back(transform_t::identity());
+
+         mosaic_t mo1(tiling);
+         mo1.tile_figures[square] = std::make_shared<star_t>(4, 2., 1);
+         mosaic_t mo2(mo1);
+
+         Assert::IsTrue(mo1.content_hash() == mo2.content_hash());
+         Assert::IsTrue(mo1.tile_figures[square] == mo2.tile_figures[square]);
+
+         auto star = std::dynamic_pointer_cast<star_t>(mo2.get_modifiable_figure(square));
+         Assert::IsTrue(star != nullptr);
+         star->d = 1.5;
+
+         Assert::IsTrue(mo1.content_hash() != mo2.content_hash());
+         Assert::IsFalse(mo1 == mo2);
+         Assert::AreEqual(2., std::dynamic_pointer_cast<star_t>(mo1.tile_figures[square])->d);
+      }
+
+      TEST_METHOD(figure_content_hash_follows_changes)
+      {
+         star_t star(4, 2., 1);
+         const uint64_t original_hash = star.content_hash();
+         Assert::IsTrue(original_hash == star.content_hash());
+
+         star.d = 1.5;
+         Assert::IsTrue(original_hash != star.content_hash());
+
+         star.d = 2.;
+         Assert::IsTrue(original_hash == star.content_hash());
+
+         edges_map_t map;
+         map.insert(edge_t(point_t(0., 0.), point_t(1., 0.)));
+         explicit_figure_t explicit_fig(map);
+         const uint64_t explicit_hash = explicit_fig.content_hash();
+
+         map.insert(edge_t(point_t(1., 0.), point_t(1., 1.)));
+         explicit_fig.set_map(map);
+         Assert::IsTrue(explicit_hash != explicit_fig.content_hash());
+         Assert::IsTrue(explicit_fig.content_hash() == explicit_figure_t(map).content_hash());
+      }
+
+      TEST_METHOD(placed_tiles_index_selection)
+      {
+         const polygon_t square({ point_t(0., 0.), point_t(1., 0.), point_t(1., 1.), point_t(0., 1.) });
+
+         std::vector<std::shared_ptr<placed_tile_t>> tiles;
+         for (int y = 0; y < 20; ++y)
+            for (int x = 0; x < 20; ++x)
+               tiles.emplace_back(std::make_shared<placed_tile_t>(placed_tile_t{ square, transform_t::translate(point_t(x, y)) }));
+
+         // Overlapping tile added last, which has priority.
+         tiles.emplace_back(std::make_shared<placed_tile_t>(placed_tile_t{ square, transform_t::translate(point_t(3.5, 3.5)) }));
+
+         placed_tiles_index_t index;
+         index.rebuild(tiles);
+
+         const point_t points[] = { point_t(3.8, 3.8), point_t(0.5, 0.5), point_t(7., 7.), point_t(19.5, 0.02), point_t(-5., -5.) };
+         const selection_type_t types[] = { selection_type_t::all, selection_type_t::point, selection_type_t::edge, selection_type_t::tile };
+         for (const point_t& pt : points)
+         {
+            for (const selection_type_t sel_type : types)
+            {
+               const auto linear = tiling_selection::get_placed_tile(tiling_selection::find_selection(tiles, pt, 0.05, selection_t(), sel_type));
+               const auto indexed = tiling_selection::get_placed_tile(tiling_selection::find_selection(index, pt, 0.05, selection_t(), sel_type));
+               Assert::IsTrue(linear.tile == indexed.tile);
+            }
+         }
+
+         tiles.back()->trf = transform_t::translate(point_t(10.5, 10.5));
+         index.update(tiles.back());
+         Assert::IsTrue(tiling_selection::get_placed_tile(tiling_selection::find_selection(index, point_t(10.8, 10.8), 0.05, selection_t(), selection_type_t::tile)).tile == tiles.back());
+
+         index.remove(tiles.back());
+         Assert::IsTrue(tiling_selection::get_placed_tile(tiling_selection::find_selection(index, point_t(10.8, 10.8), 0.05, selection_t(), selection_type_t::tile)).tile == tiles[10 * 20 + 10]);
+      }
+
+      TEST_METHOD(snap_points_index_matches_linear_search)
+      {
+         std::mt19937 rand(7);
+         std::uniform_real_distribution<double> coord(0., 10.);
+         std::uniform_real_distribution<double> angle(0., 3.);
+         std::uniform_real_distribution<double> jitter(-0.15, 0.15);
+
+         // Overlapping random triangles, squares and hexagons.
+         std::vector<std::shared_ptr<placed_tile_t>> tiles;
+         for (int i = 0; i < 300; ++i)
+         {
+            const polygon_t poly = polygon_t::make_regular(3 + (i % 3) * (i % 2 + 1));
+            const transform_t trf = transform_t::translate(point_t(coord(rand), coord(rand))).compose(transform_t::rotate(angle(rand)));
+            tiles.emplace_back(std::make_shared<placed_tile_t>(placed_tile_t{ poly, trf }));
+         }
+
+         snap_points_index_t index;
+         index.rebuild(tiles);
+
+         auto check_queries = [&]()
+         {
+            for (int i = 0; i < 500; ++i)
+            {
+               // Query either anywhere or near a vertex, so that most queries find points.
+               point_t pt(coord(rand), coord(rand));
+               if (i % 2)
+               {
+                  const auto& placed = tiles[i % tiles.size()];
+                  pt = placed->tile.points[i % placed->tile.points.size()].apply(placed->trf);
+                  pt = point_t(pt.x + jitter(rand), pt.y + jitter(rand));
+               }
+
+               selection_t excluded;
+               if (i % 5 == 0)
+                  excluded.add(tile_selection_t{ tiles[i % tiles.size()] });
+               const selection_t linear = tiling_selection::find_selection(tiles, pt, 0.05, excluded, selection_type_t::point);
+               const selection_t indexed = index.find(pt, 0.05, excluded);
+               assert_same_points(linear, indexed);
+            }
+         };
+
+         check_queries();
+
+         // Move some tiles, remove others.
+         for (size_t i = 0; i < tiles.size(); i += 7)
+         {
+            tiles[i]->trf = transform_t::translate(point_t(coord(rand), coord(rand)));
+            index.update(tiles[i]);
+         }
+         for (size_t i = 0; i < 20; ++i)
+         {
+            index.remove(tiles.back());
+            tiles.pop_back();
+         }
+
+         check_queries();
+      }
+
+      TEST_METHOD(incremental_mosaic_reuse)
+      {
+         const polygon_t square = make_square_tile();
+         auto t1 = make_square_tiling();
+
+         incremental_mosaic_t generator;
+         auto mo1 = generator.update(t1);
+         Assert::IsTrue(mo1 != nullptr);
+         Assert::AreEqual(size_t(0), generator.get_stats().reused_count);
+         Assert::AreEqual(size_t(1), generator.get_stats().rebuilt_count);
+
+         auto t2 = std::make_shared<translation_tiling_t>(*t1);
+         auto mo2 = generator.update(t2);
+         Assert::AreEqual(size_t(1), generator.get_stats().reused_count);
+         Assert::AreEqual(size_t(0), generator.get_stats().rebuilt_count);
+
+         // The returned mosaics share no figures.
+         Assert::IsTrue(mo1->tile_figures[square] != mo2->tile_figures[square]);
+         Assert::IsTrue(*mo1 == *mo2);
+      }
+
+      TEST_METHOD(incremental_mosaic_infers_again_when_neighbour_changes)
+      {
+         const polygon_t rectangle({ point_t(0., 0.), point_t(2., 0.), point_t(2., 1.), point_t(0., 1.) });
+         const polygon_t square({ point_t(0., 0.), point_t(1., 0.), point_t(1., 1.), point_t(0., 1.) });
+         auto t1 = std::make_shared<translation_tiling_t>(L"rectangles", point_t(3., 0.), point_t(0., 1.));
+         t1->tiles[rectangle].emplace_back(transform_t::identity());
+         t1->tiles[square].emplace_back(transform_t::translate(point_t(2., 0.)));
+
+         incremental_mosaic_t generator;
+         auto mo1 = generator.update(t1);
+         Assert::AreEqual(size_t(0), generator.get_stats().reused_count);
+         Assert::AreEqual(size_t(2), generator.get_stats().rebuilt_count);
+
+         // Same tiling: both figures are reused.
+         generator.update(std::make_shared<translation_tiling_t>(*t1));
+         Assert::AreEqual(size_t(2), generator.get_stats().reused_count);
+         Assert::AreEqual(size_t(0), generator.get_stats().rebuilt_count);
+
+         // Moving the neighbour keeps the star of the square, but the
+         // irregular figure of the rectangle must be inferred again.
+         auto t2 = std::make_shared<translation_tiling_t>(*t1);
+         t2->tiles[square].front() = transform_t::translate(point_t(2., 0.5));
+         auto mo2 = generator.update(t2);
+         Assert::AreEqual(size_t(1), generator.get_stats().reused_count);
+         Assert::AreEqual(size_t(1), generator.get_stats().rebuilt_count);
+
+         auto irregular = std::dynamic_pointer_cast<irregular_figure_t>(mo2->tile_figures[rectangle]);
+         Assert::IsTrue(irregular != nullptr);
+         Assert::IsTrue(irregular->mosaic == mo2);
+         Assert::IsTrue(irregular->get_map().all().size() > 0);
+         Assert::IsTrue(mo1->tile_figures[rectangle] != mo2->tile_figures[rectangle]);
+      }
+
+      TEST_METHOD(batch_transform_levels)
+      {
+         std::vector<point_t> points;
+         for (int i = 0; i < 37; ++i)
+            points.emplace_back(i * 0.7 - 3., 5. - i * 1.3);
+
+         const transform_t trf = transform_t::translate(point_t(1.5, -2.5)).compose(transform_t::rotate(0.3)).compose(transform_t::scale(1.7));
+
+         const simd_level_t levels[] = { simd_level_t::scalar, simd_level_t::sse2, simd_level_t::avx };
+         for (const simd_level_t level : levels)
+         {
+            set_simd_level(level);
+            const std::vector<point_t> placed = apply_transform(trf, points);
+            Assert::AreEqual(points.size(), placed.size());
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+               const point_t expected = points[i].apply(trf);
+               Assert::AreEqual(expected.x, placed[i].x, 1e-12);
+               Assert::AreEqual(expected.y, placed[i].y, 1e-12);
+            }
+         }
+
+         set_simd_level(get_supported_simd_level());
+      }
+
+      TEST_METHOD(mosaic_construct_vertex_merges)
+      {
+         // Note: the shipped tiling has several tile shapes and rotated placements,
+         //       so the vertices are shared between different tiles.
+         const mosaic_t mosaics[] =
+         {
+            make_square_mosaic(std::make_shared<star_t>(4, 2., 1)),
+            make_square_mosaic(std::make_shared<rosette_t>(4, 0.2, 1)),
+            *make_multi_tile_mosaic(),
+         };
+
+         for (const auto& mo : mosaics)
+         {
+            // Note: the tolerance merge is the original construction, the others must match it.
+            const rectangle_t region(-3., -3., 6., 6.);
+            const edges_map_t tolerance = mo.construct(region);
+            const edges_map_t quantized = mo.construct(region, vertex_merge_t::quantized);
+            const edges_map_t lattice = mo.construct(region, vertex_merge_t::lattice);
+
+            Assert::IsTrue(tolerance.all().size() > 0);
+            assert_same_edges(tolerance, quantized);
+            assert_same_edges(tolerance, lattice);
+         }
+      }
+
+      TEST_METHOD(mosaic_lattice_merge_of_far_placements)
+      {
+         // Note: the second placement is several translations away from the first,
+         //       so its vertices are only found by reducing them into the unit cell.
+         auto tiling = make_square_tiling();
+         tiling->tiles[make_square_tile()].emplace_back(transform_t::translate(point_t(2., -3.)));
+
+         mosaic_t mo(tiling);
+         mo.tile_figures[make_square_tile()] = std::make_shared<star_t>(4, 2., 1);
+
+         const rectangle_t region(-3., -3., 6., 6.);
+         const edges_map_t quantized = mo.construct(region, vertex_merge_t::quantized);
+         const edges_map_t lattice = mo.construct(region, vertex_merge_t::lattice);
+
+         Assert::IsTrue(quantized.all().size() > 0);
+         assert_same_edges(quantized, lattice);
+      }
+
+      TEST_METHOD(compact_edges_of_map)
+      {
+         const mosaic_t mo = make_square_mosaic();
+
+         const edges_map_t map = mo.construct(rectangle_t(-2., -2., 4., 4.));
+         const compact_edges_t compact = make_compact_edges(map);
+         Assert::AreEqual(map.all().size() / 2, compact.size());
+
+         size_t index = 0;
+         for (const auto& edge : map.all())
+         {
+            if (!edge.is_canonical())
+               continue;
+            Assert::AreEqual(edge.p1.x, compact[index].p1.to_point().x, 1e-6);
+            Assert::AreEqual(edge.p2.y, compact[index].p2.to_point().y, 1e-6);
+            ++index;
+         }
+      }
+
+      TEST_METHOD(placed_tiles_index_overlaps)
+      {
+         const auto tiling = std::dynamic_pointer_cast<translation_tiling_t>(read_known_tiling(L"3.4.6"));
+         Assert::IsTrue(tiling != nullptr);
+
+         // Fill the translation unit with the tiles of the shipped tiling.
+         std::vector<std::shared_ptr<placed_tile_t>> tiles;
+         for (const auto& tile_placements : tiling->tiles)
+            for (const auto& trf : tile_placements.second)
+               tiles.emplace_back(std::make_shared<placed_tile_t>(placed_tile_t{ tile_placements.first, trf }));
+         const size_t unit_count = tiles.size();
+         Assert::IsTrue(unit_count > 1);
+
+         // Note: tiles exactly one translation away overlap a translated copy of their original,
+         //       while the tiles slightly moved overlap their original directly.
+         const transform_t copies[] =
+         {
+            transform_t::translate(tiling->t1),
+            transform_t::translate(tiling->t1.scale(-1.) + tiling->t2),
+            transform_t::translate(point_t(0.1, 0.05)),
+         };
+         for (size_t i = 0; i < unit_count; i += 2)
+            tiles.emplace_back(std::make_shared<placed_tile_t>(placed_tile_t{ tiles[i]->tile, copies[i % 3].compose(tiles[i]->trf) }));
+
+         placed_tiles_index_t index;
+         index.rebuild(tiles);
+
+         const auto all_accepted = [](const std::shared_ptr<placed_tile_t>&) { return true; };
+         size_t overlap_count = 0;
+         for (const auto& placed : tiles)
+         {
+            const bool expected = brute_force_is_overlapped(tiles, *placed, tiling->t1, tiling->t2);
+            Assert::AreEqual(expected, index.is_overlapped(*placed, tiling->t1, tiling->t2, all_accepted));
+            if (expected)
+               overlap_count += 1;
+         }
+
+         // Note: the filled unit itself has no overlaps.
+         Assert::IsTrue(overlap_count > 0);
+         for (size_t i = 0; i < unit_count; ++i)
+            Assert::IsFalse(brute_force_is_overlapped(std::vector<std::shared_ptr<placed_tile_t>>(tiles.begin(), tiles.begin() + unit_count), *tiles[i], tiling->t1, tiling->t2));
+      }
+
+      TEST_METHOD(parallel_for_covers_all_items)
+      {
+         const size_t count = 10007;
+         std::vector<size_t> slots(count, 0);
+
+         set_thread_count(4);
+         parallel_for(count, 100, [&slots](size_t begin, size_t end)
+         {
+            for (size_t i = begin; i < end; ++i)
+               slots[i] += i + 1;
+         });
+         set_thread_count(0);
+
+         for (size_t i = 0; i < count; ++i)
+            Assert::AreEqual(i + 1, slots[i]);
+      }
+
+      TEST_METHOD(parallel_for_nested_calls_and_errors)
+      {
+         set_thread_count(4);
+
+         const size_t count = 1000;
+         std::vector<size_t> slots(count, 0);
+         parallel_for(count, 10, [&slots](size_t begin, size_t end)
+         {
+            parallel_for(end - begin, 10, [&slots, begin](size_t inner_begin, size_t inner_end)
+            {
+               for (size_t i = begin + inner_begin; i < begin + inner_end; ++i)
+                  slots[i] += i + 1;
+            });
+         });
+
+         bool thrown = false;
+         try
+         {
+            parallel_for(count, 10, [](size_t begin, size_t)
+            {
+               if (begin > 0)
+                  throw std::runtime_error("range failed");
+            });
+         }
+         catch (const std::runtime_error&)
+         {
+            thrown = true;
+         }
+
+         set_thread_count(0);
+
+         Assert::IsTrue(thrown);
+         for (size_t i = 0; i < count; ++i)
+            Assert::AreEqual(i + 1, slots[i]);
+      }
+
+      TEST_METHOD(miter_joins_match_scalar)
+      {
+         std::vector<junction_t> all;
+         for (int i = 0; i < 61; ++i)
+         {
+            junction_t junction;
+            junction.kind = junction_kind_t(i % 3);
+            junction.p1 = point_t(std::cos(i * 0.7) * 2., std::sin(i * 1.3));
+            junction.joint = point_t(0.5 * i, -0.25 * i);
+            junction.below = (i % 5 == 0)
+               ? junction.joint + (junction.joint - junction.p1)
+               : point_t(std::sin(i * 0.3) * 3., std::cos(i * 0.9) * 2.);
+            junction.above = point_t(std::cos(i * 1.1) * 4., std::sin(i * 0.4) * 3.);
+            junction.width = 0.1;
+            junction.join_width = 0.1;
+            junction.other_join_width = 0.15;
+            all.emplace_back(junction);
+         }
+
+         const simd_level_t levels[] = { simd_level_t::scalar, simd_level_t::sse2, simd_level_t::avx };
+         for (const simd_level_t level : levels)
+         {
+            set_simd_level(level);
+
+            junctions_t junctions;
+            junctions.resize(all.size());
+            for (size_t i = 0; i < all.size(); ++i)
+               junctions.set(i, all[i]);
+            junctions.compute(0, all.size());
+
+            for (size_t i = 0; i < all.size(); ++i)
+            {
+               const auto expected = compute_junction(all[i]);
+               Assert::AreEqual(expected.first.x,  junctions.get_below(i).x, 1e-9);
+               Assert::AreEqual(expected.first.y,  junctions.get_below(i).y, 1e-9);
+               Assert::AreEqual(expected.second.x, junctions.get_above(i).x, 1e-9);
+               Assert::AreEqual(expected.second.y, junctions.get_above(i).y, 1e-9);
+            }
+         }
+
+         set_simd_level(get_supported_simd_level());
+      }
+
+      TEST_METHOD(inflation_widths_interpolate)
+      {
+         inflation_widths_t widths;
+         Assert::AreEqual(2., widths.get_width(5., 2.));
+
+         widths.add(16., 3.);
+         widths.add(1., 1.);
+         widths.add(4., 5.);
+         widths.add(4., 2.);
+         widths.build();
+
+         Assert::AreEqual(size_t(3), widths.size());
+         Assert::AreEqual(2., widths.get_width(0.5, 2.));
+         Assert::AreEqual(2., widths.get_width(1., 2.));
+         Assert::AreEqual(3., widths.get_width(2.5, 2.));
+         Assert::AreEqual(4., widths.get_width(4., 2.));
+         Assert::AreEqual(5., widths.get_width(10., 2.));
+         Assert::AreEqual(6., widths.get_width(16., 2.));
+         Assert::AreEqual(6., widths.get_width(100., 2.));
+      }
+
+      TEST_METHOD(over_under_weaving_is_deterministic)
+      {
+         const mosaic_t mo = make_square_mosaic();
+
+         const edges_map_t map = mo.construct(rectangle_t(-3., -3., 6., 6.));
+         const over_under_weaving_t weaving(map);
+         Assert::AreEqual(map.all().size(), weaving.edge_count());
+         Assert::IsTrue(weaving.component_count() > 0);
+
+         set_thread_count(1);
+         std::vector<bool> single(map.all().size(), false);
+         weaving.weave(single);
+
+         set_thread_count(4);
+         std::vector<bool> multi(map.all().size(), false);
+         weaving.weave(multi);
+         set_thread_count(0);
+
+         Assert::IsTrue(single == multi);
+      }
+
+      TEST_METHOD(over_under_weaving_matches_sequential_search)
+      {
+         // Note: the shipped tiling has several tile shapes, so its weaving
+         //       has multiple components.
+         const mosaic_t mosaics[] =
+         {
+            make_square_mosaic(std::make_shared<star_t>(4, 2., 1)),
+            make_square_mosaic(std::make_shared<star_t>(4, 1.5, 2)),
+            make_square_mosaic(std::make_shared<rosette_t>(4, 0.2, 1)),
+            *make_multi_tile_mosaic(),
+         };
+
+         for (const auto& mo : mosaics)
+         {
+            // Note: the region is not a whole number of tiles, so the map has line ends.
+            const edges_map_t map = mo.construct(rectangle_t(-4.3, -3.7, 8.6, 7.4));
+            const std::vector<bool> expected = sequential_over_under(map);
+
+            const over_under_weaving_t weaving(map);
+            for (const size_t thread_count : { size_t(1), size_t(4) })
+            {
+               set_thread_count(thread_count);
+               std::vector<bool> woven(map.all().size(), false);
+               weaving.weave(woven);
+               Assert::IsTrue(expected == woven);
+            }
+            set_thread_count(0);
+         }
+      }
+
+      TEST_METHOD(figure_version_tracks_parameters)
+      {
+         auto star = std::make_shared<star_t>(8, 3., 2);
+         const uint64_t star_version = star->get_version();
+         Assert::IsTrue(star->get_map().all().size() > 0);
+         Assert::AreEqual(star_version, star->get_version());
+
+         star->d = 2.5;
+         Assert::IsTrue(star->get_version() > star_version);
+
+         auto rosette = std::make_shared<rosette_t>(8, 0.2, 3);
+         extended_figure_t extended(rosette);
+         const size_t extended_count = extended.get_map().all().size();
+         const uint64_t extended_version = extended.get_version();
+         Assert::AreEqual(extended_version, extended.get_version());
+
+         extended_figure_t copy(extended);
+         Assert::AreEqual(extended_version, copy.get_version());
+
+         rosette->q = -0.3;
+         Assert::IsTrue(extended.get_version() > extended_version);
+         Assert::AreEqual(extended_version, copy.get_version());
+         Assert::IsTrue(extended.get_map().all().size() > 0);
+         Assert::AreEqual(extended_count, copy.get_map().all().size());
+      }
+
 	};
 }
@@ -29,6 +29,9 @@ namespace dak
       std::filesystem::path get_user_tilings_folder();
       std::filesystem::path get_user_mosaics_folder();
 
+      // Default location for cached data that can be safely deleted.
+      std::filesystem::path get_user_cache_folder();
+
       // Previous, obsolete location for user-writable tilings and mosaics.
       std::filesystem::path get_user_tilings_old_folder();
       std::filesystem::path get_user_mosaics_old_folder();
@@ -8,10 +8,11 @@
 #include <dak/tiling_ui_qt/figure_selector.h>
 #include <dak/tiling_ui_qt/layers_selector.h>
 #include <dak/tiling_ui_qt/tiling_editor.h>
-
-#include <dak/ui/qt/layered_canvas.h>
+#include <dak/tiling_ui_qt/timed_layered_canvas.h>
 
 #include <dak/tiling_style/known_mosaics_generator.h>
+#include <dak/tiling_style/mosaic_disk_cache.h>
+#include <dak/tiling_style/mosaic_memory_cache.h>
 
 #include <dak/tiling/mosaic.h>
 #include <dak/tiling/known_tilings.h>
@@ -71,14 +72,6 @@ namespace dak
          main_window_t(const main_window_icons_t& icons);
 
       protected:
-         struct calculated_mosaic_t
-         {
-            std::shared_ptr<mosaic_t> mosaic;
-            transform_t trf;
-            dak::geometry::edges_map_t edges_map;
-         };
-         typedef std::vector<calculated_mosaic_t> mosaic_edges_map_cache_t;
-
          // Add the tiling found in the given folder.
          void add_tilings_from(const std::wstring& folder);
 
@@ -96,8 +89,9 @@ namespace dak
          std::vector<std::shared_ptr<styled_mosaic_t>> get_avail_mosaics();
          std::vector<std::shared_ptr<layer_t>> get_avail_layers();
          void update_layered_transform();
-         const geometry::edges_map_t& find_calculated_mosaic(mosaic_edges_map_cache_t& calc_mos, const std::shared_ptr<styled_mosaic_t>& styled_mosaic);
+         dak::tiling_style::mosaic_memory_cache_t::cached_map_t find_calculated_mosaic(const std::shared_ptr<styled_mosaic_t>& styled_mosaic);
          void update_canvas_layers(const std::vector<std::shared_ptr<layer_t>>& layers);
+         void draw_layered_in_full_precision(ui::drawing_t& drw);
 
          // The layers UI call-backs.
          std::vector<std::shared_ptr<layer_t>> get_selected_layers();
@@ -110,6 +104,7 @@ namespace dak
          // The figures list filling.
          std::vector<std::shared_ptr<figure_t>> get_all_avail_figures();
          std::vector<std::shared_ptr<figure_t>> get_merged_avail_figures();
+         void apply_figure_to_selected_mosaics(const figure_t& modified);
          void fill_figure_list();
          std::shared_ptr<figure_t> get_selected_figure();
          void fill_figure_editor(bool force_update = false);
@@ -121,12 +116,19 @@ namespace dak
          void awaken_to_empty_canvas();
          void clear_undo_stack();
          void commit_to_undo();
+         dak::ui::layered_t::layers_t snapshot_layers(const dak::ui::layered_t::layers_t& layers);
+         void prune_undo_layers();
+         void update_undo_memory_usage();
+
+         // Memory usage shown in the timing overlay.
+         std::vector<std::wstring> describe_memory_usage();
 
          // Layer manipulations.
          dak::ui::layered_t::layers_t clone_layers(const dak::ui::layered_t::layers_t& layers);
          void add_layer(const std::shared_ptr<mosaic_t>& new_mosaic);
 
          // The mosaic tool-bar buttons.
+         void update_known_mosaic_map();
          void update_mosaic_map(const std::vector<std::shared_ptr<styled_mosaic_t>>& mosaics, const std::wstring& name);
          void update_mosaic_map(const std::vector<std::shared_ptr<layer_t>>& layers, const std::wstring& name);
 
@@ -142,7 +144,13 @@ namespace dak
          std::vector<std::wstring> my_errors;
          dak::tiling::known_tilings_t my_known_tilings;
          dak::tiling_style::known_mosaics_generator_t my_mosaic_gen;
+         dak::tiling_style::mosaic_disk_cache_t my_mosaic_disk_cache;
+         dak::tiling_style::mosaic_memory_cache_t my_mosaic_memory_cache;
+         bool my_use_disk_cache = false;
          dak::utility::undo_stack_t my_undo_stack;
+         dak::ui::layered_t::layers_t my_undo_snapshot;
+         std::vector<std::weak_ptr<const styled_mosaic_t>> my_undo_layers;
+         size_t my_undo_memory_usage = 0;
          std::shared_ptr<dak::ui::layered_t> my_layered;
          std::shared_ptr<dak::ui::layered_t> my_original_mosaic;
 
@@ -196,6 +204,9 @@ namespace dak
          QAction* my_redraw_action = nullptr;
          QToolButton* my_redraw_button = nullptr;
 
+         QAction* my_save_trace_action = nullptr;
+         QAction* my_timing_overlay_action = nullptr;
+
          QDockWidget* my_layers_dock = nullptr;
          layers_selector_t* my_layer_list = nullptr;
 
@@ -204,7 +215,7 @@ namespace dak
          dak::tiling_ui_qt::figure_selector_t* my_figure_list = nullptr;
          figure_editor_t* my_figure_editor = nullptr;
 
-         dak::ui::qt::layered_canvas_t* my_layered_canvas = nullptr;
+         timed_layered_canvas_t* my_layered_canvas = nullptr;
       };
    }
 }
@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef DAK_TILING_UI_QT_MOSAIC_PREVIEW_H
+#define DAK_TILING_UI_QT_MOSAIC_PREVIEW_H
+
+#include <dak/tiling_ui_qt/mosaic_canvas.h>
+
+#include <dak/tiling/incremental_mosaic.h>
+
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtimer.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace dak
+{
+   namespace tiling_ui_qt
+   {
+      using tiling::tiling_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // A mosaic canvas showing the example mosaic of a tiling being edited.
+      //
+      // The mosaic is generated in a worker thread, reusing the figures of the
+      // tiles that did not change. Changes are only taken into account once
+      // they stop for a short delay, so the preview never slows down the
+      // direct manipulations done in the editor. Nothing is generated while
+      // the preview is hidden.
+
+      class mosaic_preview_t : public mosaic_canvas_t
+      {
+      public:
+         // Function providing the edited tiling, or null if it is incomplete.
+         typedef std::function<std::shared_ptr<tiling_t>()> tiling_source_t;
+
+         // Create a preview with the given parent widget.
+         mosaic_preview_t(QWidget* parent, tiling_source_t source);
+         ~mosaic_preview_t();
+
+         // Tell the preview that the edited tiling changed.
+         void tiling_changed();
+
+         // Count of figures reused and rebuilt during the last generation.
+         const tiling::incremental_mosaic_t::stats_t& get_stats() const { return my_stats; }
+
+      protected:
+         void showEvent(QShowEvent* event) override;
+
+      private:
+         void start_generation();
+         void generate(uint64_t request, const std::shared_ptr<const tiling_t>& tiling);
+         void deliver(uint64_t request, const std::shared_ptr<dak::tiling::mosaic_t>& mosaic, const tiling::incremental_mosaic_t::stats_t& stats);
+
+         tiling_source_t my_source;
+         QTimer my_delay;
+
+         // Only touched by the worker thread.
+         tiling::incremental_mosaic_t my_generator;
+
+         uint64_t my_last_request = 0;
+         bool my_is_generating = false;
+         bool my_is_dirty = false;
+         tiling::incremental_mosaic_t::stats_t my_stats;
+
+         QThreadPool my_pool;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
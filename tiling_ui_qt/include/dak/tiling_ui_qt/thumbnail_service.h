@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef DAK_TILING_UI_QT_THUMBNAIL_SERVICE_H
+#define DAK_TILING_UI_QT_THUMBNAIL_SERVICE_H
+
+#include <dak/tiling/mosaic.h>
+#include <dak/tiling/tiling.h>
+
+#include <dak/ui/color.h>
+
+#include <QtCore/qobject.h>
+#include <QtCore/qthreadpool.h>
+#include <QtGui/qicon.h>
+#include <QtGui/qimage.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling_ui_qt
+   {
+      using tiling::mosaic_t;
+      using tiling::tiling_t;
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Service rendering the small icons of mosaics and tilings shown in lists.
+      //
+      // Icons are rendered on worker threads. A placeholder icon is returned
+      // immediately and the callback is called on the GUI thread once the real
+      // icon is ready. Rendered icons are kept in memory and on disk, keyed by
+      // a hash of the content, so identical mosaics are rendered only once.
+      // The least recently used icons are removed from the disk cache when it
+      // grows past its maximum size. Each service should use its own folder.
+      //
+      // Callbacks are never called after the service is destroyed.
+
+      class thumbnail_service_t : public QObject
+      {
+      public:
+         // Callback receiving the rendered icon on the GUI thread.
+         typedef std::function<void(const QIcon&)> icon_ready_callback_t;
+
+         // Create a service keeping its disk cache in the given folder.
+         thumbnail_service_t(const std::filesystem::path& cache_folder, size_t max_memory_entries = 512, size_t max_disk_entries = 2048, QObject* parent = nullptr);
+         ~thumbnail_service_t();
+
+         // Retrieve the icon of a mosaic drawn with the given color.
+         // The mosaic is copied, so it can be modified right after the call.
+         QIcon get_icon(const mosaic_t& mosaic, const ui::color_t& co, int w, int h, icon_ready_callback_t ready);
+
+         // Retrieve the icon of the example mosaic generated from a tiling.
+         QIcon get_icon(const std::shared_ptr<const tiling_t>& tiling, const ui::color_t& co, int w, int h, icon_ready_callback_t ready);
+
+         // Cancel the pending requests that have not started and drop the
+         // callbacks of all pending requests.
+         void cancel_pending();
+
+      private:
+         typedef std::function<std::shared_ptr<mosaic_t>()> mosaic_maker_t;
+
+         // State of a rendering task, shared between the GUI and worker threads.
+         // A cancelled task can be queued again until a worker thread sees it.
+         enum class task_state_t
+         {
+            queued,
+            running,
+            cancelled,
+            done,
+         };
+
+         typedef std::shared_ptr<std::atomic<task_state_t>> shared_task_state_t;
+
+         bool is_in_flight(uint64_t key);
+         QIcon request(uint64_t key, mosaic_maker_t maker, const ui::color_t& co, int w, int h, icon_ready_callback_t ready);
+         void run_task(uint64_t key, const mosaic_maker_t& maker, const ui::color_t& co, int w, int h, const shared_task_state_t& state);
+         void render(uint64_t key, const mosaic_maker_t& maker, const ui::color_t& co, int w, int h);
+         void deliver(uint64_t key, const QImage& image);
+         void forget(uint64_t key, const shared_task_state_t& state);
+         void remember(uint64_t key, const QImage& image);
+         QIcon placeholder(int w, int h);
+
+         std::filesystem::path file_path(uint64_t key) const;
+         void trim_disk_cache();
+
+         std::filesystem::path my_cache_folder;
+         size_t my_max_memory_entries;
+         size_t my_max_disk_entries;
+         size_t my_saved_since_trim = 0;
+
+         std::map<uint64_t, QImage> my_images;
+         std::list<uint64_t> my_images_usage;
+         std::map<uint64_t, std::vector<icon_ready_callback_t>> my_pending;
+
+         // Note: keys stay in flight until the task rendering them is
+         //       finished, so an icon is never rendered twice at once.
+         std::map<uint64_t, shared_task_state_t> my_in_flight;
+
+         QThreadPool my_pool;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
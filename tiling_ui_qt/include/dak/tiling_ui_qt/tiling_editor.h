@@ -13,6 +13,7 @@
 #include <QtWidgets/qwidget.h>
 #include <QtWidgets/qaction.h>
 
+#include <functional>
 #include <memory>
 
 namespace dak
@@ -68,6 +69,10 @@ namespace dak
       class tiling_editor_t : public QWidget
       {
       public:
+         // Called when the tiling being designed is modified.
+         typedef std::function<void()> tiling_changed_callback;
+         tiling_changed_callback tiling_changed;
+
          // End-user actions.
          QAction*  my_draw_trans_toggle = nullptr;
          QAction*  my_draw_inflation_toggle = nullptr;
@@ -26,6 +26,7 @@ namespace dak
       using dak::tiling::known_tilings_t;
       typedef std::filesystem::path file_path_t;
       class tiling_description_editor_t;
+      class mosaic_preview_t;
 
       ////////////////////////////////////////////////////////////////////////////
       //
@@ -62,6 +63,8 @@ namespace dak
          tiling_editor_t* my_tiling_editor = nullptr;
          tiling_description_editor_t* my_tiling_desc = nullptr;
          QDockWidget* my_tiling_desc_dock = nullptr;
+         mosaic_preview_t* my_preview = nullptr;
+         QDockWidget* my_preview_dock = nullptr;
 
          known_tilings_t& my_known_tilings;
 
@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef DAK_TILING_UI_QT_TIMED_LAYERED_CANVAS_H
+#define DAK_TILING_UI_QT_TIMED_LAYERED_CANVAS_H
+
+#include <dak/ui/qt/layered_canvas.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling_ui_qt
+   {
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // A layered canvas that times its painting and can show an overlay with
+      // the time spent painting recent frames and, for each mosaic layer, the
+      // time spent constructing, generating and drawing it and its memory.
+
+      class timed_layered_canvas_t : public ui::qt::layered_canvas_t
+      {
+      public:
+         // Number of frames kept in the history.
+         static constexpr size_t history_size = 60;
+
+         // Show the timing overlay.
+         bool show_overlay = false;
+
+         // Additional lines of information shown at the end of the overlay.
+         std::function<std::vector<std::wstring>()> extra_overlay_lines;
+
+         // Create a canvas with the given parent widget.
+         timed_layered_canvas_t(QWidget* parent);
+
+         // Paint the layers and the overlay.
+         void paint(QPainter& painter) override;
+
+      private:
+         void paint_overlay(QPainter& painter);
+
+         std::deque<double> my_frame_times;
+      };
+   }
+}
+
+#endif
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -41,6 +41,12 @@ namespace dak
          return documentFolder.absoluteFilePath("Alhambra/mosaics/").toStdWString();
       }
 
+      std::filesystem::path get_user_cache_folder()
+      {
+         QDir cacheFolder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+         return cacheFolder.absoluteFilePath("Alhambra/").toStdWString();
+      }
+
       std::filesystem::path get_user_tilings_old_folder()
       {
          QDir documentFolder = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
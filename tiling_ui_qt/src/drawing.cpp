@@ -1,20 +1,26 @@
 #include <dak/tiling_ui_qt/drawing.h>
 #include <dak/ui/qt/convert.h>
 
+#include <dak/tiling/batch_transform.h>
 #include <dak/tiling/mosaic.h>
 
 #include <dak/geometry/utility.h>
 
+#include <vector>
+
 namespace dak
 {
    namespace tiling_ui_qt
    {
+      using geometry::edge_t;
+      using geometry::point_t;
       using geometry::transform_t;
       using geometry::polygon_t;
       using ui::color_t;
       using ui::stroke_t;
       using tiling::tiling_t;
       using tiling::mosaic_t;
+      using tiling::apply_transform;
 
       static void clear_background(dak::ui::drawing_t& drw)
       {
@@ -59,14 +65,20 @@ namespace dak
             return;
 
          const auto region = drw.get_bounds().apply(drw.get_transform().invert());
-         tiling->fill(region, [&drw](const tiling_t& tiling, const transform_t& placement) {
+         std::vector<point_t> placed_points;
+         tiling->fill(region, [&drw, &placed_points](const tiling_t& tiling, const transform_t& placement) {
             for (const auto& poly_trfs : tiling.tiles)
             {
+               const auto& points = poly_trfs.first.points;
+               if (points.empty())
+                  continue;
+
+               placed_points.resize(points.size());
                for (const auto& trf : poly_trfs.second)
                {
-                  const auto placed_poly = poly_trfs.first.apply(trf).apply(placement);
-                  geometry::point_t prev = placed_poly.points.back();
-                  for (const auto& pt : placed_poly.points)
+                  apply_transform(placement.compose(trf), points.data(), placed_points.data(), points.size());
+                  point_t prev = placed_points.back();
+                  for (const auto& pt : placed_points)
                   {
                      drw.draw_line(prev, pt);
                      prev = pt;
@@ -88,24 +100,34 @@ namespace dak
          if (!begin_drawing_tiling(drw, mosaic->tiling, co, copy_count))
             return;
 
-         const tiling::mosaic_t& mo = *mosaic;
+         // Gather the edges of each figure once, so that all the copies
+         // can be transformed in batches.
+         std::vector<std::pair<const std::vector<transform_t>*, std::vector<edge_t>>> tile_edges;
+         for (const auto& placed_tile : mosaic->tiling->tiles)
+         {
+            const auto iter = mosaic->tile_figures.find(placed_tile.first);
+            if (iter == mosaic->tile_figures.end())
+               continue;
+
+            std::vector<edge_t> edges;
+            for (const auto& edge : iter->second->get_map().all())
+               if (edge.is_canonical())
+                  edges.emplace_back(edge);
+            tile_edges.emplace_back(&placed_tile.second, std::move(edges));
+         }
+
          const auto region = drw.get_bounds().apply(drw.get_transform().invert());
-         mosaic->tiling->fill(region, [&mo, &drw](const tiling_t& tiling, const transform_t& placement) {
-            for (const auto placed_tile : tiling.tiles)
+         std::vector<edge_t> placed_edges;
+         mosaic->tiling->fill(region, [&tile_edges, &placed_edges, &drw](const tiling_t& tiling, const transform_t& placement) {
+            for (const auto& trfs_edges : tile_edges)
             {
-               const auto iter = mo.tile_figures.find(placed_tile.first);
-               if (iter == mo.tile_figures.end())
-                  continue;
-               auto map = iter->second->get_map();
-               for (const auto& trf : placed_tile.second)
+               const auto& edges = trfs_edges.second;
+               placed_edges.resize(edges.size());
+               for (const auto& trf : *trfs_edges.first)
                {
-                  for (const auto& edge : map.all())
-                  {
-                     if (!edge.is_canonical())
-                        continue;
-                     const auto placed = edge.apply(trf).apply(placement);
+                  apply_transform(placement.compose(trf), edges.data(), placed_edges.data(), edges.size());
+                  for (const auto& placed : placed_edges)
                      drw.draw_line(placed.p1, placed.p2);
-                  }
                }
             }
          });
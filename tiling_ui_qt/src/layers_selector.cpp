@@ -1,6 +1,8 @@
 #include <dak/tiling_ui_qt/layers_selector.h>
 #include <dak/tiling_ui_qt/layers_selector.h>
 #include <dak/tiling_ui_qt/drawing.h>
+#include <dak/tiling_ui_qt/ask.h>
+#include <dak/tiling_ui_qt/thumbnail_service.h>
 
 #include <dak/QtAdditions/QHeaderViewWithWidgets.h>
 #include <dak/QtAdditions/QTableWidgetWithComboBox.h>
@@ -159,7 +161,8 @@ namespace dak
       {
       public:
          layers_selector_ui_t(layers_selector_t& parent, const layers_selector_icons_t& icons)
-         : my_layer_selector(parent)
+         : my_layer_selector(parent),
+           my_thumbnails(new thumbnail_service_t(get_user_cache_folder() / L"thumbnails" / L"layers", 512, 2048, &parent))
          {
             build_ui(parent, icons);
          }
@@ -229,7 +232,7 @@ namespace dak
 
                   // Note: make icon larger than what was set in the table view
                   //       so that it gets scaled down with some smoothing.
-                  const QIcon qicon = get_icon(mo_layer, 128, 64);
+                  const QIcon qicon = get_thumbnail(mo_layer, 128, 64);
                   const QString tiling_name = QString::fromWCharArray(mo_layer->mosaic->tiling->name.c_str());
                   auto tiling_item = new QTableWidgetItem(qicon, tiling_name);
                   tiling_item->setFlags(Qt::ItemFlag::ItemIsEnabled | Qt::ItemFlag::ItemIsSelectable | Qt::ItemFlag::ItemNeverHasChildren);
@@ -248,6 +251,46 @@ namespace dak
          }
 
       private:
+         QIcon get_thumbnail(const std::shared_ptr<styled_mosaic_t>& mo_layer, int w, int h)
+         {
+            if (!mo_layer || !mo_layer->mosaic)
+               return QIcon();
+
+            ui::color_t co = ui::color_t::black();
+            if (auto style = std::dynamic_pointer_cast<colored_t>(mo_layer->style))
+               co = style->color;
+
+            // Note: the icon is rendered in the background. Once ready, find
+            //       the row where the layer is now, if it is still edited.
+            std::weak_ptr<layer_t> weak_layer = mo_layer;
+            return my_thumbnails->get_icon(*mo_layer->mosaic, co, w, h, [self=this, weak_layer](const QIcon& icon)
+            {
+               self->set_thumbnail(weak_layer.lock(), icon);
+            });
+         }
+
+         void set_thumbnail(const std::shared_ptr<layer_t>& layer, const QIcon& icon)
+         {
+            if (!layer)
+               return;
+
+            const auto pos = std::find(my_edited_layers.begin(), my_edited_layers.end(), layer);
+            if (pos == my_edited_layers.end())
+               return;
+
+            const int row = int(pos - my_edited_layers.begin());
+            if (auto item = my_layer_list->item(row, tiling_column))
+            {
+               my_disable_feedback++;
+               my_layer_list->blockSignals(my_disable_feedback > 0);
+
+               item->setIcon(icon);
+
+               my_disable_feedback--;
+               my_layer_list->blockSignals(my_disable_feedback > 0);
+            }
+         }
+
          static std::shared_ptr<style_t> extract_style(const std::shared_ptr<layer_t>& layer_t)
          {
             if (auto mo_layer = std::dynamic_pointer_cast<styled_mosaic_t>(layer_t))
@@ -343,6 +386,8 @@ namespace dak
             my_disable_feedback++;
             my_layer_list->blockSignals(my_disable_feedback > 0);
 
+            // Note: the pending icons are requested again when filling the list.
+            my_thumbnails->cancel_pending();
             my_layer_list->setRowCount(0);
             update_list_content();
 
@@ -673,6 +718,7 @@ namespace dak
          static constexpr int style_column = 3;
 
          layers_selector_t& my_layer_selector;
+         thumbnail_service_t* my_thumbnails;
          layers_t my_edited_layers;
 
          QTableWidgetWithComboBox* my_layer_list;
@@ -5,8 +5,11 @@
 
 #include <dak/tiling_style/thick.h>
 #include <dak/tiling_style/styled_mosaic.h>
+#include <dak/tiling_style/layers_snapshot.h>
 #include <dak/tiling_style/mosaic_io.h>
 
+#include <dak/tiling/trace.h>
+
 #include <dak/ui/drawing.h>
 #include <dak/ui/dxf_drawing.h>
 
@@ -24,7 +27,10 @@
 #include <QtWinExtras/qwinfunctions.h>
 #include <QtSvg/qsvggenerator.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <sstream>
 
 namespace dak
 {
@@ -39,9 +45,37 @@ namespace dak
 
       using dak::utility::L;
 
+      namespace
+      {
+         // Set a flag for the duration of a scope, restoring it even if an exception is thrown.
+         class scoped_flag_t
+         {
+         public:
+            scoped_flag_t(bool& flag, bool value) : my_flag(flag), my_previous(flag) { my_flag = value; }
+            ~scoped_flag_t() { my_flag = my_previous; }
+
+            scoped_flag_t(const scoped_flag_t&) = delete;
+            scoped_flag_t& operator=(const scoped_flag_t&) = delete;
+
+         private:
+            bool& my_flag;
+            const bool my_previous;
+         };
+
+         // Set the precision of the cached drawing elements of all styles of the layers.
+         void set_styles_precision(const std::vector<std::shared_ptr<layer_t>>& layers, geometry_precision_t precision)
+         {
+            for (auto& layer : layers)
+               if (auto mo_layer = std::dynamic_pointer_cast<styled_mosaic_t>(layer))
+                  if (mo_layer->style)
+                     mo_layer->style->set_precision(precision);
+         }
+      }
+
       main_window_t::main_window_t(const main_window_icons_t& icons)
       : my_known_tilings()
       , my_mosaic_gen()
+      , my_mosaic_disk_cache(get_user_cache_folder() / L"maps")
       , my_layered(new ui::layered_t)
       , my_original_mosaic(new ui::layered_t)
       {
@@ -145,6 +179,18 @@ namespace dak
             my_redraw_button = CreateToolButton(my_redraw_action);
             toolbar->addWidget(my_redraw_button);
 
+            // Note: only reachable through its shortcut, it is meant for diagnostics.
+            my_timing_overlay_action = new QAction(QString::fromWCharArray(L::t(L"Show Timings")), this);
+            my_timing_overlay_action->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_H));
+            my_timing_overlay_action->setCheckable(true);
+            addAction(my_timing_overlay_action);
+
+#ifdef DAK_TILING_TRACING
+            my_save_trace_action = new QAction(QString::fromWCharArray(L::t(L"Save Trace")), this);
+            my_save_trace_action->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_T));
+            addAction(my_save_trace_action);
+#endif
+
          my_layers_dock = new QDockWidget(QString::fromWCharArray(L::t(L"Layers")));
          my_layers_dock->setFeatures(QDockWidget::DockWidgetFeature::DockWidgetFloatable | QDockWidget::DockWidgetFeature::DockWidgetMovable);
             QWidget* layers_container = new QWidget();
@@ -171,7 +217,7 @@ namespace dak
 
             figures_dock->setWidget(figures_container);
 
-         my_layered_canvas = new layered_canvas_t(nullptr);
+         my_layered_canvas = new timed_layered_canvas_t(nullptr);
          my_layered_canvas->transformer.mouse_interaction_modifier = ui::modifiers_t::none;
 
          setCentralWidget(my_layered_canvas);
@@ -212,7 +258,7 @@ namespace dak
 
             self->my_mosaic_gen.previous();
             self->clear_undo_stack();
-            self->update_mosaic_map(self->my_mosaic_gen.generate_current(self->my_known_tilings, self->my_errors), self->my_mosaic_gen.current_name());
+            self->update_known_mosaic_map();
          });
 
          my_next_mosaic_action->connect(my_next_mosaic_action, &QAction::triggered, [self=this]()
@@ -222,7 +268,7 @@ namespace dak
 
             self->my_mosaic_gen.next();
             self->clear_undo_stack();
-            self->update_mosaic_map(self->my_mosaic_gen.generate_current(self->my_known_tilings, self->my_errors), self->my_mosaic_gen.current_name());
+            self->update_known_mosaic_map();
          });
 
          my_new_mosaic_action->connect(my_new_mosaic_action, &QAction::triggered, [self=this]()
@@ -284,7 +330,7 @@ namespace dak
             svg_gen.setViewBox(QRect(QPoint(0,0), self->my_layered_canvas->size()));
             QPainter painter(&svg_gen);
             painter_drawing_t drw(painter);
-            draw_layered(drw, self->my_layered);
+            self->draw_layered_in_full_precision(drw);
          });
 
          my_export_dxf_poly_action->connect(my_export_dxf_poly_action, &QAction::triggered, [self=this]()
@@ -295,7 +341,7 @@ namespace dak
 
             std::wofstream fstr(fileName);
             dak::ui::dxf_drawing_t dxf(fstr, dak::ui::dxf_drawing_t::with_polygons);
-            draw_layered(dxf, self->my_layered);
+            self->draw_layered_in_full_precision(dxf);
             dxf.finish();
          });
 
@@ -307,10 +353,37 @@ namespace dak
 
             std::wofstream fstr(fileName);
             dak::ui::dxf_drawing_t dxf(fstr, dak::ui::dxf_drawing_t::with_faces);
-            draw_layered(dxf, self->my_layered);
+            self->draw_layered_in_full_precision(dxf);
             dxf.finish();
          });
 
+         my_layered_canvas->extra_overlay_lines = [self=this]()
+         {
+            return self->describe_memory_usage();
+         };
+
+         my_timing_overlay_action->connect(my_timing_overlay_action, &QAction::toggled, [self=this](bool checked)
+         {
+            self->my_layered_canvas->show_overlay = checked;
+            // Note: the statistics are only gathered while the overlay is shown.
+            if (checked)
+               self->update_canvas_layers(self->get_avail_layers());
+            else
+               self->my_layered_canvas->update();
+         });
+
+#ifdef DAK_TILING_TRACING
+         my_save_trace_action->connect(my_save_trace_action, &QAction::triggered, [self=this]()
+         {
+            auto fileName = ask_save(L::t(L"Save the Performance Trace"), L::t(L"Chrome Trace Files (*.json)"), self);
+            if (fileName.empty())
+               return;
+
+            std::ofstream fstr(fileName);
+            dak::tiling::write_trace(fstr);
+         });
+#endif
+
          /////////////////////////////////////////////////////////////////////////
          //
          // The style editor UI call-backs.
@@ -333,6 +406,8 @@ namespace dak
          {
             self->update_layer_list();
             self->my_styles_editor->set_edited(self->get_selected_styles());
+            // Note: duplicated layers share their figures, refresh the edited figures.
+            self->fill_figure_list();
             self->commit_to_undo();
             self->my_layered->set_layers(layers);
             self->update_canvas_layers(layers);
@@ -364,17 +439,11 @@ namespace dak
 
          my_figure_list->figure_changed = [self=this](std::shared_ptr<figure_t> modified)
          {
-            for (auto fig : self->get_all_avail_figures())
-            {
-               if (!fig->is_similar(*modified))
-                  continue;
-
-               fig->make_similar(*modified);
-            }
+            self->apply_figure_to_selected_mosaics(*modified);
 
             const bool force_update = true;
-            self->fill_figure_editor(force_update);
             self->fill_figure_list();
+            self->fill_figure_editor(force_update);
 
             self->commit_to_undo();
 
@@ -413,13 +482,7 @@ namespace dak
 
          my_figure_editor->figure_changed = [self=this](std::shared_ptr<figure_t> modified, bool interacting)
          {
-            for (auto fig : self->get_all_avail_figures())
-            {
-               if (!fig->is_similar(*modified))
-                  continue;
-
-               fig->make_similar(*modified);
-            }
+            self->apply_figure_to_selected_mosaics(*modified);
 
             self->fill_figure_list();
 
@@ -568,35 +631,70 @@ namespace dak
          my_layered->compose(transform_t::scale(ratio / 3.));
       }
 
-      const geometry::edges_map_t& main_window_t::find_calculated_mosaic(mosaic_edges_map_cache_t& calc_mos, const std::shared_ptr<styled_mosaic_t>& styled_mosaic)
+      dak::tiling_style::mosaic_memory_cache_t::cached_map_t main_window_t::find_calculated_mosaic(const std::shared_ptr<styled_mosaic_t>& styled_mosaic)
       {
          const auto& mosaic = styled_mosaic->mosaic;
          const auto& trf = styled_mosaic->get_transform();
-         for (const auto& calculated : calc_mos)
+         const auto region = window_filling_region(styled_mosaic);
+         return my_mosaic_memory_cache.construct(*mosaic, trf, region, [self=this, &mosaic, &region]()
          {
-            if (calculated.trf == trf && *(calculated.mosaic) == *mosaic)
+            return self->my_use_disk_cache
+                 ? self->my_mosaic_disk_cache.construct(*mosaic, region)
+                 : mosaic->construct(region);
+         });
+      }
+
+      void main_window_t::draw_layered_in_full_precision(ui::drawing_t& drw)
+      {
+         // Note: the exports are drawn from copies of the layers, so that the
+         //       compact cached drawing elements of the canvas are kept.
+         auto export_layered = std::make_shared<ui::layered_t>();
+         export_layered->make_similar(*my_layered);
+         export_layered->set_layers(clone_layers(my_layered->get_layers()));
+
+         const auto layers = export_layered->get_layers();
+         set_styles_precision(layers, geometry_precision_t::full);
+         for (auto& layer : layers)
+            if (auto mo_layer = std::dynamic_pointer_cast<styled_mosaic_t>(layer))
             {
-               return calculated.edges_map;
+               const auto calc_map = find_calculated_mosaic(mo_layer);
+               mo_layer->style->set_map(calc_map.map, mo_layer->mosaic->tiling, calc_map.map_id);
             }
-         }
-         const auto edges_map = mosaic->construct(window_filling_region(styled_mosaic));
-         calc_mos.emplace_back(mosaic, trf, std::move(edges_map));
-         return calc_mos.back().edges_map;
+
+         draw_layered(drw, export_layered);
       }
 
       void main_window_t::update_canvas_layers(const std::vector<std::shared_ptr<layer_t>>& layers)
       {
+         DAK_TILING_TRACE("main_window_t::update_canvas_layers");
+
+         // The canvas only displays the styles, so their caches can be compact.
+         set_styles_precision(layers, geometry_precision_t::compact);
+
          // Optimize updating the layers by only calculating the map of a mosaic once
-         // if multiple layers have identical mosaics.
-         mosaic_edges_map_cache_t calc_mos;
+         // if multiple layers have identical mosaics, or if it was calculated in a
+         // previous update, for example before an undo.
          for (auto& layer : layers)
          {
             if (auto mo_layer = std::dynamic_pointer_cast<styled_mosaic_t>(layer))
             {
-               const auto& calc_map = find_calculated_mosaic(calc_mos, mo_layer);
-               mo_layer->style->set_map(calc_map, mo_layer->mosaic->tiling);
+               const auto start = std::chrono::steady_clock::now();
+               const auto calc_map = find_calculated_mosaic(mo_layer);
+               const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+               mo_layer->stats.construct_ms = duration.count();
+               // Note: counting the tiling edges visits every figure, only do it when shown.
+               if (my_layered_canvas->show_overlay)
+                  mo_layer->stats.tiling_edge_count = mo_layer->mosaic->count_tiling_edges();
+               mo_layer->stats.map_edge_count = calc_map.map.all().size() / 2;
+
+               mo_layer->style->set_map(calc_map.map, mo_layer->mosaic->tiling, calc_map.map_id);
             }
          }
+
+         if (my_layered_canvas->show_overlay)
+            update_undo_memory_usage();
+
          my_layered_canvas->update();
       }
 
@@ -667,6 +765,9 @@ namespace dak
 
       std::vector<std::shared_ptr<figure_t>> main_window_t::get_all_avail_figures()
       {
+         // Note: the figures returned are read-only, they may be shared with
+         //       other layers or with the undo stack. Edits are applied with
+         //       apply_figure_to_selected_mosaics().
          std::vector<std::shared_ptr<figure_t>> avail;
          for (auto mosaic : get_selected_mosaics())
          {
@@ -678,6 +779,22 @@ namespace dak
          return avail;
       }
 
+      void main_window_t::apply_figure_to_selected_mosaics(const figure_t& modified)
+      {
+         // Note: only clone the figures of the mosaic at the moment they are modified.
+         for (auto mosaic : get_selected_mosaics())
+         {
+            for (auto& poly_fig : mosaic->tile_figures)
+            {
+               if (!poly_fig.second || !poly_fig.second->is_similar(modified))
+                  continue;
+
+               if (auto fig = mosaic->get_modifiable_figure(poly_fig.first))
+                  fig->make_similar(modified);
+            }
+         }
+      }
+
       std::vector<std::shared_ptr<figure_t>> main_window_t::get_merged_avail_figures()
       {
          std::vector<std::shared_ptr<figure_t>> avail;
@@ -703,7 +820,29 @@ namespace dak
 
       void main_window_t::fill_figure_list()
       {
-         my_figure_list->set_edited(get_merged_avail_figures());
+         // Note: the figure list and editor modify the figures they are given,
+         //       so they receive private copies. Keep the current copies when
+         //       they still match, to avoid resetting the editor needlessly.
+         const auto avail = get_merged_avail_figures();
+         const auto& listed = my_figure_list->get_edited();
+         if (avail.size() == listed.size())
+         {
+            bool same = true;
+            for (size_t i = 0; same && i < avail.size(); ++i)
+               same = (listed[i] && *listed[i] == *avail[i]);
+            if (same)
+               return;
+         }
+
+         std::vector<std::shared_ptr<figure_t>> copies;
+         copies.reserve(avail.size());
+         for (const auto& figure : avail)
+            copies.emplace_back(figure->clone());
+
+         my_figure_list->set_edited(copies);
+
+         // Note: the editor must edit the new copy, not the discarded one.
+         fill_figure_editor();
       }
 
       std::shared_ptr<figure_t> main_window_t::get_selected_figure()
@@ -743,14 +882,18 @@ namespace dak
 
       void main_window_t::awaken_styled_mosaic(const std::any& data)
       {
-         dak::ui::layered_t::layers_t layers = clone_layers(std::any_cast<const dak::ui::layered_t::layers_t&>(data));
+         // Note: the snapshot is kept as is so that the next commit can share its
+         //       unchanged parts, the layers being edited are clones of it.
+         my_undo_snapshot = std::any_cast<const dak::ui::layered_t::layers_t&>(data);
+         dak::ui::layered_t::layers_t layers = clone_layers(my_undo_snapshot);
          for (auto& layer : layers)
          {
             if (auto style_mosaic = std::dynamic_pointer_cast<styled_mosaic_t>(layer))
             {
                const auto& mosaic = style_mosaic->mosaic;
                const auto& style = style_mosaic->style;
-               style->set_map(mosaic->construct(window_filling_region(style_mosaic)), mosaic->tiling);
+               const auto calc_map = find_calculated_mosaic(style_mosaic);
+               style->set_map(calc_map.map, mosaic->tiling, calc_map.map_id);
             }
          }
 
@@ -766,6 +909,8 @@ namespace dak
 
       void main_window_t::awaken_to_empty_canvas()
       {
+         my_undo_snapshot.clear();
+
          my_layered->set_layers({});
 
          fill_layer_list();
@@ -779,6 +924,9 @@ namespace dak
       void main_window_t::clear_undo_stack()
       {
          my_undo_stack.clear();
+         my_undo_snapshot.clear();
+         my_undo_layers.clear();
+         my_undo_memory_usage = 0;
       }
 
       void main_window_t::commit_to_undo()
@@ -786,13 +934,67 @@ namespace dak
          const dak::ui::layered_t::layers_t& layers = my_layered->get_layers();
          my_undo_stack.commit(
          {
-            clone_layers(layers),
+            snapshot_layers(layers),
             [self=this](std::any& data) { self->deaden_styled_mosaic(data); },
             [self=this](const std::any& data) { self->awaken_styled_mosaic(data); }
          });
+         // Note: committing drops the redo snapshots, forget their layers.
+         prune_undo_layers();
+         update_undo_memory_usage();
          update_undo_redo_actions();
       }
 
+      dak::ui::layered_t::layers_t main_window_t::snapshot_layers(const dak::ui::layered_t::layers_t& layers)
+      {
+         // Note: only the parts that were edited since the previous snapshot are copied.
+         dak::ui::layered_t::layers_t snapshot = dak::tiling_style::snapshot_layers(layers, my_undo_snapshot);
+         for (const auto& layer : snapshot)
+            if (auto snap_layer = std::dynamic_pointer_cast<styled_mosaic_t>(layer))
+               my_undo_layers.emplace_back(snap_layer);
+
+         my_undo_snapshot = snapshot;
+         return snapshot;
+      }
+
+      void main_window_t::prune_undo_layers()
+      {
+         // Note: the undo stack owns the snapshots, so the layers of the snapshots
+         //       it dropped have expired.
+         my_undo_layers.erase(std::remove_if(my_undo_layers.begin(), my_undo_layers.end(),
+            [](const std::weak_ptr<const styled_mosaic_t>& layer) { return layer.expired(); }),
+            my_undo_layers.end());
+      }
+
+      void main_window_t::update_undo_memory_usage()
+      {
+         // Note: the usage is only measured on commits and updates of the canvas,
+         //       since it visits every layer of every undo snapshot.
+         prune_undo_layers();
+
+         dak::tiling::counted_objects_t counted;
+         size_t usage = 0;
+         for (const auto& weak_layer : my_undo_layers)
+            if (const auto layer = weak_layer.lock())
+               usage += layer->memory_usage(counted);
+         my_undo_memory_usage = usage;
+      }
+
+      std::vector<std::wstring> main_window_t::describe_memory_usage()
+      {
+         auto to_mib = [](uint64_t bytes) { return double(bytes) / (1024. * 1024.); };
+
+         std::vector<std::wstring> lines;
+
+         std::wostringstream stream;
+         stream.precision(1);
+         stream << std::fixed;
+         stream << L::t(L"Undo snapshots: ") << to_mib(my_undo_memory_usage) << L" MiB, "
+                << L::t(L"cached maps: ") << to_mib(my_mosaic_memory_cache.size_in_bytes()) << L" MiB";
+         lines.emplace_back(stream.str());
+
+         return lines;
+      }
+
       /////////////////////////////////////////////////////////////////////////
       //
       // Layer manipulations.
@@ -810,6 +1012,7 @@ namespace dak
          auto mo_layer = std::make_shared<styled_mosaic_t>();
          mo_layer->mosaic = new_mosaic;
          mo_layer->style = std::make_shared<thick_t>(ui::color_t(20, 140, 220, 255));
+         mo_layer->style->set_precision(geometry_precision_t::compact);
          auto layers = my_layered->get_layers();
          const bool was_empty = (layers.size() <= 0);
          layers.emplace_back(mo_layer);
@@ -821,7 +1024,8 @@ namespace dak
             my_layered->compose(transform_t::scale(2.));
          }
 
-         mo_layer->update_style(window_filling_region(mo_layer));
+         const auto calc_map = find_calculated_mosaic(mo_layer);
+         mo_layer->style->set_map(calc_map.map, new_mosaic->tiling, calc_map.map_id);
 
          fill_layer_list();
 
@@ -842,6 +1046,14 @@ namespace dak
       //
       // The mosaic tool-bar buttons.
 
+      void main_window_t::update_known_mosaic_map()
+      {
+         // Note: the mosaics of the library never change, so their maps are kept
+         //       in the disk cache to make browsing them much faster.
+         const scoped_flag_t use_disk_cache(my_use_disk_cache, true);
+         update_mosaic_map(my_mosaic_gen.generate_current(my_known_tilings, my_errors), my_mosaic_gen.current_name());
+      }
+
       void main_window_t::update_mosaic_map(const std::vector<std::shared_ptr<styled_mosaic_t>>& mosaics, const std::wstring& name)
       {
          std::vector<std::shared_ptr<layer_t>> layers(mosaics.begin(), mosaics.end());
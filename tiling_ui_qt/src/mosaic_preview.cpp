@@ -0,0 +1,154 @@
+#include <dak/tiling_ui_qt/mosaic_preview.h>
+
+#include <QtCore/qrunnable.h>
+
+namespace dak
+{
+   namespace tiling_ui_qt
+   {
+      using tiling::mosaic_t;
+      using tiling::incremental_mosaic_t;
+
+      namespace
+      {
+         // Delay without changes before the preview is generated.
+         const int preview_delay_ms = 150;
+
+         // Runs the generation of the preview in the thread pool.
+         class preview_task_t : public QRunnable
+         {
+         public:
+            preview_task_t(std::function<void()> work) : my_work(std::move(work)) { }
+
+            void run() override { my_work(); }
+
+         private:
+            std::function<void()> my_work;
+         };
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Creation.
+
+      mosaic_preview_t::mosaic_preview_t(QWidget* parent, tiling_source_t source)
+      : mosaic_canvas_t(parent), my_source(std::move(source))
+      {
+         // Note: a single worker, so that generations are done in order
+         //       and the generator is never used by two threads.
+         my_pool.setMaxThreadCount(1);
+
+         my_delay.setSingleShot(true);
+         my_delay.setInterval(preview_delay_ms);
+         QObject::connect(&my_delay, &QTimer::timeout, [self=this]()
+         {
+            self->start_generation();
+         });
+      }
+
+      mosaic_preview_t::~mosaic_preview_t()
+      {
+         my_delay.stop();
+         my_pool.clear();
+         my_pool.waitForDone();
+
+         // Note: irregular figures refer back to their mosaic, so clear the
+         //       figures to break the reference cycle.
+         if (mosaic)
+            mosaic->tile_figures.clear();
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Changes, in the GUI thread.
+
+      void mosaic_preview_t::tiling_changed()
+      {
+         my_is_dirty = true;
+
+         // Note: restarting the timer delays the work until the end-user pauses.
+         if (isVisible())
+            my_delay.start();
+      }
+
+      void mosaic_preview_t::showEvent(QShowEvent* event)
+      {
+         mosaic_canvas_t::showEvent(event);
+
+         if (my_is_dirty)
+            my_delay.start();
+      }
+
+      void mosaic_preview_t::start_generation()
+      {
+         if (!my_is_dirty || !isVisible())
+            return;
+
+         // Wait for the current generation to end, the latest tiling will be taken then.
+         if (my_is_generating)
+            return;
+
+         my_is_dirty = false;
+
+         std::shared_ptr<const tiling_t> tiling = my_source ? my_source() : nullptr;
+         if (!tiling || tiling->is_invalid())
+            return;
+
+         my_is_generating = true;
+         const uint64_t request = ++my_last_request;
+         my_pool.start(new preview_task_t([self=this, request, tiling]()
+         {
+            self->generate(request, tiling);
+         }));
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Generation, done in a worker thread.
+
+      void mosaic_preview_t::generate(uint64_t request, const std::shared_ptr<const tiling_t>& tiling)
+      {
+         std::shared_ptr<mosaic_t> new_mosaic;
+         try
+         {
+            new_mosaic = my_generator.update(tiling);
+         }
+         catch (const std::exception&)
+         {
+            // Ignore: the tiling might be in an intermediary state.
+            my_generator.clear();
+         }
+
+         const incremental_mosaic_t::stats_t stats = my_generator.get_stats();
+         QMetaObject::invokeMethod(this, [self=this, request, new_mosaic, stats]()
+         {
+            self->deliver(request, new_mosaic, stats);
+         }, Qt::QueuedConnection);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Delivery, done in the GUI thread.
+
+      void mosaic_preview_t::deliver(uint64_t request, const std::shared_ptr<mosaic_t>& new_mosaic, const incremental_mosaic_t::stats_t& stats)
+      {
+         my_is_generating = false;
+
+         if (request == my_last_request && new_mosaic)
+         {
+            if (mosaic)
+               mosaic->tile_figures.clear();
+
+            mosaic = new_mosaic;
+            my_stats = stats;
+            update();
+         }
+
+         // Start the generation of the changes done while this one was generated.
+         if (my_is_dirty && !my_delay.isActive())
+            start_generation();
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -0,0 +1,375 @@
+#include <dak/tiling_ui_qt/thumbnail_service.h>
+#include <dak/tiling_ui_qt/drawing.h>
+
+#include <dak/tiling_style/mosaic_io.h>
+
+#include <dak/tiling/content_hash.h>
+#include <dak/tiling/irregular_figure.h>
+#include <dak/tiling/known_tilings.h>
+#include <dak/tiling/tiling_io.h>
+
+#include <dak/ui/qt/painter_drawing.h>
+
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthread.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qpixmap.h>
+
+#include <algorithm>
+#include <cwchar>
+#include <sstream>
+
+namespace dak
+{
+   namespace tiling_ui_qt
+   {
+      using tiling::content_hash_t;
+
+      namespace
+      {
+         // Bump the version whenever the drawing of the icons changes.
+         const uint64_t thumbnail_version = 1;
+
+         // Number of copies of the tiling drawn across the icon.
+         const int thumbnail_copy_count = 2;
+
+         // Number of icons rendered between each trimming of the disk cache.
+         const size_t saves_between_trims = 64;
+
+         enum class thumbnail_kind_t
+         {
+            mosaic = 1,
+            tiling = 2,
+         };
+
+         uint64_t make_key(thumbnail_kind_t kind, const std::wstring& content, const ui::color_t& co, int w, int h)
+         {
+            content_hash_t hash;
+            hash.add(thumbnail_version);
+            hash.add(int(kind));
+            hash.add(content);
+            hash.add(int(co.r)).add(int(co.g)).add(int(co.b)).add(int(co.a));
+            hash.add(w).add(h);
+            return hash.value();
+         }
+
+         // Copy a mosaic so that it can be used in a worker thread without
+         // sharing any figure, and their cached map, with the original.
+         std::shared_ptr<mosaic_t> make_private_copy(const mosaic_t& mosaic)
+         {
+            auto copy = std::make_shared<mosaic_t>(mosaic);
+            for (auto& tile_fig : copy->tile_figures)
+            {
+               // Note: copies of mosaics share their figures, so clone them explicitly.
+               tile_fig.second = tile_fig.second->clone();
+               if (auto irregular = std::dynamic_pointer_cast<tiling::irregular_figure_t>(tile_fig.second))
+                  irregular->mosaic = copy;
+            }
+            return copy;
+         }
+
+         // Private copy of a mosaic kept by a rendering task.
+         //
+         // Note: irregular figures refer back to their mosaic, so the figures
+         //       are cleared when the copy is destroyed to break the reference
+         //       cycle, even when the task is destroyed without running.
+         class private_mosaic_t
+         {
+         public:
+            private_mosaic_t(const mosaic_t& mosaic) : my_mosaic(make_private_copy(mosaic)) { }
+            ~private_mosaic_t() { my_mosaic->tile_figures.clear(); }
+
+            private_mosaic_t(const private_mosaic_t&) = delete;
+            private_mosaic_t& operator=(const private_mosaic_t&) = delete;
+
+            const std::shared_ptr<mosaic_t>& get() const { return my_mosaic; }
+
+         private:
+            std::shared_ptr<mosaic_t> my_mosaic;
+         };
+
+         // Runs the rendering of an icon in the thread pool.
+         class thumbnail_task_t : public QRunnable
+         {
+         public:
+            thumbnail_task_t(std::function<void()> work) : my_work(std::move(work)) { }
+
+            void run() override { my_work(); }
+
+         private:
+            std::function<void()> my_work;
+         };
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Creation.
+
+      thumbnail_service_t::thumbnail_service_t(const std::filesystem::path& cache_folder, size_t max_memory_entries, size_t max_disk_entries, QObject* parent)
+      : QObject(parent), my_cache_folder(cache_folder), my_max_memory_entries(max_memory_entries), my_max_disk_entries(max_disk_entries)
+      {
+         // Leave one core for the GUI thread.
+         my_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+
+         trim_disk_cache();
+      }
+
+      thumbnail_service_t::~thumbnail_service_t()
+      {
+         my_pool.clear();
+         my_pool.waitForDone();
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Icon requests.
+
+      QIcon thumbnail_service_t::get_icon(const mosaic_t& mosaic, const ui::color_t& co, int w, int h, icon_ready_callback_t ready)
+      {
+         if (!mosaic.tiling)
+            return QIcon();
+
+         std::wostringstream stream;
+         stream.precision(17);
+         stream.imbue(std::locale("C"));
+         tiling_style::write_mosaic(stream, mosaic);
+
+         const uint64_t key = make_key(thumbnail_kind_t::mosaic, stream.str(), co, w, h);
+
+         // Note: the copy is made right away, on the GUI thread, since the
+         //       caller is free to modify the mosaic after the call.
+         std::shared_ptr<private_mosaic_t> copy;
+         if (!my_images.count(key) && !is_in_flight(key))
+            copy = std::make_shared<private_mosaic_t>(mosaic);
+
+         return request(key, [copy]() { return copy ? copy->get() : std::shared_ptr<mosaic_t>(); }, co, w, h, ready);
+      }
+
+      QIcon thumbnail_service_t::get_icon(const std::shared_ptr<const tiling_t>& tiling, const ui::color_t& co, int w, int h, icon_ready_callback_t ready)
+      {
+         if (!tiling)
+            return QIcon();
+
+         std::wostringstream stream;
+         tiling::write_tiling(tiling, stream);
+
+         const uint64_t key = make_key(thumbnail_kind_t::tiling, stream.str(), co, w, h);
+         return request(key, [tiling]() { return tiling::generate_mosaic(tiling); }, co, w, h, ready);
+      }
+
+      QIcon thumbnail_service_t::request(uint64_t key, mosaic_maker_t maker, const ui::color_t& co, int w, int h, icon_ready_callback_t ready)
+      {
+         const auto pos = my_images.find(key);
+         if (pos != my_images.end())
+         {
+            my_images_usage.remove(key);
+            my_images_usage.push_front(key);
+            return QIcon(QPixmap::fromImage(pos->second));
+         }
+
+         if (ready)
+            my_pending[key].emplace_back(ready);
+
+         // Note: requests without a callback are also tracked, so that
+         //       the same icon is never rendered twice at the same time.
+         if (!is_in_flight(key))
+         {
+            auto state = std::make_shared<std::atomic<task_state_t>>(task_state_t::queued);
+            my_in_flight[key] = state;
+            my_pool.start(new thumbnail_task_t([self=this, key, maker, co, w, h, state]()
+            {
+               self->run_task(key, maker, co, w, h, state);
+            }));
+         }
+
+         return placeholder(w, h);
+      }
+
+      bool thumbnail_service_t::is_in_flight(uint64_t key)
+      {
+         const auto pos = my_in_flight.find(key);
+         if (pos == my_in_flight.end())
+            return false;
+
+         // Queue a cancelled task again if no worker thread has seen it yet.
+         task_state_t expected = task_state_t::cancelled;
+         if (pos->second->compare_exchange_strong(expected, task_state_t::queued) || expected != task_state_t::done)
+            return true;
+
+         my_in_flight.erase(pos);
+         return false;
+      }
+
+      void thumbnail_service_t::cancel_pending()
+      {
+         // Note: tasks already running will still complete and be remembered,
+         //       but their callbacks are dropped. The cancelled tasks stay in
+         //       the thread pool so that each in-flight key is always removed
+         //       by its own task.
+         for (const auto& key_state : my_in_flight)
+         {
+            task_state_t expected = task_state_t::queued;
+            key_state.second->compare_exchange_strong(expected, task_state_t::cancelled);
+         }
+         my_pending.clear();
+      }
+
+      void thumbnail_service_t::forget(uint64_t key, const shared_task_state_t& state)
+      {
+         // Note: a new task may have replaced the cancelled one.
+         const auto pos = my_in_flight.find(key);
+         if (pos != my_in_flight.end() && pos->second == state)
+            my_in_flight.erase(pos);
+      }
+
+      QIcon thumbnail_service_t::placeholder(int w, int h)
+      {
+         QPixmap pixmap(w, h);
+         pixmap.fill(QColor(240, 240, 240));
+         return QIcon(pixmap);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Rendering, done in a worker thread.
+
+      std::filesystem::path thumbnail_service_t::file_path(uint64_t key) const
+      {
+         wchar_t name[32];
+         swprintf(name, sizeof(name) / sizeof(name[0]), L"%016llx.png", static_cast<unsigned long long>(key));
+         return my_cache_folder / name;
+      }
+
+      void thumbnail_service_t::trim_disk_cache()
+      {
+         my_saved_since_trim = 0;
+
+         try
+         {
+            std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+            for (const auto& entry : std::filesystem::directory_iterator(my_cache_folder))
+               if (entry.path().extension() == L".png")
+                  entries.emplace_back(entry.last_write_time(), entry.path());
+
+            if (entries.size() <= my_max_disk_entries)
+               return;
+
+            std::sort(entries.begin(), entries.end());
+            const size_t remove_count = entries.size() - my_max_disk_entries;
+            for (size_t i = 0; i < remove_count; ++i)
+            {
+               std::error_code error;
+               std::filesystem::remove(entries[i].second, error);
+            }
+         }
+         catch (const std::exception&)
+         {
+            // Ignore: the folder does not exist yet.
+         }
+      }
+
+      void thumbnail_service_t::run_task(uint64_t key, const mosaic_maker_t& maker, const ui::color_t& co, int w, int h, const shared_task_state_t& state)
+      {
+         while (true)
+         {
+            task_state_t expected = task_state_t::queued;
+            if (state->compare_exchange_strong(expected, task_state_t::running))
+               break;
+
+            if (expected == task_state_t::cancelled && state->compare_exchange_strong(expected, task_state_t::done))
+            {
+               QMetaObject::invokeMethod(this, [self=this, key, state]()
+               {
+                  self->forget(key, state);
+               }, Qt::QueuedConnection);
+               return;
+            }
+         }
+
+         render(key, maker, co, w, h);
+      }
+
+      void thumbnail_service_t::render(uint64_t key, const mosaic_maker_t& maker, const ui::color_t& co, int w, int h)
+      {
+         const QString path = QString::fromStdWString(file_path(key).wstring());
+
+         QImage image;
+         bool saved = false;
+         if (image.load(path, "PNG") && image.width() == w && image.height() == h)
+         {
+            // Mark the file as recently used so that trimming the cache keeps it.
+            std::error_code error;
+            std::filesystem::last_write_time(file_path(key), std::filesystem::file_time_type::clock::now(), error);
+         }
+         else
+         {
+            image = QImage(w, h, QImage::Format_ARGB32_Premultiplied);
+            image.fill(Qt::white);
+
+            std::shared_ptr<mosaic_t> mosaic = maker();
+            {
+               QPainter painter(&image);
+               ui::qt::painter_drawing_t drw(painter);
+               draw_tiling(drw, mosaic, co, thumbnail_copy_count);
+            }
+
+            // Note: irregular figures refer back to their mosaic, so clear the
+            //       figures to break the reference cycle.
+            if (mosaic)
+               mosaic->tile_figures.clear();
+
+            std::error_code error;
+            std::filesystem::create_directories(my_cache_folder, error);
+            saved = image.save(path, "PNG");
+         }
+
+         QMetaObject::invokeMethod(this, [self=this, key, image, saved]()
+         {
+            self->deliver(key, image);
+
+            // Note: trimming removes the least recently used files, never
+            //       the ones just rendered, so it can run while others render.
+            if (saved && ++self->my_saved_since_trim >= saves_between_trims)
+               self->trim_disk_cache();
+         }, Qt::QueuedConnection);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      //
+      // Delivery, done in the GUI thread.
+
+      void thumbnail_service_t::deliver(uint64_t key, const QImage& image)
+      {
+         remember(key, image);
+         my_in_flight.erase(key);
+
+         const auto pos = my_pending.find(key);
+         if (pos == my_pending.end())
+            return;
+
+         const std::vector<icon_ready_callback_t> callbacks = std::move(pos->second);
+         my_pending.erase(pos);
+
+         const QIcon icon(QPixmap::fromImage(image));
+         for (const auto& ready : callbacks)
+            ready(icon);
+      }
+
+      void thumbnail_service_t::remember(uint64_t key, const QImage& image)
+      {
+         if (my_images.count(key))
+            my_images_usage.remove(key);
+
+         my_images[key] = image;
+         my_images_usage.push_front(key);
+
+         while (my_images_usage.size() > my_max_memory_entries)
+         {
+            my_images.erase(my_images_usage.back());
+            my_images_usage.pop_back();
+         }
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :
@@ -4,6 +4,8 @@
 #include <dak/ui/qt/convert.h>
 
 #include <dak/tiling/tiling_selection.h>
+#include <dak/tiling/placed_tiles_index.h>
+#include <dak/tiling/snap_points_index.h>
 #include <dak/tiling/translation_tiling.h>
 #include <dak/tiling/inflation_tiling.h>
 
@@ -17,6 +19,7 @@
 #include <QtWidgets/qboxlayout.h>
 #include <QtWidgets/qactiongroup.h>
 
+#include <functional>
 #include <sstream>
 
 namespace dak
@@ -105,6 +108,11 @@ namespace dak
          std::shared_ptr<placed_tile_t> add_placed_tile(const placed_tile_t&);
          void remove_placed_tile(const std::shared_ptr<placed_tile_t>& placed);
          void remove_placed_tile(const selection_t& sel);
+         void update_placed_tile(const std::shared_ptr<placed_tile_t>& placed);
+
+         // Tell the listener that the tiling that would be created changed.
+         void notify_tiling_changed();
+         std::function<void()> tiling_changed;
 
          void toggle_inclusion(const std::shared_ptr<placed_tile_t>&);
 
@@ -169,6 +177,8 @@ namespace dak
          // The edited tiling.
          std::shared_ptr<tiling_t> edited;
          std::vector<std::shared_ptr<placed_tile_t>> tiles;
+         placed_tiles_index_t tiles_index;
+         snap_points_index_t snap_index;
          std::set<std::shared_ptr<placed_tile_t>> overlaps;
          std::set<std::shared_ptr<placed_tile_t>> inclusions;
 
@@ -276,7 +286,10 @@ namespace dak
                {
                   point_t diff = wpt - last_drag;
                   if (!diff.is_invalid())
+                  {
                      placed->trf = transform_t::translate(diff).compose(placed->trf);
+                     editor.update_placed_tile(placed);
+                  }
                }
                mouse_action_t::update_dragging(wpt);
             }
@@ -448,6 +461,7 @@ namespace dak
                   return false;
 
                placed->trf = match;
+               editor.update_placed_tile(placed);
 
                return true;
             }
@@ -460,7 +474,10 @@ namespace dak
                   {
                      point_t diff = wpt - last_drag;
                      if (const std::shared_ptr<placed_tile_t>& placed = tiling_selection::get_placed_tile(cur_sel))
+                     {
                         placed->trf = transform_t::translate(diff).compose(placed->trf);
+                        editor.update_placed_tile(placed);
+                     }
                   }
                }
                mouse_action_t::update_dragging(wpt);
@@ -772,6 +789,8 @@ namespace dak
       {
          edited = tiling;
          tiles.clear();
+         tiles_index.clear();
+         snap_index.clear();
          current_selection = selection_t();
          under_mouse = selection_t();
 
@@ -827,6 +846,8 @@ namespace dak
             }
          }
 
+         tiles_index.rebuild(tiles);
+         snap_index.rebuild(tiles);
          create_polygon_copies();
          update_overlaps();
          show_entire_tiling();
@@ -1080,6 +1101,8 @@ namespace dak
       {
          auto new_tile = std::make_shared<placed_tile_t>(placed);
          tiles.push_back(new_tile);
+         tiles_index.add(new_tile);
+         snap_index.add(new_tile);
 
          update_overlaps();
          update();
@@ -1097,7 +1120,11 @@ namespace dak
          //       This happens with copy_move_polygon if the user doesn't move the mouse.
          const auto pos = std::find(tiles.begin(), tiles.end(), placed);
          if (pos != tiles.end())
+         {
             tiles.erase(pos);
+            tiles_index.remove(placed);
+            snap_index.remove(placed);
+         }
 
          update_overlaps();
          update();
@@ -1109,6 +1136,20 @@ namespace dak
          remove_placed_tile(placed);
       }
 
+      void tiling_editor_ui_t::update_placed_tile(const std::shared_ptr<placed_tile_t>& placed)
+      {
+         tiles_index.update(placed);
+         snap_index.update(placed);
+
+         notify_tiling_changed();
+      }
+
+      void tiling_editor_ui_t::notify_tiling_changed()
+      {
+         if (tiling_changed)
+            tiling_changed();
+      }
+
       void tiling_editor_ui_t::toggle_inclusion(const std::shared_ptr<placed_tile_t>& placed)
       {
          if (!placed)
@@ -1138,6 +1179,8 @@ namespace dak
       void tiling_editor_ui_t::remove_excluded()
       {
          tiles.erase(std::remove_if(tiles.begin(), tiles.end(), [inclusions=inclusions](std::shared_ptr<placed_tile_t>& plt) { return inclusions.count(plt) <= 0; }), tiles.end());
+         tiles_index.rebuild(tiles);
+         snap_index.rebuild(tiles);
          under_mouse = selection_t();
          current_selection = selection_t();
 
@@ -1186,6 +1229,8 @@ namespace dak
                tiles.push_back(std::make_shared<placed_tile_t>(placed_tile_t{ tile, placement.compose(trf) }));
             }
          });
+         tiles_index.rebuild(tiles);
+         snap_index.rebuild(tiles);
 
          update_overlaps();
          update();
@@ -1206,35 +1251,12 @@ namespace dak
          if (!is_included(checked_tile))
             return;
 
-         const point_t checked_center = checked_tile->tile.apply(checked_tile->trf).center();
          const bool trans_valid = !is_translation_invalid();
          const point_t t1 = trans_valid ? get_translation_1() : point_t::origin();
          const point_t t2 = trans_valid ? get_translation_2() : point_t::origin();
 
-         for (auto& placed : tiles)
-         {
-            if (!is_included(placed))
-               continue;
-
-            if (*placed == *checked_tile)
-               continue;
-
-            const polygon_t tile = placed->tile.apply(placed->trf);
-
-            for (int y = -1; y <= 1; ++y)
-            {
-               for (int x = -1; x <= 1; ++x)
-               {
-                  const transform_t trf = transform_t::translate(t1.scale(x) + t2.scale(y));
-                  const polygon_t trans_tile = tile.apply(trf);
-                  if (trans_tile.is_inside(checked_center))
-                  {
-                     overlaps.insert(checked_tile);
-                     return;
-                  }
-               }
-            }
-         }
+         if (tiles_index.is_overlapped(*checked_tile, t1, t2, [self=this](const std::shared_ptr<placed_tile_t>& placed) { return self->is_included(placed); }))
+            overlaps.insert(checked_tile);
       }
 
       void tiling_editor_ui_t::update_overlaps()
@@ -1243,6 +1265,9 @@ namespace dak
 
          for (auto& placed : tiles)
             update_overlap(placed);
+
+         // Note: all modifications of the tiling end by verifying the overlaps.
+         notify_tiling_changed();
       }
 
       bool tiling_editor_ui_t::is_overlapping(const std::shared_ptr<placed_tile_t>& placed) const
@@ -1546,7 +1571,12 @@ namespace dak
       selection_t tiling_editor_ui_t::find_selection(const point_t& wpt, const selection_t& excluded, selection_type_t sel_types)
       {
          double sel_dist = painter_trf_drawing.get_transform().dist_from_inverted_zero(selection_distance);
-         return tiling_selection::find_selection(tiles, wpt, sel_dist, excluded, sel_types);
+
+         // Snapping to points is done all the time while dragging, so use the dedicated index.
+         if (sel_types == selection_type_t::point)
+            return snap_index.find(wpt, sel_dist, excluded);
+
+         return tiling_selection::find_selection(tiles_index, wpt, sel_dist, excluded, sel_types);
       }
 
       ////////////////////////////////////////////////////////////////////////////
@@ -1636,6 +1666,12 @@ namespace dak
       tiling_editor_t::tiling_editor_t(const tiling_editor_icons_t& icons, QWidget* parent)
       : QWidget(parent), my_ui(std::shared_ptr<tiling_editor_ui_t>(new tiling_editor_ui_t(this)))
       {
+         my_ui->tiling_changed = [self=this]()
+         {
+            if (self->tiling_changed)
+               self->tiling_changed();
+         };
+
          build_actions(icons);
          build_ui();
       }
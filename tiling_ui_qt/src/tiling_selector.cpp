@@ -3,6 +3,7 @@
 #include <dak/tiling_ui_qt/ask.h>
 #include <dak/tiling_ui_qt/mosaic_canvas.h>
 #include <dak/tiling_ui_qt/tiling_canvas.h>
+#include <dak/tiling_ui_qt/thumbnail_service.h>
 
 #include <dak/ui/qt/convert.h>
 
@@ -12,6 +13,8 @@
 
 #include <dak/QtAdditions/QtUtilities.h>
 
+#include <QtCore/qabstractitemmodel.h>
+
 #include <QtWidgets/qboxlayout.h>
 #include <QtWidgets/qlabel.h>
 #include <QtWidgets/qlistwidget.h>
@@ -39,7 +42,8 @@ namespace dak
       {
       public:
          tiling_selector_ui_t(known_tilings_t& known_tilings, const tiling_editor_icons_t& icons, tiling_selector_t& parent)
-         : my_tiling_selector(parent), my_known_tilings(known_tilings), my_reporter(&parent)
+         : my_tiling_selector(parent), my_known_tilings(known_tilings), my_reporter(&parent),
+           my_thumbnails(new thumbnail_service_t(get_user_cache_folder() / L"thumbnails" / L"tilings", 512, 2048, &parent))
          {
             build_ui(icons, parent);
             fill_ui(get_selected_index());
@@ -99,6 +103,7 @@ namespace dak
                   my_tiling_list = new QListWidget(selection_panel);
                   my_tiling_list->setSelectionBehavior(QAbstractItemView::SelectionBehavior::SelectRows);
                   my_tiling_list->setSelectionMode(QAbstractItemView::SelectionMode::SingleSelection);
+                  my_tiling_list->setIconSize(QSize(64, 32));
                   list_layout->addWidget(my_tiling_list);
 
                selection_layout->addWidget(list_panel);
@@ -136,6 +141,7 @@ namespace dak
             my_canvas_tab->connect(my_canvas_tab, &QTabBar::currentChanged, my_stacked_canvas, &QStackedWidget::setCurrentIndex);
 
             parent.connect(&parent, &QDialog::accepted, [&]() { ok_selection(); });
+            parent.connect(&parent, &QDialog::finished, [&]() { my_thumbnails->cancel_pending(); });
          }
 
          void fill_ui(const int selected)
@@ -143,11 +149,13 @@ namespace dak
             my_disable_feedback++;
             my_tiling_list->blockSignals(my_disable_feedback > 0);
 
+            // Note: the pending icons were for the items being removed.
+            my_thumbnails->cancel_pending();
             my_tiling_list->clear();
 
             for (auto& name_and_tiling : my_known_tilings)
             {
-               my_tiling_list->addItem(QString::fromWCharArray(name_and_tiling.second->name.c_str()));
+               add_tiling_item(name_and_tiling.second->name, name_and_tiling.second);
             }
 
             set_selected_index(selected);
@@ -164,7 +172,7 @@ namespace dak
             my_tiling_list->blockSignals(my_disable_feedback > 0);
 
             auto name = add_tiling(my_known_tilings, tiling, path);
-            my_tiling_list->addItem(QString::fromWCharArray(name.c_str()));
+            add_tiling_item(name, tiling);
 
             set_selected_index(int(my_known_tilings.size() - 1));
 
@@ -176,6 +184,24 @@ namespace dak
             update_selection();
          }
 
+         void add_tiling_item(const std::wstring& name, const std::shared_ptr<tiling_t>& tiling)
+         {
+            // Note: the icon is rendered in the background, the item receives
+            //       a placeholder until then. The list can be refilled in the
+            //       meantime, so the item is found again through a persistent
+            //       index, which becomes invalid when the item is removed.
+            auto item = new QListWidgetItem(QString::fromWCharArray(name.c_str()));
+            my_tiling_list->addItem(item);
+            const QPersistentModelIndex index(my_tiling_list->model()->index(my_tiling_list->row(item), 0));
+            item->setIcon(my_thumbnails->get_icon(tiling, ui::color_t::black(), 128, 64, [self=this, index](const QIcon& icon)
+            {
+               if (!index.isValid())
+                  return;
+               if (auto item = self->my_tiling_list->item(index.row()))
+                  item->setIcon(icon);
+            }));
+         }
+
          void update_enabled()
          {
             const int selected = get_selected_index();
@@ -278,6 +304,8 @@ namespace dak
          int my_disable_feedback = 0;
 
          message_reporter_t my_reporter;
+
+         thumbnail_service_t* my_thumbnails;
       };
 
       ////////////////////////////////////////////////////////////////////////////
@@ -1,4 +1,5 @@
 #include <dak/tiling_ui_qt/tiling_window.h>
+#include <dak/tiling_ui_qt/mosaic_preview.h>
 #include <dak/tiling_ui_qt/tiling_selector.h>
 #include <dak/tiling_ui_qt/tiling_description_editor.h>
 #include <dak/tiling_ui_qt/ask.h>
@@ -121,6 +122,31 @@ namespace dak
             my_tiling_desc_dock->setWidget(my_tiling_desc);
             addDockWidget(Qt::DockWidgetArea::LeftDockWidgetArea, my_tiling_desc_dock);
 
+         my_preview_dock = new QDockWidget(QString::fromWCharArray(L::t(L"Mosaic Preview")));
+            my_preview_dock->setFeatures(QDockWidget::DockWidgetFeature::DockWidgetClosable | QDockWidget::DockWidgetFeature::DockWidgetFloatable | QDockWidget::DockWidgetFeature::DockWidgetMovable);
+            my_preview = new mosaic_preview_t(my_preview_dock, [self = this]() -> std::shared_ptr<tiling_t>
+            {
+               if (!self->my_tiling_editor->verify_tiling(L""))
+                  return nullptr;
+               return self->my_tiling_editor->create_tiling();
+            });
+            my_preview->setMinimumSize(200, 200);
+            my_preview_dock->setWidget(my_preview);
+            addDockWidget(Qt::DockWidgetArea::RightDockWidgetArea, my_preview_dock);
+
+            // The preview can be shown and hidden from the toolbar.
+            QAction* preview_toggle = my_preview_dock->toggleViewAction();
+            preview_toggle->setShortcut(QKeySequence("Shift+P"));
+            preview_toggle->setToolTip(QString::fromWCharArray(L::t(L"Show the mosaic created from the tiling. (Shortcut: <shift> + p)")));
+            toolbar->addSeparator();
+            toolbar->addWidget(CreateToolButton(preview_toggle));
+            addAction(preview_toggle);
+
+         my_tiling_editor->tiling_changed = [self = this]()
+         {
+            self->my_preview->tiling_changed();
+         };
+
          setAttribute(Qt::WA_DeleteOnClose);
 
          new_tiling();
@@ -0,0 +1,134 @@
+#include <dak/tiling_ui_qt/timed_layered_canvas.h>
+
+#include <dak/tiling_style/styled_mosaic.h>
+
+#include <dak/ui/layered.h>
+
+#include <dak/utility/text.h>
+
+#include <QtGui/qpainter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cwchar>
+#include <numeric>
+#include <vector>
+
+namespace dak
+{
+   namespace tiling_ui_qt
+   {
+      using utility::L;
+      using tiling_style::styled_mosaic_t;
+
+      namespace
+      {
+         const int overlay_margin = 8;
+         const int graph_height = 40;
+         const double graph_max_ms = 100.;
+
+         QString format_line(const wchar_t* format, ...)
+         {
+            wchar_t buffer[256];
+            va_list args;
+            va_start(args, format);
+            vswprintf(buffer, sizeof(buffer) / sizeof(buffer[0]), format, args);
+            va_end(args);
+            return QString::fromWCharArray(buffer);
+         }
+      }
+
+      timed_layered_canvas_t::timed_layered_canvas_t(QWidget* parent)
+      : layered_canvas_t(parent)
+      {
+      }
+
+      void timed_layered_canvas_t::paint(QPainter& painter)
+      {
+         const auto start = std::chrono::steady_clock::now();
+
+         layered_canvas_t::paint(painter);
+
+         const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+         my_frame_times.push_back(duration.count());
+         while (my_frame_times.size() > history_size)
+            my_frame_times.pop_front();
+
+         if (show_overlay)
+            paint_overlay(painter);
+      }
+
+      void timed_layered_canvas_t::paint_overlay(QPainter& painter)
+      {
+         std::vector<QString> lines;
+
+         const double last_ms = my_frame_times.empty() ? 0. : my_frame_times.back();
+         const double average_ms = my_frame_times.empty() ? 0. : std::accumulate(my_frame_times.begin(), my_frame_times.end(), 0.) / my_frame_times.size();
+         const double max_ms = my_frame_times.empty() ? 0. : *std::max_element(my_frame_times.begin(), my_frame_times.end());
+         lines.emplace_back(format_line(L::t(L"Frame: %.1f ms  (average %.1f ms, max %.1f ms)"), last_ms, average_ms, max_ms));
+
+         if (layered)
+         {
+            int index = 0;
+            for (const auto& layer : layered->get_layers())
+            {
+               ++index;
+               const auto mo_layer = std::dynamic_pointer_cast<styled_mosaic_t>(layer);
+               if (!mo_layer || !mo_layer->style)
+                  continue;
+
+               const auto& stats = mo_layer->stats;
+               const wchar_t* cached = stats.generate_cached ? L::t(L" (cached)") : L"";
+               lines.emplace_back(format_line(L::t(L"%d. %ls: construct %.1f ms, style %.1f ms%ls, draw %.1f ms"),
+                  index, mo_layer->style->describe().c_str(), stats.construct_ms, stats.generate_ms, cached, stats.draw_ms));
+               lines.emplace_back(format_line(L::t(L"    %zu tiling edges, %zu map edges, %zu drawn elements, %.1f MiB"),
+                  stats.tiling_edge_count, stats.map_edge_count, stats.item_count, stats.memory_bytes / (1024. * 1024.)));
+            }
+         }
+
+         if (extra_overlay_lines)
+            for (const auto& line : extra_overlay_lines())
+               lines.emplace_back(QString::fromStdWString(line));
+
+         painter.save();
+         painter.resetTransform();
+
+         const QFontMetrics metrics = painter.fontMetrics();
+         int text_width = 0;
+         for (const auto& line : lines)
+            text_width = std::max(text_width, metrics.horizontalAdvance(line));
+         const int graph_width = int(history_size) * 2;
+         const int width = std::max(text_width, graph_width) + 2 * overlay_margin;
+         const int height = int(lines.size()) * metrics.height() + graph_height + 3 * overlay_margin;
+
+         painter.fillRect(QRect(overlay_margin, overlay_margin, width, height), QColor(255, 255, 255, 220));
+
+         // Frame history graph, with a line marking the 60 frames per second budget.
+         const int graph_left = 2 * overlay_margin;
+         const int graph_bottom = 2 * overlay_margin + graph_height;
+         int x = graph_left;
+         for (const double ms : my_frame_times)
+         {
+            const int bar_height = std::max(1, int(graph_height * std::min(ms, graph_max_ms) / graph_max_ms));
+            painter.fillRect(QRect(x, graph_bottom - bar_height, 2, bar_height), ms > 1000. / 60. ? QColor(200, 40, 40) : QColor(40, 140, 40));
+            x += 2;
+         }
+         const int budget_y = graph_bottom - int(graph_height * (1000. / 60.) / graph_max_ms);
+         painter.setPen(QColor(120, 120, 120));
+         painter.drawLine(graph_left, budget_y, graph_left + graph_width, budget_y);
+
+         painter.setPen(Qt::black);
+         int y = graph_bottom + overlay_margin + metrics.ascent();
+         for (const auto& line : lines)
+         {
+            painter.drawText(graph_left, y, line);
+            y += metrics.height();
+         }
+
+         painter.restore();
+      }
+   }
+}
+
+// vim: sw=3 : sts=3 : et : sta :